@@ -101,6 +101,8 @@ static LmHandlerTxParams_t TxParams =
     },
     .TxPower = TX_POWER_0,
     .Channel = 0,
+    .NbTrans = 0,
+    .TxTimeOnAir = 0,
 };
 
 static LmHandlerRxParams_t RxParams =
@@ -365,6 +367,26 @@ void LmHandlerProcess( void )
     LmHandlerPackagesProcess( );
 }
 
+bool LmHandlerIsProcessPending( void )
+{
+    if( ( Radio.IsIrqPending != NULL ) && ( Radio.IsIrqPending( ) == true ) )
+    {
+        return true;
+    }
+
+    for( int8_t i = 0; i < PKG_MAX_NUMBER; i++ )
+    {
+        if( ( LmHandlerPackages[i] != NULL ) &&
+            ( LmHandlerPackages[i]->IsTxPending != NULL ) &&
+            ( LmHandlerPackages[i]->IsTxPending( ) == true ) )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 TimerTime_t LmHandlerGetDutyCycleWaitTime( void )
 {
     return DutyCycleWaitTime;
@@ -671,6 +693,8 @@ static void McpsConfirm( McpsConfirm_t *mcpsConfirm )
     TxParams.TxPower = mcpsConfirm->TxPower;
     TxParams.Channel = mcpsConfirm->Channel;
     TxParams.AckReceived = mcpsConfirm->AckReceived;
+    TxParams.NbTrans = mcpsConfirm->NbTrans;
+    TxParams.TxTimeOnAir = mcpsConfirm->TxTimeOnAir;
 
     LmHandlerCallbacks->OnTxData( &TxParams );
 
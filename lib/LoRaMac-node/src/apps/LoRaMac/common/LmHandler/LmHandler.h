@@ -51,6 +51,8 @@ typedef struct LmHandlerTxParams_s
     LmHandlerAppData_t AppData;
     int8_t TxPower;
     uint8_t Channel;
+    uint8_t NbTrans;
+    TimerTime_t TxTimeOnAir;
 }LmHandlerTxParams_t;
 
 typedef struct LmHandlerRxParams_s
@@ -59,7 +61,7 @@ typedef struct LmHandlerRxParams_s
     LoRaMacEventInfoStatus_t Status;
     CommissioningParams_t *CommissioningParams;
     int8_t Datarate;
-    int8_t Rssi;
+    int16_t Rssi;
     int8_t Snr;
     uint32_t DownlinkCounter;
     int8_t RxSlot;
@@ -245,6 +247,14 @@ bool LmHandlerIsBusy( void );
  */
 void LmHandlerProcess( void );
 
+/*!
+ * Indicates if LmHandlerProcess has work to do besides the LoRaMac events
+ * signalled through the OnMacProcess callback.
+ *
+ * \retval status [true] radio irq or package transmission pending, [false] idle
+ */
+bool LmHandlerIsProcessPending( void );
+
 /*!
  * Gets current duty-cycle wait time
  *
@@ -28,6 +28,29 @@
 
 #include "LmHandlerMsgDisplay.h"
 
+/*!
+ * Number of records held by the event log, must be a power of 2
+ */
+#ifndef DISPLAY_LOG_SIZE
+#define DISPLAY_LOG_SIZE                            32
+#endif
+
+#if( ( DISPLAY_LOG_SIZE & ( DISPLAY_LOG_SIZE - 1 ) ) != 0 )
+#error "DISPLAY_LOG_SIZE must be a power of 2"
+#endif
+
+/*!
+ * Event log ring. Records are written by the Display functions and
+ * formatted by DisplayProcess.
+ */
+static struct
+{
+    DisplayLogRecord_t Records[DISPLAY_LOG_SIZE];
+    volatile uint32_t Head;
+    volatile uint32_t Tail;
+    uint32_t Dropped;
+}DisplayLog;
+
 /*!
  * MAC status strings
  */
@@ -79,7 +102,8 @@ const char* EventInfoStatusStrings[] =
     "Multicast fail",                // LORAMAC_EVENT_INFO_STATUS_MULTICAST_FAIL
     "Beacon locked",                 // LORAMAC_EVENT_INFO_STATUS_BEACON_LOCKED
     "Beacon lost",                   // LORAMAC_EVENT_INFO_STATUS_BEACON_LOST
-    "Beacon not found"               // LORAMAC_EVENT_INFO_STATUS_BEACON_NOT_FOUND
+    "Beacon not found",              // LORAMAC_EVENT_INFO_STATUS_BEACON_NOT_FOUND
+    "Channel busy"                   // LORAMAC_EVENT_INFO_STATUS_CHANNEL_BUSY
 };
 
 /*!
@@ -110,9 +134,113 @@ void PrintHexBuffer( uint8_t *buffer, uint8_t size )
     printf( "\n" );
 }
 
+/*!
+ * Prints the payload of a record, and the size of the payload if it did
+ * not fit into the record
+ *
+ * \param record Record holding the payload
+ */
+static void PrintRecordData( DisplayLogRecord_t *record )
+{
+    PrintHexBuffer( record->Data, record->DataSize );
+    if( record->Size > record->DataSize )
+    {
+        printf( "... ( %u bytes )\n", record->Size );
+    }
+}
+
+/*!
+ * Allocates the next log record
+ *
+ * \param event Event identifier
+ *
+ * \retval record Record to be filled, NULL if the log is full
+ */
+static DisplayLogRecord_t* DisplayLogAlloc( DisplayLogEvent_t event )
+{
+    uint32_t head = DisplayLog.Head;
+
+    if( ( head - DisplayLog.Tail ) >= DISPLAY_LOG_SIZE )
+    {
+        // Log full, keep the older records
+        DisplayLog.Dropped++;
+        return NULL;
+    }
+
+    DisplayLogRecord_t *record = &DisplayLog.Records[head & ( DISPLAY_LOG_SIZE - 1 )];
+
+    record->Timestamp = TimerGetCurrentTime( );
+    record->Event = event;
+    record->Status = 0;
+    record->Size = 0;
+    record->DataSize = 0;
+    record->Args[0] = 0;
+    record->Args[1] = 0;
+    record->Args[2] = 0;
+    record->Args[3] = 0;
+    return record;
+}
+
+/*!
+ * Copies a payload into a record, truncated to the record size
+ */
+static void DisplayLogSetData( DisplayLogRecord_t *record, const uint8_t *buffer, uint8_t size )
+{
+    record->Size = size;
+    record->DataSize = MIN( size, DISPLAY_LOG_DATA_SIZE );
+    if( buffer != NULL )
+    {
+        memcpy1( record->Data, buffer, record->DataSize );
+    }
+}
+
+/*!
+ * Publishes the record allocated last
+ */
+static void DisplayLogCommit( void )
+{
+    DisplayLog.Head++;
+
+#if( LMH_MSG_DISPLAY_DEFERRED == 0 )
+    DisplayProcess( );
+#endif
+}
+
+bool DisplayLogRead( DisplayLogRecord_t *record )
+{
+    uint32_t tail = DisplayLog.Tail;
+
+    if( tail == DisplayLog.Head )
+    {
+        return false;
+    }
+
+    *record = DisplayLog.Records[tail & ( DISPLAY_LOG_SIZE - 1 )];
+    DisplayLog.Tail = tail + 1;
+    return true;
+}
+
+uint32_t DisplayLogGetDropped( void )
+{
+    return DisplayLog.Dropped;
+}
+
 void DisplayNvmDataChange( LmHandlerNvmContextStates_t state, uint16_t size )
 {
-    if( state == LORAMAC_HANDLER_NVM_STORE )
+    DisplayLogRecord_t *record = DisplayLogAlloc( DISPLAY_EVENT_NVM_DATA_CHANGE );
+
+    if( record == NULL )
+    {
+        return;
+    }
+    record->Status = state;
+    record->Args[0] = size;
+    DisplayLogCommit( );
+}
+
+static void PrintNvmDataChange( DisplayLogRecord_t *record )
+{
+    if( record->Status == LORAMAC_HANDLER_NVM_STORE )
     {
         printf( "\n###### ============ CTXS STORED ============ ######\n" );
 
@@ -121,35 +249,67 @@ void DisplayNvmDataChange( LmHandlerNvmContextStates_t state, uint16_t size )
     {
         printf( "\n###### =========== CTXS RESTORED =========== ######\n" );
     }
-    printf( "Size        : %i\n\n", size );
+    printf( "Size        : %lu\n\n", record->Args[0] );
 }
 
 void DisplayNetworkParametersUpdate( CommissioningParams_t *commissioningParams )
 {
-    printf("\n129 LmHandlerMsgDisplay.c DisplayNetworkParametersUpdate() \n");
-    printf( "DevEui      : %02X", commissioningParams->DevEui[0] );
+    DisplayLogRecord_t *record = DisplayLogAlloc( DISPLAY_EVENT_NETWORK_PARAMETERS );
+
+    if( record == NULL )
+    {
+        return;
+    }
+    // DevEui followed by JoinEui
+    DisplayLogSetData( record, commissioningParams->DevEui, 8 );
+    memcpy1( record->Data + 8, commissioningParams->JoinEui, 8 );
+    record->Size = 16;
+    record->DataSize = 16;
+    memcpy1( ( uint8_t* )&record->Args[0], commissioningParams->SePin, 4 );
+    DisplayLogCommit( );
+}
+
+static void PrintNetworkParametersUpdate( DisplayLogRecord_t *record )
+{
+    uint8_t *pin = ( uint8_t* )&record->Args[0];
+
+    printf( "DevEui      : %02X", record->Data[0] );
     for( int i = 1; i < 8; i++ )
     {
-        printf( "-%02X", commissioningParams->DevEui[i] );
+        printf( "-%02X", record->Data[i] );
     }
     printf( "\n" );
-    printf( "JoinEui     : %02X", commissioningParams->JoinEui[0] );
+    printf( "JoinEui     : %02X", record->Data[8] );
     for( int i = 1; i < 8; i++ )
     {
-        printf( "-%02X", commissioningParams->JoinEui[i] );
+        printf( "-%02X", record->Data[8 + i] );
     }
     printf( "\n" );
-    printf( "Pin         : %02X", commissioningParams->SePin[0] );
+    printf( "Pin         : %02X", pin[0] );
     for( int i = 1; i < 4; i++ )
     {
-        printf( "-%02X", commissioningParams->SePin[i] );
+        printf( "-%02X", pin[i] );
     }
     printf( "\n\n" );
 }
 
 void DisplayMacMcpsRequestUpdate( LoRaMacStatus_t status, McpsReq_t *mcpsReq, TimerTime_t nextTxIn )
 {
-    switch( mcpsReq->Type )
+    DisplayLogRecord_t *record = DisplayLogAlloc( DISPLAY_EVENT_MCPS_REQUEST );
+
+    if( record == NULL )
+    {
+        return;
+    }
+    record->Status = status;
+    record->Args[0] = mcpsReq->Type;
+    record->Args[1] = nextTxIn;
+    DisplayLogCommit( );
+}
+
+static void PrintMacMcpsRequestUpdate( DisplayLogRecord_t *record )
+{
+    switch( record->Args[0] )
     {
         case MCPS_CONFIRMED:
         {
@@ -180,16 +340,30 @@ void DisplayMacMcpsRequestUpdate( LoRaMacStatus_t status, McpsReq_t *mcpsReq, Ti
             break;
         }
     }
-    printf( "STATUS      : %s\n", MacStatusStrings[status] );
-    if( status == LORAMAC_STATUS_DUTYCYCLE_RESTRICTED )
+    printf( "STATUS      : %s\n", MacStatusStrings[record->Status] );
+    if( record->Status == LORAMAC_STATUS_DUTYCYCLE_RESTRICTED )
     {
-        printf( "Next Tx in  : %lu [ms]\n", nextTxIn );
+        printf( "Next Tx in  : %lu [ms]\n", record->Args[1] );
     }
 }
 
 void DisplayMacMlmeRequestUpdate( LoRaMacStatus_t status, MlmeReq_t *mlmeReq, TimerTime_t nextTxIn )
 {
-    switch( mlmeReq->Type )
+    DisplayLogRecord_t *record = DisplayLogAlloc( DISPLAY_EVENT_MLME_REQUEST );
+
+    if( record == NULL )
+    {
+        return;
+    }
+    record->Status = status;
+    record->Args[0] = mlmeReq->Type;
+    record->Args[1] = nextTxIn;
+    DisplayLogCommit( );
+}
+
+static void PrintMacMlmeRequestUpdate( DisplayLogRecord_t *record )
+{
+    switch( record->Args[0] )
     {
         case MLME_JOIN:
         {
@@ -227,24 +401,39 @@ void DisplayMacMlmeRequestUpdate( LoRaMacStatus_t status, MlmeReq_t *mlmeReq, Ti
             break;
         }
     }
-    printf( "STATUS      : %s\n", MacStatusStrings[status] );
-    if( status == LORAMAC_STATUS_DUTYCYCLE_RESTRICTED )
+    printf( "STATUS      : %s\n", MacStatusStrings[record->Status] );
+    if( record->Status == LORAMAC_STATUS_DUTYCYCLE_RESTRICTED )
     {
-        printf( "Next Tx in  : %lu [ms]\n", nextTxIn );
+        printf( "Next Tx in  : %lu [ms]\n", record->Args[1] );
     }
 }
 
 void DisplayJoinRequestUpdate( LmHandlerJoinParams_t *params )
 {
-    if( params->CommissioningParams->IsOtaaActivation == true )
+    DisplayLogRecord_t *record = DisplayLogAlloc( DISPLAY_EVENT_JOIN_REQUEST );
+
+    if( record == NULL )
     {
-        if( params->Status == LORAMAC_HANDLER_SUCCESS )
+        return;
+    }
+    record->Status = ( uint8_t )params->Status;
+    record->Args[0] = params->CommissioningParams->IsOtaaActivation;
+    record->Args[1] = params->CommissioningParams->DevAddr;
+    record->Args[2] = ( uint8_t )params->Datarate;
+    DisplayLogCommit( );
+}
+
+static void PrintJoinRequestUpdate( DisplayLogRecord_t *record )
+{
+    if( record->Args[0] == true )
+    {
+        if( ( LmHandlerErrorStatus_t )( int8_t )record->Status == LORAMAC_HANDLER_SUCCESS )
         {
             printf( "###### ===========   JOINED     ============ ######\n" );
             printf( "\nOTAA\n\n" );
-            printf( "DevAddr     :  %08lX\n", params->CommissioningParams->DevAddr );
+            printf( "DevAddr     :  %08lX\n", record->Args[1] );
             printf( "\n\n" );
-            printf( "DATA RATE   : DR_%d\n\n", params->Datarate );
+            printf( "DATA RATE   : DR_%d\n\n", ( int8_t )record->Args[2] );
         }
     }
 #if ( OVER_THE_AIR_ACTIVATION == 0 )
@@ -252,7 +441,7 @@ void DisplayJoinRequestUpdate( LmHandlerJoinParams_t *params )
     {
         printf( "###### ===========   JOINED     ============ ######\n" );
         printf( "\nABP\n\n" );
-        printf( "DevAddr     : %08lX\n", params->CommissioningParams->DevAddr );
+        printf( "DevAddr     : %08lX\n", record->Args[1] );
         printf( "\n\n" );
     }
 #endif
@@ -260,55 +449,118 @@ void DisplayJoinRequestUpdate( LmHandlerJoinParams_t *params )
 
 void DisplayTxUpdate( LmHandlerTxParams_t *params )
 {
+    DisplayLogRecord_t *record = DisplayLogAlloc( DISPLAY_EVENT_TX );
     MibRequestConfirm_t mibGet;
 
+    if( record == NULL )
+    {
+        return;
+    }
+    record->Status = params->Status;
+    record->Args[0] = params->IsMcpsConfirm;
+    if( params->IsMcpsConfirm != 0 )
+    {
+        record->Args[0] |= ( ( uint32_t )params->AppData.Port << 8 ) |
+                           ( ( uint32_t )params->MsgType << 16 ) |
+                           ( ( uint32_t )params->AckReceived << 24 );
+        record->Args[1] = params->UplinkCounter;
+        record->Args[3] = ( uint8_t )params->Datarate |
+                          ( ( uint32_t )( uint8_t )params->TxPower << 8 ) |
+                          ( ( uint32_t )LmHandlerGetCurrentClass( ) << 16 );
+
+        mibGet.Type  = MIB_CHANNELS;
+        if( LoRaMacMibGetRequestConfirm( &mibGet ) == LORAMAC_STATUS_OK )
+        {
+            record->Args[2] = mibGet.Param.ChannelList[params->Channel].Frequency;
+        }
+
+        DisplayLogSetData( record, params->AppData.Buffer, params->AppData.BufferSize );
+    }
+    DisplayLogCommit( );
+
     if( params->IsMcpsConfirm == 0 )
+    {
+        return;
+    }
+
+    // The channel mask in use for this uplink, in a record of its own
+    record = DisplayLogAlloc( DISPLAY_EVENT_CHANNELS_MASK );
+    if( record == NULL )
+    {
+        return;
+    }
+    record->Status = LmHandlerGetActiveRegion( );
+
+    mibGet.Type  = MIB_CHANNELS_MASK;
+    if( LoRaMacMibGetRequestConfirm( &mibGet ) == LORAMAC_STATUS_OK )
+    {
+        record->Args[3] = 1;
+        switch( record->Status )
+        {
+            case LORAMAC_REGION_AU915:
+            case LORAMAC_REGION_CN470:
+            case LORAMAC_REGION_US915:
+            {
+                record->Args[0] = mibGet.Param.ChannelsMask[0] | ( ( uint32_t )mibGet.Param.ChannelsMask[1] << 16 );
+                record->Args[1] = mibGet.Param.ChannelsMask[2] | ( ( uint32_t )mibGet.Param.ChannelsMask[3] << 16 );
+                record->Args[2] = mibGet.Param.ChannelsMask[4];
+                break;
+            }
+            default:
+            {
+                record->Args[0] = mibGet.Param.ChannelsMask[0];
+                break;
+            }
+        }
+    }
+    DisplayLogCommit( );
+}
+
+static void PrintTxUpdate( DisplayLogRecord_t *record )
+{
+    if( ( record->Args[0] & 0xFF ) == 0 )
     {
         printf( "\n###### =========== MLME-Confirm ============ ######\n" );
-        printf( "STATUS      : %s\n", EventInfoStatusStrings[params->Status] );
+        printf( "STATUS      : %s\n", EventInfoStatusStrings[record->Status] );
         return;
     }
 
     printf( "\n###### =========== MCPS-Confirm ============ ######\n" );
-    printf( "STATUS      : %s\n", EventInfoStatusStrings[params->Status] );
+    printf( "STATUS      : %s\n", EventInfoStatusStrings[record->Status] );
 
-    printf( "\n###### =====   UPLINK FRAME %8lu   ===== ######\n", params->UplinkCounter );
+    printf( "\n###### =====   UPLINK FRAME %8lu   ===== ######\n", record->Args[1] );
     printf( "\n" );
 
-    printf( "CLASS       : %c\n", "ABC"[LmHandlerGetCurrentClass( )] );
+    printf( "CLASS       : %c\n", "ABC"[( record->Args[3] >> 16 ) & 0xFF] );
     printf( "\n" );
-    printf( "TX PORT     : %d\n", params->AppData.Port );
+    printf( "TX PORT     : %lu\n", ( record->Args[0] >> 8 ) & 0xFF );
 
-    if( params->AppData.BufferSize != 0 )
+    if( record->Size != 0 )
     {
         printf( "TX DATA     : " );
-        if( params->MsgType == LORAMAC_HANDLER_CONFIRMED_MSG )
+        if( ( ( record->Args[0] >> 16 ) & 0xFF ) == LORAMAC_HANDLER_CONFIRMED_MSG )
         {
-            printf( "CONFIRMED - %s\n", ( params->AckReceived != 0 ) ? "ACK" : "NACK" );
+            printf( "CONFIRMED - %s\n", ( ( record->Args[0] >> 24 ) != 0 ) ? "ACK" : "NACK" );
         }
         else
         {
             printf( "UNCONFIRMED\n" );
         }
-        PrintHexBuffer( params->AppData.Buffer, params->AppData.BufferSize );
+        PrintRecordData( record );
     }
 
     printf( "\n" );
-    printf( "DATA RATE   : DR_%d\n", params->Datarate );
-
-    mibGet.Type  = MIB_CHANNELS;
-    if( LoRaMacMibGetRequestConfirm( &mibGet ) == LORAMAC_STATUS_OK )
-    {
-        printf( "U/L FREQ    : %lu\n", mibGet.Param.ChannelList[params->Channel].Frequency );
-    }
-
-    printf( "TX POWER    : %d\n", params->TxPower );
+    printf( "DATA RATE   : DR_%d\n", ( int8_t )( record->Args[3] & 0xFF ) );
+    printf( "U/L FREQ    : %lu\n", record->Args[2] );
+    printf( "TX POWER    : %d\n", ( int8_t )( ( record->Args[3] >> 8 ) & 0xFF ) );
+}
 
-    mibGet.Type  = MIB_CHANNELS_MASK;
-    if( LoRaMacMibGetRequestConfirm( &mibGet ) == LORAMAC_STATUS_OK )
+static void PrintChannelsMask( DisplayLogRecord_t *record )
+{
+    if( record->Args[3] != 0 )
     {
         printf("CHANNEL MASK: ");
-        switch( LmHandlerGetActiveRegion( ) )
+        switch( record->Status )
         {
             case LORAMAC_REGION_AS923:
             case LORAMAC_REGION_CN779:
@@ -318,7 +570,7 @@ void DisplayTxUpdate( LmHandlerTxParams_t *params )
             case LORAMAC_REGION_EU433:
             case LORAMAC_REGION_RU864:
             {
-                printf( "%04X ", mibGet.Param.ChannelsMask[0] );
+                printf( "%04X ", ( uint16_t )record->Args[0] );
                 break;
             }
             case LORAMAC_REGION_AU915:
@@ -327,7 +579,7 @@ void DisplayTxUpdate( LmHandlerTxParams_t *params )
             {
                 for( uint8_t i = 0; i < 5; i++)
                 {
-                    printf( "%04X ", mibGet.Param.ChannelsMask[i] );
+                    printf( "%04X ", ( uint16_t )( record->Args[i / 2] >> ( ( i % 2 ) * 16 ) ) );
                 }
                 break;
             }
@@ -344,42 +596,89 @@ void DisplayTxUpdate( LmHandlerTxParams_t *params )
 }
 
 void DisplayRxUpdate( LmHandlerAppData_t *appData, LmHandlerRxParams_t *params )
+{
+    DisplayLogRecord_t *record = DisplayLogAlloc( DISPLAY_EVENT_RX );
+
+    if( record == NULL )
+    {
+        return;
+    }
+    record->Status = params->Status;
+    record->Args[0] = params->IsMcpsIndication;
+    if( params->IsMcpsIndication != 0 )
+    {
+        record->Args[0] |= ( ( uint32_t )( uint8_t )params->RxSlot << 16 ) |
+                           ( ( uint32_t )( uint8_t )params->Datarate << 24 );
+        record->Args[1] = params->DownlinkCounter;
+        record->Args[2] = ( ( uint32_t )( uint8_t )params->Snr << 8 ) | ( ( uint32_t )( uint16_t )params->Rssi << 16 );
+
+        if( appData != NULL )
+        {
+            record->Args[0] |= ( uint32_t )appData->Port << 8;
+            DisplayLogSetData( record, appData->Buffer, appData->BufferSize );
+        }
+    }
+    DisplayLogCommit( );
+}
+
+static void PrintRxUpdate( DisplayLogRecord_t *record )
 {
     const char *slotStrings[] = { "1", "2", "C", "C Multicast", "B Ping-Slot", "B Multicast Ping-Slot" };
 
-    if( params->IsMcpsIndication == 0 )
+    if( ( record->Args[0] & 0xFF ) == 0 )
     {
         printf( "\n###### ========== MLME-Indication ========== ######\n" );
-        printf( "STATUS      : %s\n", EventInfoStatusStrings[params->Status] );
+        printf( "STATUS      : %s\n", EventInfoStatusStrings[record->Status] );
         return;
     }
 
     printf( "\n###### ========== MCPS-Indication ========== ######\n" );
-    printf( "STATUS      : %s\n", EventInfoStatusStrings[params->Status] );
+    printf( "STATUS      : %s\n", EventInfoStatusStrings[record->Status] );
 
-    printf( "\n###### =====  DOWNLINK FRAME %8lu  ===== ######\n", params->DownlinkCounter );
+    printf( "\n###### =====  DOWNLINK FRAME %8lu  ===== ######\n", record->Args[1] );
 
-    printf( "RX WINDOW   : %s\n", slotStrings[params->RxSlot] );
+    printf( "RX WINDOW   : %s\n", slotStrings[( record->Args[0] >> 16 ) & 0xFF] );
     
-    printf( "RX PORT     : %d\n", appData->Port );
+    printf( "RX PORT     : %lu\n", ( record->Args[0] >> 8 ) & 0xFF );
 
-    if( appData->BufferSize != 0 )
+    if( record->Size != 0 )
     {
         printf( "RX DATA     : \n" );
-        PrintHexBuffer( appData->Buffer, appData->BufferSize );
+        PrintRecordData( record );
     }
 
     printf( "\n" );
-    printf( "DATA RATE   : DR_%d\n", params->Datarate );
-    printf( "RX RSSI     : %d\n", params->Rssi );
-    printf( "RX SNR      : %d\n", params->Snr );
+    printf( "DATA RATE   : DR_%d\n", ( int8_t )( record->Args[0] >> 24 ) );
+    printf( "RX RSSI     : %d\n", ( int16_t )( record->Args[2] >> 16 ) );
+    printf( "RX SNR      : %d\n", ( int8_t )( ( record->Args[2] >> 8 ) & 0xFF ) );
 
     printf( "\n" );
 }
 
 void DisplayBeaconUpdate( LoRaMacHandlerBeaconParams_t *params )
 {
-    switch( params->State )
+    DisplayLogRecord_t *record = DisplayLogAlloc( DISPLAY_EVENT_BEACON );
+
+    if( record == NULL )
+    {
+        return;
+    }
+    record->Status = params->State;
+    if( params->State == LORAMAC_HANDLER_BEACON_RX )
+    {
+        record->Args[0] = params->Info.Time.Seconds;
+        record->Args[1] = params->Info.Frequency;
+        record->Args[2] = params->Info.Datarate | ( ( uint32_t )( uint8_t )params->Info.Snr << 8 );
+        record->Args[3] = ( uint32_t )( int32_t )params->Info.Rssi;
+        record->Args[2] |= ( uint32_t )params->Info.GwSpecific.InfoDesc << 16;
+        DisplayLogSetData( record, params->Info.GwSpecific.Info, 6 );
+    }
+    DisplayLogCommit( );
+}
+
+static void PrintBeaconUpdate( DisplayLogRecord_t *record )
+{
+    switch( record->Status )
     {
         default:
         case LORAMAC_HANDLER_BEACON_ACQUIRING:
@@ -394,15 +693,15 @@ void DisplayBeaconUpdate( LoRaMacHandlerBeaconParams_t *params )
         }
         case LORAMAC_HANDLER_BEACON_RX:
         {
-            printf( "\n###### ===== BEACON %8lu ==== ######\n", params->Info.Time.Seconds );
-            printf( "GW DESC     : %d\n", params->Info.GwSpecific.InfoDesc );
+            printf( "\n###### ===== BEACON %8lu ==== ######\n", record->Args[0] );
+            printf( "GW DESC     : %lu\n", ( record->Args[2] >> 16 ) & 0xFF );
             printf( "GW INFO     : " );
-            PrintHexBuffer( params->Info.GwSpecific.Info, 6 );
+            PrintRecordData( record );
             printf( "\n" );
-            printf( "FREQ        : %lu\n", params->Info.Frequency );
-            printf( "DATA RATE   : DR_%d\n", params->Info.Datarate );
-            printf( "RX RSSI     : %d\n", params->Info.Rssi );
-            printf( "RX SNR      : %d\n", params->Info.Snr );
+            printf( "FREQ        : %lu\n", record->Args[1] );
+            printf( "DATA RATE   : DR_%lu\n", record->Args[2] & 0xFF );
+            printf( "RX RSSI     : %ld\n", ( int32_t )record->Args[3] );
+            printf( "RX SNR      : %d\n", ( int8_t )( ( record->Args[2] >> 8 ) & 0xFF ) );
             printf( "\n" );
             break;
         }
@@ -416,7 +715,70 @@ void DisplayBeaconUpdate( LoRaMacHandlerBeaconParams_t *params )
 
 void DisplayClassUpdate( DeviceClass_t deviceClass )
 {
-    printf( "\n\n###### ===== Switch to Class %c done.  ===== ######\n\n", "ABC"[deviceClass] );
+    DisplayLogRecord_t *record = DisplayLogAlloc( DISPLAY_EVENT_CLASS );
+
+    if( record == NULL )
+    {
+        return;
+    }
+    record->Args[0] = deviceClass;
+    DisplayLogCommit( );
+}
+
+static void PrintClassUpdate( DisplayLogRecord_t *record )
+{
+    printf( "\n\n###### ===== Switch to Class %c done.  ===== ######\n\n", "ABC"[record->Args[0]] );
+}
+
+void DisplayProcess( void )
+{
+    DisplayLogRecord_t record;
+    static uint32_t droppedReported = 0;
+
+    while( DisplayLogRead( &record ) == true )
+    {
+        switch( record.Event )
+        {
+            case DISPLAY_EVENT_NVM_DATA_CHANGE:
+                PrintNvmDataChange( &record );
+                break;
+            case DISPLAY_EVENT_NETWORK_PARAMETERS:
+                PrintNetworkParametersUpdate( &record );
+                break;
+            case DISPLAY_EVENT_MCPS_REQUEST:
+                PrintMacMcpsRequestUpdate( &record );
+                break;
+            case DISPLAY_EVENT_MLME_REQUEST:
+                PrintMacMlmeRequestUpdate( &record );
+                break;
+            case DISPLAY_EVENT_JOIN_REQUEST:
+                PrintJoinRequestUpdate( &record );
+                break;
+            case DISPLAY_EVENT_TX:
+                PrintTxUpdate( &record );
+                break;
+            case DISPLAY_EVENT_RX:
+                PrintRxUpdate( &record );
+                break;
+            case DISPLAY_EVENT_BEACON:
+                PrintBeaconUpdate( &record );
+                break;
+            case DISPLAY_EVENT_CLASS:
+                PrintClassUpdate( &record );
+                break;
+            case DISPLAY_EVENT_CHANNELS_MASK:
+                PrintChannelsMask( &record );
+                break;
+            default:
+                break;
+        }
+    }
+
+    if( DisplayLog.Dropped != droppedReported )
+    {
+        printf( "\n###### ====== %8lu EVENTS DROPPED ====== ######\n", DisplayLog.Dropped - droppedReported );
+        droppedReported = DisplayLog.Dropped;
+    }
 }
 
 void DisplayAppInfo( const char* appName, const Version_t* appVersion, const Version_t* gitHubVersion )
@@ -25,6 +25,96 @@
 #include "utilities.h"
 #include "LmHandler.h"
 
+/*!
+ * When set to 1 the Display functions only record the events into a RAM
+ * log, which is formatted later on by \ref DisplayProcess. Otherwise the
+ * events are printed right away.
+ */
+#ifndef LMH_MSG_DISPLAY_DEFERRED
+#define LMH_MSG_DISPLAY_DEFERRED                    0
+#endif
+
+/*!
+ * Maximum number of payload bytes kept by a log record
+ */
+#define DISPLAY_LOG_DATA_SIZE                       16
+
+/*!
+ * Event log identifiers
+ */
+typedef enum DisplayLogEvent_e
+{
+    DISPLAY_EVENT_NVM_DATA_CHANGE,
+    DISPLAY_EVENT_NETWORK_PARAMETERS,
+    DISPLAY_EVENT_MCPS_REQUEST,
+    DISPLAY_EVENT_MLME_REQUEST,
+    DISPLAY_EVENT_JOIN_REQUEST,
+    DISPLAY_EVENT_TX,
+    DISPLAY_EVENT_RX,
+    DISPLAY_EVENT_BEACON,
+    DISPLAY_EVENT_CLASS,
+    DISPLAY_EVENT_CHANNELS_MASK,
+}DisplayLogEvent_t;
+
+/*!
+ * Event log record. The meaning of Status and Args depends on the event,
+ * see the matching Display function.
+ */
+typedef struct DisplayLogRecord_s
+{
+    /*!
+     * Time of the event [ms]
+     */
+    TimerTime_t Timestamp;
+    /*!
+     * Event identifier, \ref DisplayLogEvent_t
+     */
+    uint8_t Event;
+    /*!
+     * Event status
+     */
+    uint8_t Status;
+    /*!
+     * Size of the event payload
+     */
+    uint8_t Size;
+    /*!
+     * Number of payload bytes held by Data
+     */
+    uint8_t DataSize;
+    /*!
+     * Event arguments
+     */
+    uint32_t Args[4];
+    /*!
+     * Start of the event payload
+     */
+    uint8_t Data[DISPLAY_LOG_DATA_SIZE];
+}DisplayLogRecord_t;
+
+/*!
+ * \brief Prints the events recorded since the last call. Must be called
+ *        from the main loop while the MAC is idle.
+ */
+void DisplayProcess( void );
+
+/*!
+ * \brief Removes the oldest record from the event log, to be exported
+ *        and decoded by another tool instead of \ref DisplayProcess.
+ *
+ * \param [OUT] record Oldest record
+ *
+ * \retval Returns true, if a record was available.
+ */
+bool DisplayLogRead( DisplayLogRecord_t *record );
+
+/*!
+ * \brief Gets the number of events dropped because the log was full
+ *
+ * \retval Number of dropped events
+ */
+uint32_t DisplayLogGetDropped( void );
+
 /*!
  * \brief Displays NVM context operation state
  *
@@ -32,6 +32,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "utilities.h"
 #include "nvmm.h"
 #include "LoRaMac.h"
@@ -45,6 +46,17 @@
 #define CONTEXT_MANAGEMENT_ENABLED         1
 #endif
 
+/*!
+ * Number of uplink frame counter values reserved by each store of the crypto
+ * context. The stored FCntUp is ahead of the current one by this amount, so
+ * uplinks only require a new store once the reservation is used up. After a
+ * reset the frame counter resumes from the reserved value.
+ * Set to 0 to store the crypto context after each uplink.
+ */
+#ifndef NVM_FCNT_UP_RESERVATION
+#define NVM_FCNT_UP_RESERVATION            32
+#endif
+
 
 static uint16_t NvmNotifyFlags = 0;
 
@@ -53,6 +65,89 @@ void NvmDataMgmtEvent( uint16_t notifyFlags )
     NvmNotifyFlags = notifyFlags;
 }
 
+#if( CONTEXT_MANAGEMENT_ENABLED == 1 )
+/*!
+ * Groups which only hold runtime state updated by each uplink ( frame
+ * counter, ADR counter, duty cycle ). Their store is deferred until the
+ * frame counter reservation is used up or another group changes.
+ */
+#define NVM_DEFERRABLE_NOTIFY_FLAGS        ( LORAMAC_NVM_NOTIFY_FLAG_CRYPTO | \
+                                             LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 | \
+                                             LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 )
+
+/*!
+ * Copy of the crypto context as it is stored in NVM
+ */
+static LoRaMacCryptoNvmData_t NvmCryptoStored;
+static bool NvmCryptoStoredValid = false;
+
+/*!
+ * Groups changed since their last store, whose store was deferred
+ */
+static uint16_t NvmDeferredFlags = LORAMAC_NVM_NOTIFY_FLAG_NONE;
+
+/*!
+ * \brief Checks if the crypto context differs from the stored one by more
+ *        than an uplink frame counter covered by the reservation.
+ *
+ * \param [IN] crypto Current crypto context
+ *
+ * \retval Returns true, if the crypto context has to be stored.
+ */
+static bool NvmCryptoStoreRequired( LoRaMacCryptoNvmData_t* crypto )
+{
+    LoRaMacCryptoNvmData_t current;
+    uint32_t reserved = NvmCryptoStored.FCntList.FCntUp;
+
+    if( NvmCryptoStoredValid == false )
+    {
+        return true;
+    }
+
+    if( ( crypto->FCntList.FCntUp >= reserved ) ||
+        ( ( reserved - crypto->FCntList.FCntUp ) > NVM_FCNT_UP_RESERVATION ) )
+    {
+        // Reservation used up, or frame counter reset
+        return true;
+    }
+
+    memcpy1( ( uint8_t* ) &current, ( uint8_t* ) crypto, sizeof( current ) );
+    current.FCntList.FCntUp = reserved;
+    current.Crc32 = NvmCryptoStored.Crc32;
+
+    return memcmp( &current, &NvmCryptoStored, sizeof( current ) ) != 0;
+}
+
+/*!
+ * \brief Stores the crypto context with the uplink frame counter advanced
+ *        by the reservation.
+ *
+ * \param [IN] crypto Current crypto context
+ * \param [IN] offset NVM offset of the crypto context
+ *
+ * \retval Number of bytes which were stored.
+ */
+static uint16_t NvmCryptoStore( LoRaMacCryptoNvmData_t* crypto, uint16_t offset )
+{
+    uint16_t dataSize = 0;
+
+    memcpy1( ( uint8_t* ) &NvmCryptoStored, ( uint8_t* ) crypto, sizeof( NvmCryptoStored ) );
+
+    if( NVM_FCNT_UP_RESERVATION > 0 )
+    {
+        NvmCryptoStored.FCntList.FCntUp = MIN( crypto->FCntList.FCntUp, UINT32_MAX - NVM_FCNT_UP_RESERVATION ) +
+                                          NVM_FCNT_UP_RESERVATION;
+        NvmCryptoStored.Crc32 = Crc32( ( uint8_t* ) &NvmCryptoStored, sizeof( NvmCryptoStored ) -
+                                                                      sizeof( NvmCryptoStored.Crc32 ) );
+    }
+
+    dataSize = NvmmWrite( ( uint8_t* ) &NvmCryptoStored, sizeof( NvmCryptoStored ), offset );
+    NvmCryptoStoredValid = ( dataSize == sizeof( NvmCryptoStored ) );
+
+    return dataSize;
+}
+#endif
+
 uint16_t NvmDataMgmtStore( void )
 {
 #if( CONTEXT_MANAGEMENT_ENABLED == 1 )
@@ -69,17 +164,30 @@ uint16_t NvmDataMgmtStore( void )
         // There was no update.
         return 0;
     }
+
+    // Uplinks within the frame counter reservation do not need a store
+    if( ( ( NvmNotifyFlags & ~NVM_DEFERRABLE_NOTIFY_FLAGS ) == LORAMAC_NVM_NOTIFY_FLAG_NONE ) &&
+        ( NvmCryptoStoreRequired( &nvm->Crypto ) == false ) )
+    {
+        NvmDeferredFlags |= NvmNotifyFlags;
+        NvmNotifyFlags = LORAMAC_NVM_NOTIFY_FLAG_NONE;
+        return 0;
+    }
+
     if( LoRaMacStop( ) != LORAMAC_STATUS_OK )
     {
         return 0;
     }
 
+    // Store the groups deferred by previous uplinks as well
+    NvmNotifyFlags |= NvmDeferredFlags;
+    NvmDeferredFlags = LORAMAC_NVM_NOTIFY_FLAG_NONE;
+
     // Crypto
     if( ( NvmNotifyFlags & LORAMAC_NVM_NOTIFY_FLAG_CRYPTO ) ==
         LORAMAC_NVM_NOTIFY_FLAG_CRYPTO )
     {
-        dataSize += NvmmWrite( ( uint8_t* ) &nvm->Crypto, sizeof( nvm->Crypto ),
-                               offset );
+        dataSize += NvmCryptoStore( &nvm->Crypto, offset );
     }
     offset += sizeof( nvm->Crypto );
 
@@ -209,6 +317,9 @@ uint16_t NvmDataMgmtRestore( void )
     if( NvmmRead( ( uint8_t* ) nvm, sizeof( LoRaMacNvmData_t ), 0 ) ==
                   sizeof( LoRaMacNvmData_t ) )
     {
+        // The restored FCntUp is the reserved one, uplinks resume from there
+        memcpy1( ( uint8_t* ) &NvmCryptoStored, ( uint8_t* ) &nvm->Crypto, sizeof( NvmCryptoStored ) );
+        NvmCryptoStoredValid = true;
         return sizeof( LoRaMacNvmData_t );
     }
 #endif
@@ -219,6 +330,9 @@ bool NvmDataMgmtFactoryReset( void )
 {
     uint16_t offset = 0;
 #if( CONTEXT_MANAGEMENT_ENABLED == 1 )
+    NvmCryptoStoredValid = false;
+    NvmDeferredFlags = LORAMAC_NVM_NOTIFY_FLAG_NONE;
+
     // Crypto
     if( NvmmReset( sizeof( LoRaMacCryptoNvmData_t ), offset ) == false )
     {
@@ -29,6 +29,7 @@ extern "C"
 #endif
 
 #include "gpio.h"
+#include "timer.h"
 
 /*!
  * \brief Initializes the given GPIO object
@@ -94,6 +95,16 @@ void GpioMcuToggle( Gpio_t *obj );
  */
 uint32_t GpioMcuRead( Gpio_t *obj );
 
+/*!
+ * \brief Gets the time of the last interrupt of the GPIO
+ *
+ * The time is captured on IRQ entry, before the handler is dispatched.
+ *
+ * \param [IN] obj Pointer to the GPIO object
+ * \retval time    RTC ticks of the last interrupt, 0 if it never fired
+ */
+TimerTick_t GpioMcuGetIrqTimestamp( Gpio_t *obj );
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,7 +31,7 @@ extern "C"
 {
 #endif
 
-#include "board-config.h"
+#include <stdint.h>
 
 /*!
  * Low power manager configuration
@@ -62,6 +62,18 @@ typedef enum
     LPM_OFF_MODE,
 } LpmGetMode_t;
 
+/*!
+ * Time spent in each mode, in microseconds
+ */
+typedef struct LpmStats_s
+{
+    uint64_t RunTime;
+    uint64_t SleepTime;
+    uint64_t StopTime;
+    uint32_t SleepCount;
+    uint32_t StopCount;
+}LpmStats_t;
+
 /*!
  * \brief  This API returns the Low Power Mode selected that will be applied when the system will enter low power mode
  *         if there is no update between the time the mode is read with this API and the time the system enters
@@ -101,6 +113,15 @@ void LpmSetOffMode(LpmId_t id, LpmSetMode_t mode );
  */
 void LpmEnterLowPower( void );
 
+/*!
+ * \brief  Gets the time spent in each mode since the boot
+ *
+ * \remark Only available on boards accounting the low power time
+ *
+ * \retval stats Low power statistics
+ */
+const LpmStats_t* LpmGetStats( void );
+
 /*!
  * \brief  This API is called by the low power manager in a critical section (PRIMASK bit set) to allow the
  *         application to implement dedicated code before entering Sleep Mode
@@ -20,9 +20,11 @@
  *
  * \author    Gregory Cristian ( Semtech )
  */
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include "utilities.h"
+#include "entropy.h"
 
 /*!
  * Redefinition of rand() and srand() standard C functions.
@@ -32,16 +34,40 @@
 // Standard random functions redefinition start
 #define RAND_LOCAL_MAX 2147483647L
 
+/*!
+ * Number of rand1 calls between two reseeds from the entropy pool, the pool
+ * is left to the callers needing a full random word such as Radio.Random
+ */
+#ifndef RAND_RESEED_PERIOD
+#define RAND_RESEED_PERIOD 32
+#endif
+
 static uint32_t next = 1;
 
+static uint16_t ReseedCountdown = 0;
+
 int32_t rand1( void )
 {
+    uint32_t sample;
+
+    // Stirs the generator with the entropy collected in the background, the
+    // reseed is retried on the next call while the pool is empty
+    if( ReseedCountdown > 0 )
+    {
+        ReseedCountdown--;
+    }
+    else if( EntropyGet( &sample ) == true )
+    {
+        next ^= sample;
+        ReseedCountdown = RAND_RESEED_PERIOD - 1;
+    }
     return ( ( next = next * 1103515245L + 12345L ) % RAND_LOCAL_MAX );
 }
 
 void srand1( uint32_t seed )
 {
     next = seed;
+    ReseedCountdown = RAND_RESEED_PERIOD;
 }
 // Standard random functions redefinition end
 
@@ -91,29 +117,146 @@ int8_t Nibble2HexChar( uint8_t a )
     }
 }
 
-uint32_t Crc32( uint8_t *buffer, uint16_t length )
+/*!
+ * The CRC calculation follows CCITT - 0x04C11DB7
+ */
+#define CRC32_REVERSED_POLYNOM                      0xEDB88320
+
+#if( CRC_IMPLEMENTATION == CRC_NIBBLE )
+/*!
+ * CRC of each nibble value
+ */
+static const uint32_t Crc32NibbleTable[16] =
 {
-    // The CRC calculation follows CCITT - 0x04C11DB7
-    const uint32_t reversedPolynom = 0xEDB88320;
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+#elif( ( CRC_IMPLEMENTATION == CRC_SLICE_BY_4 ) || ( CRC_IMPLEMENTATION == CRC_SLICE_BY_8 ) )
+#if( CRC_IMPLEMENTATION == CRC_SLICE_BY_4 )
+#define CRC32_SLICES                                4
+#else
+#define CRC32_SLICES                                8
+#endif
 
-    // CRC initial value
-    uint32_t crc = 0xFFFFFFFF;
+/*!
+ * Crc32SliceTable[0] holds the CRC of each byte value, Crc32SliceTable[n]
+ * the CRC of each byte value followed by n zero bytes
+ */
+static uint32_t Crc32SliceTable[CRC32_SLICES][256];
+static bool Crc32SliceTableReady = false;
 
-    if( buffer == NULL )
+static void Crc32SliceTableInit( void )
+{
+    for( uint16_t i = 0; i < 256; i++ )
     {
-        return 0;
+        uint32_t crc = i;
+
+        for( uint8_t j = 0; j < 8; j++ )
+        {
+            crc = ( crc >> 1 ) ^ ( CRC32_REVERSED_POLYNOM & ~( ( crc & 0x01 ) - 1 ) );
+        }
+        Crc32SliceTable[0][i] = crc;
+    }
+    for( uint16_t i = 0; i < 256; i++ )
+    {
+        for( uint8_t n = 1; n < CRC32_SLICES; n++ )
+        {
+            uint32_t crc = Crc32SliceTable[n - 1][i];
+
+            Crc32SliceTable[n][i] = ( crc >> 8 ) ^ Crc32SliceTable[0][crc & 0xFF];
+        }
+    }
+    Crc32SliceTableReady = true;
+}
+
+/*!
+ * Reads a little endian word from a buffer of any alignment
+ */
+static inline uint32_t Crc32ReadWord( const uint8_t *buffer )
+{
+    return ( uint32_t )buffer[0] | ( ( uint32_t )buffer[1] << 8 ) |
+           ( ( uint32_t )buffer[2] << 16 ) | ( ( uint32_t )buffer[3] << 24 );
+}
+#elif( CRC_IMPLEMENTATION != CRC_BITWISE )
+#error "Unsupported CRC_IMPLEMENTATION"
+#endif
+
+/*!
+ * \brief Updates a CRC value, without the initial and final inversions
+ *
+ * \param [IN] crc      Current crc value
+ * \param [IN] buffer   Data buffer
+ * \param [IN] length   Data buffer length
+ *
+ * \retval crc          Updated crc value
+ */
+static uint32_t Crc32Compute( uint32_t crc, const uint8_t *buffer, uint16_t length )
+{
+#if( CRC_IMPLEMENTATION == CRC_NIBBLE )
+    for( uint16_t i = 0; i < length; ++i )
+    {
+        crc ^= ( uint32_t )buffer[i];
+        crc = ( crc >> 4 ) ^ Crc32NibbleTable[crc & 0x0F];
+        crc = ( crc >> 4 ) ^ Crc32NibbleTable[crc & 0x0F];
+    }
+#elif( ( CRC_IMPLEMENTATION == CRC_SLICE_BY_4 ) || ( CRC_IMPLEMENTATION == CRC_SLICE_BY_8 ) )
+    if( Crc32SliceTableReady == false )
+    {
+        Crc32SliceTableInit( );
     }
 
+    while( length >= CRC32_SLICES )
+    {
+        uint32_t word = crc ^ Crc32ReadWord( buffer );
+
+#if( CRC_IMPLEMENTATION == CRC_SLICE_BY_4 )
+        crc = Crc32SliceTable[3][word & 0xFF] ^
+              Crc32SliceTable[2][( word >> 8 ) & 0xFF] ^
+              Crc32SliceTable[1][( word >> 16 ) & 0xFF] ^
+              Crc32SliceTable[0][word >> 24];
+#else
+        uint32_t next = Crc32ReadWord( buffer + 4 );
+
+        crc = Crc32SliceTable[7][word & 0xFF] ^
+              Crc32SliceTable[6][( word >> 8 ) & 0xFF] ^
+              Crc32SliceTable[5][( word >> 16 ) & 0xFF] ^
+              Crc32SliceTable[4][word >> 24] ^
+              Crc32SliceTable[3][next & 0xFF] ^
+              Crc32SliceTable[2][( next >> 8 ) & 0xFF] ^
+              Crc32SliceTable[1][( next >> 16 ) & 0xFF] ^
+              Crc32SliceTable[0][next >> 24];
+#endif
+        buffer += CRC32_SLICES;
+        length -= CRC32_SLICES;
+    }
+
+    while( length-- > 0 )
+    {
+        crc = ( crc >> 8 ) ^ Crc32SliceTable[0][( crc ^ *buffer++ ) & 0xFF];
+    }
+#elif( CRC_IMPLEMENTATION == CRC_BITWISE )
     for( uint16_t i = 0; i < length; ++i )
     {
         crc ^= ( uint32_t )buffer[i];
-        for( uint16_t i = 0; i < 8; i++ )
+        for( uint16_t j = 0; j < 8; j++ )
         {
-            crc = ( crc >> 1 ) ^ ( reversedPolynom & ~( ( crc & 0x01 ) - 1 ) );
+            crc = ( crc >> 1 ) ^ ( CRC32_REVERSED_POLYNOM & ~( ( crc & 0x01 ) - 1 ) );
         }
     }
+#else
+#error "Unsupported CRC_IMPLEMENTATION"
+#endif
+    return crc;
+}
+
+uint32_t Crc32( uint8_t *buffer, uint16_t length )
+{
+    if( buffer == NULL )
+    {
+        return 0;
+    }
 
-    return ~crc;
+    return ~Crc32Compute( 0xFFFFFFFF, buffer, length );
 }
 
 uint32_t Crc32Init( void )
@@ -123,26 +266,12 @@ uint32_t Crc32Init( void )
 
 uint32_t Crc32Update( uint32_t crcInit, uint8_t *buffer, uint16_t length )
 {
-    // The CRC calculation follows CCITT - 0x04C11DB7
-    const uint32_t reversedPolynom = 0xEDB88320;
-
-    // CRC initial value
-    uint32_t crc = crcInit;
-
     if( buffer == NULL )
     {
         return 0;
     }
 
-    for( uint16_t i = 0; i < length; ++i )
-    {
-        crc ^= ( uint32_t )buffer[i];
-        for( uint16_t i = 0; i < 8; i++ )
-        {
-            crc = ( crc >> 1 ) ^ ( reversedPolynom & ~( ( crc & 0x01 ) - 1 ) );
-        }
-    }
-    return crc;
+    return Crc32Compute( crcInit, buffer, length );
 }
 
 uint32_t Crc32Finalize( uint32_t crc )
@@ -72,7 +72,7 @@ uint32_t RtcGetMinimumTimeout( void );
  * \param[IN] milliseconds Time in milliseconds
  * \retval returns time in timer ticks
  */
-uint32_t RtcMs2Tick( TimerTime_t milliseconds );
+TimerTick_t RtcMs2Tick( TimerTime_t milliseconds );
 
 /*!
  * \brief converts time in ticks to time in ms
@@ -80,7 +80,7 @@ uint32_t RtcMs2Tick( TimerTime_t milliseconds );
  * \param[IN] time in timer ticks
  * \retval returns time in milliseconds
  */
-TimerTime_t RtcTick2Ms( uint32_t tick );
+TimerTime_t RtcTick2Ms( TimerTick_t tick );
 
 /*!
  * \brief Performs a delay of milliseconds by polling RTC
@@ -110,7 +110,7 @@ int16_t RtcGetMcuWakeUpTime( void );
  *
  * \param timeout [IN] Duration of the Timer ticks
  */
-void RtcSetAlarm( uint32_t timeout );
+void RtcSetAlarm( TimerTick_t timeout );
 
 /*!
  * \brief Stops the Alarm
@@ -124,21 +124,21 @@ void RtcStopAlarm( void );
  *
  * \param [IN] timeout Timeout value in ticks
  */
-void RtcStartAlarm( uint32_t timeout );
+void RtcStartAlarm( TimerTick_t timeout );
 
 /*!
  * \brief Sets the RTC timer reference
  *
  * \retval value Timer reference value in ticks
  */
-uint32_t RtcSetTimerContext( void );
+TimerTick_t RtcSetTimerContext( void );
   
 /*!
  * \brief Gets the RTC timer reference
  *
  * \retval value Timer value in ticks
  */
-uint32_t RtcGetTimerContext( void );
+TimerTick_t RtcGetTimerContext( void );
 
 /*!
  * \brief Gets the system time with the number of seconds elapsed since epoch
@@ -153,14 +153,14 @@ uint32_t RtcGetCalendarTime( uint16_t *milliseconds );
  *
  * \retval RTC Timer value
  */
-uint32_t RtcGetTimerValue( void );
+TimerTick_t RtcGetTimerValue( void );
 
 /*!
  * \brief Get the RTC timer elapsed time since the last Alarm was set
  *
  * \retval RTC Elapsed time since the last alarm in ticks.
  */
-uint32_t RtcGetTimerElapsedTime( void );
+TimerTick_t RtcGetTimerElapsedTime( void );
 
 /*!
  * \brief Writes data0 and data1 to the RTC backup registers
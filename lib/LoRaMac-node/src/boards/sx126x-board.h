@@ -30,6 +30,7 @@ extern "C"
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "timer.h"
 #include "sx126x/sx126x.h"
 
 /*!
@@ -44,6 +45,13 @@ void SX126xIoInit( void );
  */
 void SX126xIoIrqInit( DioIrqHandler dioIrq );
 
+/*!
+ * \brief Gets the time of the last DIO1 interrupt
+ *
+ * \retval time Time captured on DIO1 IRQ entry [RTC ticks]
+ */
+TimerTick_t SX126xGetDio1IrqTimestamp( void );
+
 /*!
  * \brief De-initializes the radio I/Os pins interface.
  *
@@ -72,10 +80,70 @@ void SX126xIoDbgInit( void );
 void SX126xReset( void );
 
 /*!
- * \brief Blocking loop to wait while the Busy pin in high
+ * Number of opcodes tracked by the BUSY time statistics
+ */
+#define SX126X_BUSY_STATS_OPCODES                   24
+
+/*!
+ * Number of BUSY time histogram bins. Bin 0 counts waits below 16 us and
+ * each following bin covers 4 times the duration of the previous one.
+ */
+#define SX126X_BUSY_STATS_BINS                      8
+
+/*!
+ * BUSY time statistics of an opcode
+ */
+typedef struct SX126xBusyOpcodeStats_s
+{
+    /*!
+     * Opcode which set the BUSY line
+     */
+    uint8_t Opcode;
+    /*!
+     * Number of waits per duration range
+     */
+    uint16_t Bins[SX126X_BUSY_STATS_BINS];
+    /*!
+     * Longest wait [us]
+     */
+    uint32_t MaxTime;
+}SX126xBusyOpcodeStats_t;
+
+/*!
+ * BUSY time statistics
+ */
+typedef struct SX126xBusyStats_s
+{
+    /*!
+     * Number of waits which timed out
+     */
+    uint32_t Timeouts;
+    /*!
+     * Opcode of the last wait which timed out
+     */
+    uint8_t TimeoutOpcode;
+    /*!
+     * Number of valid entries in Opcodes
+     */
+    uint8_t NbOpcodes;
+    /*!
+     * Per opcode statistics, in order of first use
+     */
+    SX126xBusyOpcodeStats_t Opcodes[SX126X_BUSY_STATS_OPCODES];
+}SX126xBusyStats_t;
+
+/*!
+ * \brief Waits while the Busy pin is high, gives up after a timeout
  */
 void SX126xWaitOnBusy( void );
 
+/*!
+ * \brief Gets the BUSY time statistics
+ *
+ * \retval stats Statistics collected since startup
+ */
+const SX126xBusyStats_t* SX126xGetBusyStats( void );
+
 /*!
  * \brief Wakes up the radio
  */
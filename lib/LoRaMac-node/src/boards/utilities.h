@@ -71,6 +71,25 @@ extern "C"
  */
 #define POW2( n ) ( 1 << n )
 
+/*!
+ * CRC implementations, selected at compile time by CRC_IMPLEMENTATION
+ *
+ * CRC_BITWISE    : One bit per iteration, no table
+ * CRC_NIBBLE     : 4 bits per iteration, 16 entries tables in flash
+ * CRC_SLICE_BY_4 : 4 bytes per iteration, 4 kB table in RAM
+ * CRC_SLICE_BY_8 : 8 bytes per iteration, 8 kB table in RAM
+ *
+ * The RAM tables are computed on first use.
+ */
+#define CRC_BITWISE                                 0
+#define CRC_NIBBLE                                  1
+#define CRC_SLICE_BY_4                              2
+#define CRC_SLICE_BY_8                              3
+
+#ifndef CRC_IMPLEMENTATION
+#define CRC_IMPLEMENTATION                          CRC_SLICE_BY_4
+#endif
+
 /*!
  * Version
  */
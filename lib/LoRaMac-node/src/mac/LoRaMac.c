@@ -30,6 +30,8 @@
  *
  * \author    Johannes Bruder ( STACKFORCE )
  */
+#include <string.h>
+
 #include "utilities.h"
 #include "region/Region.h"
 #include "LoRaMacClassB.h"
@@ -98,6 +100,7 @@ enum eLoRaMacState
     LORAMAC_TX_DELAYED    = 0x00000020,
     LORAMAC_TX_CONFIG     = 0x00000040,
     LORAMAC_RX_ABORT      = 0x00000080,
+    LORAMAC_TX_SENSING    = 0x00000100,
 };
 
 /*
@@ -174,6 +177,10 @@ typedef struct sLoRaMacCtx
     RxConfigParams_t RxWindow1Config;
     RxConfigParams_t RxWindow2Config;
     RxConfigParams_t RxWindowCConfig;
+    /*
+     * Class C reception in radio duty cycle
+     */
+    bool RxCSniff;
     /*
      * Limit of uplinks without any donwlink response before the ADRACKReq bit will be set.
      */
@@ -250,12 +257,53 @@ typedef struct sLoRaMacCtx
     uint8_t MacCommandsBuffer[LORA_MAC_COMMAND_MAX_LENGTH];
 }LoRaMacCtx_t;
 
+#if( LORAMAC_CONTEXTS > 1 )
+/*
+ * Module contexts, one per end device. ContextId selects the one in use.
+ */
+static LoRaMacCtx_t MacCtxList[LORAMAC_CONTEXTS];
+
+static LoRaMacNvmData_t NvmList[LORAMAC_CONTEXTS];
+
+static uint16_t ContextId = 0;
+
+#define MacCtx                                      MacCtxList[ContextId]
+#define Nvm                                         NvmList[ContextId]
+
+#if( TIMER_LISTS < LORAMAC_CONTEXTS )
+#error "TIMER_LISTS must provide a timer list per LoRaMac context"
+#endif
+#else
 /*
  * Module context.
  */
 static LoRaMacCtx_t MacCtx;
 
 static LoRaMacNvmData_t Nvm;
+#endif
+
+/*!
+ * All the NVM groups
+ */
+#define LORAMAC_NVM_GROUPS_ALL                      ( LORAMAC_NVM_NOTIFY_FLAG_CRYPTO | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_SECURE_ELEMENT | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_CLASS_B )
+
+/*!
+ * NVM groups which may have been modified since the last call to
+ * LoRaMacHandleNvm. Only their CRC gets recomputed.
+ */
+#if( LORAMAC_CONTEXTS > 1 )
+static uint16_t NvmDirtyGroupsList[LORAMAC_CONTEXTS];
+
+#define NvmDirtyGroups                              NvmDirtyGroupsList[ContextId]
+#else
+static uint16_t NvmDirtyGroups = LORAMAC_NVM_GROUPS_ALL;
+#endif
 
 /*!
  * Defines the LoRaMac radio events status
@@ -270,13 +318,20 @@ typedef union uLoRaMacRadioEvents
         uint32_t TxTimeout : 1;
         uint32_t RxDone    : 1;
         uint32_t TxDone    : 1;
+        uint32_t ChannelSenseDone : 1;
     }Events;
 }LoRaMacRadioEvents_t;
 
 /*!
  * LoRaMac radio events status
  */
+#if( LORAMAC_CONTEXTS > 1 )
+static LoRaMacRadioEvents_t LoRaMacRadioEventsList[LORAMAC_CONTEXTS];
+
+#define LoRaMacRadioEvents                          LoRaMacRadioEventsList[ContextId]
+#else
 LoRaMacRadioEvents_t LoRaMacRadioEvents = { .Value = 0 };
+#endif
 
 /*!
  * \brief Function to be executed on Radio Tx Done event
@@ -437,6 +492,25 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
  */
 static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx );
 
+/*
+ * \brief Selects the channel of the serialized frame and sends it, once the
+ *        listen before talk found the channel free if the region requires it
+ *
+ * \param [IN] allowDelayedTx When set to true, the a frame will be delayed,
+ *                            the duty cycle restriction is active
+ * \param [IN] carrierSenseBusy Set to true, if the carrier sense in progress
+ *                              found the channel busy
+ * \retval Status of the operation
+ */
+static LoRaMacStatus_t ScheduleTxOnNextChannel( bool allowDelayedTx, bool carrierSenseBusy );
+
+/*
+ * \brief Sends the serialized frame on the channel selected
+ *
+ * \retval Status of the operation
+ */
+static LoRaMacStatus_t SendFrameOnSelectedChannel( void );
+
 /*
  * \brief Secures the current processed frame ( TxMsg )
  * \param[IN]     txDr      Data rate used for the transmission
@@ -581,6 +655,13 @@ static bool StopRetransmission( void );
  */
 static void CallNvmDataChangeCallback( uint16_t notifyFlags );
 
+/*!
+ * \brief Marks NVM groups as modified, to be checked by LoRaMacHandleNvm
+ *
+ * \param [IN] groups Bitmap of LORAMAC_NVM_NOTIFY_FLAG_XXX
+ */
+static void SetNvmGroupsDirty( uint16_t groups );
+
 /*!
  * \brief Verifies if a request is pending currently
  *
@@ -667,9 +748,31 @@ struct
     int8_t Snr;
 }RxDoneParams;
 
+/*!
+ * Structure used to store the radio channel sense event data
+ */
+struct
+{
+    bool ChannelFree;
+}ChannelSenseDoneParams;
+
+/*!
+ * \brief Gets the time of the radio irq being handled
+ *
+ * \retval time IRQ entry time when the radio captures it, current time otherwise
+ */
+static TimerTime_t GetRadioIrqTime( void )
+{
+    if( Radio.GetIrqTime != NULL )
+    {
+        return Radio.GetIrqTime( );
+    }
+    return TimerGetCurrentTime( );
+}
+
 static void OnRadioTxDone( void )
 {
-    TxDoneParams.CurTime = TimerGetCurrentTime( );
+    TxDoneParams.CurTime = GetRadioIrqTime( );
     MacCtx.LastTxSysTime = SysTimeGet( );
 
     LoRaMacRadioEvents.Events.TxDone = 1;
@@ -682,7 +785,7 @@ static void OnRadioTxDone( void )
 
 static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
 {
-    RxDoneParams.LastRxDone = TimerGetCurrentTime( );
+    RxDoneParams.LastRxDone = GetRadioIrqTime( );
     RxDoneParams.Payload = payload;
     RxDoneParams.Size = size;
     RxDoneParams.Rssi = rssi;
@@ -726,6 +829,18 @@ static void OnRadioRxTimeout( void )
     }
 }
 
+static void OnRadioChannelSenseDone( bool channelFree )
+{
+    ChannelSenseDoneParams.ChannelFree = channelFree;
+
+    LoRaMacRadioEvents.Events.ChannelSenseDone = 1;
+
+    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
+    {
+        MacCtx.MacCallbacks->MacProcessNotify( );
+    }
+}
+
 static void UpdateRxSlotIdleState( void )
 {
     if( Nvm.MacGroup2.DeviceClass != CLASS_C )
@@ -743,15 +858,18 @@ static void ProcessRadioTxDone( void )
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
     SetBandTxDoneParams_t txDone;
+    TimerTime_t latency;
 
     if( Nvm.MacGroup2.DeviceClass != CLASS_C )
     {
         Radio.Sleep( );
     }
-    // Setup timers
-    TimerSetValue( &MacCtx.RxWindowTimer1, MacCtx.RxWindow1Delay );
+    // Setup timers, the windows are relative to the end of the transmission
+    // and not to the time the event gets processed
+    latency = TimerGetElapsedTime( TxDoneParams.CurTime );
+    TimerSetValue( &MacCtx.RxWindowTimer1, ( MacCtx.RxWindow1Delay > latency ) ? ( MacCtx.RxWindow1Delay - latency ) : 1 );
     TimerStart( &MacCtx.RxWindowTimer1 );
-    TimerSetValue( &MacCtx.RxWindowTimer2, MacCtx.RxWindow2Delay );
+    TimerSetValue( &MacCtx.RxWindowTimer2, ( MacCtx.RxWindow2Delay > latency ) ? ( MacCtx.RxWindow2Delay - latency ) : 1 );
     TimerStart( &MacCtx.RxWindowTimer2 );
 
     if( MacCtx.NodeAckRequested == true )
@@ -769,6 +887,7 @@ static void ProcessRadioTxDone( void )
 
     // Update Aggregated last tx done time
     Nvm.MacGroup1.LastTxDoneTime = TxDoneParams.CurTime;
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 );
 
     // Update last tx done time for the current channel
     txDone.Channel = MacCtx.Channel;
@@ -888,6 +1007,7 @@ static void ProcessRadioRxDone( void )
                 PrepareRxDoneAbort( );
                 return;
             }
+            SetNvmGroupsDirty( LORAMAC_NVM_GROUPS_ALL );
             macCryptoStatus = LoRaMacCryptoHandleJoinAccept( JOIN_REQ, SecureElementGetJoinEui( ), &macMsgJoinAccept );
 
             if( LORAMAC_CRYPTO_SUCCESS == macCryptoStatus )
@@ -1050,6 +1170,8 @@ static void ProcessRadioRxDone( void )
                 return;
             }
 
+            SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_CRYPTO | LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 |
+                               LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 );
             macCryptoStatus = LoRaMacCryptoUnsecureMessage( addrID, address, fCntID, downLinkCounter, &macMsgData );
             if( macCryptoStatus != LORAMAC_CRYPTO_SUCCESS )
             {
@@ -1316,6 +1438,55 @@ static void ProcessRadioRxTimeout( void )
     HandleRadioRxErrorTimeout( LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT, LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT );
 }
 
+static void ProcessRadioChannelSenseDone( void )
+{
+    LoRaMacStatus_t status = LORAMAC_STATUS_OK;
+    LoRaMacEventInfoStatus_t eventInfoStatus = LORAMAC_EVENT_INFO_STATUS_ERROR;
+
+    if( ( MacCtx.MacState & LORAMAC_TX_SENSING ) != LORAMAC_TX_SENSING )
+    {
+        return;
+    }
+    MacCtx.MacState &= ~LORAMAC_TX_SENSING;
+
+    if( ChannelSenseDoneParams.ChannelFree == true )
+    {
+        status = SendFrameOnSelectedChannel( );
+    }
+    else
+    {
+        // The region senses another channel, delaying the frame is not
+        // possible anymore
+        status = ScheduleTxOnNextChannel( false, true );
+    }
+
+    if( status == LORAMAC_STATUS_OK )
+    {
+        return;
+    }
+
+    // The frame could not be sent, the attempt counts as a transmission
+    if( Nvm.MacGroup2.DeviceClass != CLASS_C )
+    {
+        Radio.Sleep( );
+    }
+    UpdateRxSlotIdleState( );
+
+    if( status == LORAMAC_STATUS_NO_FREE_CHANNEL_FOUND )
+    {
+        eventInfoStatus = LORAMAC_EVENT_INFO_STATUS_CHANNEL_BUSY;
+    }
+    MacCtx.ChannelsNbTransCounter++;
+    MacCtx.McpsConfirm.NbTrans = MacCtx.ChannelsNbTransCounter;
+    MacCtx.McpsConfirm.Status = eventInfoStatus;
+    LoRaMacConfirmQueueSetStatusCmn( eventInfoStatus );
+    if( MacCtx.NodeAckRequested == true )
+    {
+        MacCtx.RetransmitTimeoutRetry = true;
+    }
+    MacCtx.MacFlags.Bits.MacDone = 1;
+}
+
 static void LoRaMacHandleIrqEvents( void )
 {
     LoRaMacRadioEvents_t events;
@@ -1347,6 +1518,10 @@ static void LoRaMacHandleIrqEvents( void )
         {
             ProcessRadioRxTimeout( );
         }
+        if( events.Events.ChannelSenseDone == 1 )
+        {
+            ProcessRadioChannelSenseDone( );
+        }
     }
 }
 
@@ -1553,72 +1728,100 @@ static void LoRaMacHandleNvm( LoRaMacNvmData_t* nvmData )
 {
     uint32_t crc = 0;
     uint16_t notifyFlags = LORAMAC_NVM_NOTIFY_FLAG_NONE;
+    uint16_t dirtyGroups = LORAMAC_NVM_NOTIFY_FLAG_NONE;
 
     if( MacCtx.MacState != LORAMAC_IDLE )
     {
         return;
     }
 
+    // Only the groups modified since the last call may have changed
+    CRITICAL_SECTION_BEGIN( );
+    dirtyGroups = NvmDirtyGroups;
+    NvmDirtyGroups = LORAMAC_NVM_NOTIFY_FLAG_NONE;
+    CRITICAL_SECTION_END( );
+
     // Crypto
-    crc = Crc32( ( uint8_t* ) &nvmData->Crypto, sizeof( nvmData->Crypto ) -
-                                                sizeof( nvmData->Crypto.Crc32 ) );
-    if( crc != nvmData->Crypto.Crc32 )
+    if( ( dirtyGroups & LORAMAC_NVM_NOTIFY_FLAG_CRYPTO ) != 0 )
     {
-        nvmData->Crypto.Crc32 = crc;
-        notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_CRYPTO;
+        crc = Crc32( ( uint8_t* ) &nvmData->Crypto, sizeof( nvmData->Crypto ) -
+                                                sizeof( nvmData->Crypto.Crc32 ) );
+        if( crc != nvmData->Crypto.Crc32 )
+        {
+            nvmData->Crypto.Crc32 = crc;
+            notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_CRYPTO;
+        }
     }
 
     // MacGroup1
-    crc = Crc32( ( uint8_t* ) &nvmData->MacGroup1, sizeof( nvmData->MacGroup1 ) -
-                                                   sizeof( nvmData->MacGroup1.Crc32 ) );
-    if( crc != nvmData->MacGroup1.Crc32 )
+    if( ( dirtyGroups & LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 ) != 0 )
     {
-        nvmData->MacGroup1.Crc32 = crc;
-        notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1;
+        crc = Crc32( ( uint8_t* ) &nvmData->MacGroup1, sizeof( nvmData->MacGroup1 ) -
+                                                sizeof( nvmData->MacGroup1.Crc32 ) );
+        if( crc != nvmData->MacGroup1.Crc32 )
+        {
+            nvmData->MacGroup1.Crc32 = crc;
+            notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1;
+        }
     }
 
     // MacGroup2
-    crc = Crc32( ( uint8_t* ) &nvmData->MacGroup2, sizeof( nvmData->MacGroup2 ) -
-                                                   sizeof( nvmData->MacGroup2.Crc32 ) );
-    if( crc != nvmData->MacGroup2.Crc32 )
+    if( ( dirtyGroups & LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 ) != 0 )
     {
-        nvmData->MacGroup2.Crc32 = crc;
-        notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2;
+        crc = Crc32( ( uint8_t* ) &nvmData->MacGroup2, sizeof( nvmData->MacGroup2 ) -
+                                                sizeof( nvmData->MacGroup2.Crc32 ) );
+        if( crc != nvmData->MacGroup2.Crc32 )
+        {
+            nvmData->MacGroup2.Crc32 = crc;
+            notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2;
+        }
     }
 
     // Secure Element
-    crc = Crc32( ( uint8_t* ) &nvmData->SecureElement, sizeof( nvmData->SecureElement ) -
-                                                       sizeof( nvmData->SecureElement.Crc32 ) );
-    if( crc != nvmData->SecureElement.Crc32 )
+    if( ( dirtyGroups & LORAMAC_NVM_NOTIFY_FLAG_SECURE_ELEMENT ) != 0 )
     {
-        nvmData->SecureElement.Crc32 = crc;
-        notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_SECURE_ELEMENT;
+        crc = Crc32( ( uint8_t* ) &nvmData->SecureElement, sizeof( nvmData->SecureElement ) -
+                                                sizeof( nvmData->SecureElement.Crc32 ) );
+        if( crc != nvmData->SecureElement.Crc32 )
+        {
+            nvmData->SecureElement.Crc32 = crc;
+            notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_SECURE_ELEMENT;
+        }
     }
 
     // Region
-    crc = Crc32( ( uint8_t* ) &nvmData->RegionGroup1, sizeof( nvmData->RegionGroup1 ) -
-                                                sizeof( nvmData->RegionGroup1.Crc32 ) );
-    if( crc != nvmData->RegionGroup1.Crc32 )
+    if( ( dirtyGroups & LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 ) != 0 )
     {
-        nvmData->RegionGroup1.Crc32 = crc;
-        notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1;
+        crc = Crc32( ( uint8_t* ) &nvmData->RegionGroup1, sizeof( nvmData->RegionGroup1 ) -
+                                                sizeof( nvmData->RegionGroup1.Crc32 ) );
+        if( crc != nvmData->RegionGroup1.Crc32 )
+        {
+            nvmData->RegionGroup1.Crc32 = crc;
+            notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1;
+        }
     }
 
-    crc = Crc32( ( uint8_t* ) &nvmData->RegionGroup2, sizeof( nvmData->RegionGroup2 ) -
-                                                sizeof( nvmData->RegionGroup2.Crc32 ) );
-    if( crc != nvmData->RegionGroup2.Crc32 )
+    if( ( dirtyGroups & LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 ) != 0 )
     {
-        nvmData->RegionGroup2.Crc32 = crc;
-        notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2;
+        crc = Crc32( ( uint8_t* ) &nvmData->RegionGroup2, sizeof( nvmData->RegionGroup2 ) -
+                                                sizeof( nvmData->RegionGroup2.Crc32 ) );
+        if( crc != nvmData->RegionGroup2.Crc32 )
+        {
+            nvmData->RegionGroup2.Crc32 = crc;
+            notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2;
+        }
     }
 
     // ClassB
-    crc = Crc32( ( uint8_t* ) &nvmData->ClassB, sizeof( nvmData->ClassB ) -
-                                                sizeof( nvmData->ClassB.Crc32 ) );
-    if( crc != nvmData->ClassB.Crc32 )
+    if( ( dirtyGroups & LORAMAC_NVM_NOTIFY_FLAG_CLASS_B ) != 0 )
     {
-        nvmData->ClassB.Crc32 = crc;
-        notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_CLASS_B;
+        crc = Crc32( ( uint8_t* ) &nvmData->ClassB, sizeof( nvmData->ClassB ) -
+                                                sizeof( nvmData->ClassB.Crc32 ) );
+        if( crc != nvmData->ClassB.Crc32 )
+        {
+            nvmData->ClassB.Crc32 = crc;
+            notifyFlags |= LORAMAC_NVM_NOTIFY_FLAG_CLASS_B;
+        }
     }
 
     CallNvmDataChangeCallback( notifyFlags );
@@ -1632,6 +1835,12 @@ void LoRaMacProcess( void )
     LoRaMacHandleIrqEvents( );
     LoRaMacClassBProcess( );
 
+    if( Nvm.MacGroup2.DeviceClass == CLASS_B )
+    {
+        // Beacon events may reset the class B state
+        SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_CLASS_B );
+    }
+
     // MAC proceeded a state and is ready to check
     if( MacCtx.MacFlags.Bits.MacDone == 1 )
     {
@@ -1655,7 +1864,8 @@ void LoRaMacProcess( void )
         LoRaMacEnableRequests( LORAMAC_REQUEST_HANDLING_ON );
     }
     LoRaMacHandleIndicationEvents( );
-    if( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C )
+    if( ( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C ) &&
+        ( ( MacCtx.MacState & LORAMAC_TX_SENSING ) != LORAMAC_TX_SENSING ) )
     {
         OpenContinuousRxCWindow( );
     }
@@ -1793,6 +2003,8 @@ static LoRaMacStatus_t SwitchClass( DeviceClass_t deviceClass )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_PARAMETER_INVALID;
 
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 | LORAMAC_NVM_NOTIFY_FLAG_CLASS_B );
+
     switch( Nvm.MacGroup2.DeviceClass )
     {
         case CLASS_A:
@@ -1922,6 +2134,11 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
         return;
     }
 
+    // MAC commands update the MAC, region and class B parameters
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 |
+                       LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 |
+                       LORAMAC_NVM_NOTIFY_FLAG_CLASS_B );
+
     while( macIndex < commandsSize )
     {
         // Make sure to parse only complete MAC commands
@@ -2308,6 +2525,7 @@ LoRaMacStatus_t Send( LoRaMacHeader_t* macHdr, uint8_t fPort, void* fBuffer, uin
     int8_t datarate = Nvm.MacGroup1.ChannelsDatarate;
     int8_t txPower = Nvm.MacGroup1.ChannelsTxPower;
     uint32_t adrAckCounter = Nvm.MacGroup1.AdrAckCounter;
+    uint8_t nbTrans = Nvm.MacGroup2.MacParams.ChannelsNbTrans;
     CalcNextAdrParams_t adrNext;
 
     // Check if we are joined
@@ -2356,6 +2574,17 @@ LoRaMacStatus_t Send( LoRaMacHeader_t* macHdr, uint8_t fPort, void* fBuffer, uin
                                                &Nvm.MacGroup1.ChannelsTxPower,
                                                &Nvm.MacGroup2.MacParams.ChannelsNbTrans, &adrAckCounter );
 
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 );
+    if( Nvm.MacGroup2.MacParams.ChannelsNbTrans != nbTrans )
+    {
+        SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 );
+    }
+    if( adrNext.AdrAckCounter >= ( uint32_t )( adrNext.AdrAckLimit + ( adrNext.AdrAckDelay << 1 ) ) )
+    {
+        // The ADR back off may have restored the default channels
+        SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 );
+    }
+
     // Prepare the frame
     status = PrepareFrame( macHdr, &fCtrl, fPort, fBuffer, fBufferSize );
 
@@ -2528,7 +2757,6 @@ static LoRaMacStatus_t SerializeTxFrame( void )
 static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_PARAMETER_INVALID;
-    NextChanParams_t nextChan;
 
     // Check class b collisions
     status = CheckForClassBCollision( );
@@ -2547,6 +2775,15 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
         return status;
     }
 
+    return ScheduleTxOnNextChannel( allowDelayedTx, false );
+}
+
+static LoRaMacStatus_t ScheduleTxOnNextChannel( bool allowDelayedTx, bool carrierSenseBusy )
+{
+    LoRaMacStatus_t status = LORAMAC_STATUS_PARAMETER_INVALID;
+    NextChanParams_t nextChan;
+    uint16_t channelsMask[REGION_NVM_CHANNELS_MASK_SIZE];
+
     nextChan.AggrTimeOff = Nvm.MacGroup1.AggregatedTimeOff;
     nextChan.Datarate = Nvm.MacGroup1.ChannelsDatarate;
     nextChan.DutyCycleEnabled = Nvm.MacGroup2.DutyCycleOn;
@@ -2555,6 +2792,8 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
     nextChan.LastTxIsJoinRequest = false;
     nextChan.Joined = true;
     nextChan.PktLen = MacCtx.PktBufferLen;
+    nextChan.CarrierSenseBusy = carrierSenseBusy;
+    nextChan.CarrierSensePending = false;
 
     // Setup the parameters based on the join status
     if( Nvm.MacGroup2.NetworkActivation == ACTIVATION_TYPE_NONE )
@@ -2564,8 +2803,17 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
     }
 
     // Select channel
+    memcpy1( ( uint8_t* ) channelsMask, ( uint8_t* ) Nvm.RegionGroup2.ChannelsMask, sizeof( channelsMask ) );
     status = RegionNextChannel( Nvm.MacGroup2.Region, &nextChan, &MacCtx.Channel, &MacCtx.DutyCycleWaitTime, &Nvm.MacGroup1.AggregatedTimeOff );
 
+    // The band time off is updated, and the default channels are enabled
+    // again in case all channels were disabled
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 );
+    if( memcmp( channelsMask, Nvm.RegionGroup2.ChannelsMask, sizeof( channelsMask ) ) != 0 )
+    {
+        SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 );
+    }
+
     if( status != LORAMAC_STATUS_OK )
     {
         if( ( status == LORAMAC_STATUS_DUTYCYCLE_RESTRICTED ) &&
@@ -2587,6 +2835,18 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
         }
     }
 
+    if( nextChan.CarrierSensePending == true )
+    {// Send once the radio reports the channel free
+        MacCtx.MacState |= LORAMAC_TX_SENSING;
+        return LORAMAC_STATUS_OK;
+    }
+    return SendFrameOnSelectedChannel( );
+}
+
+static LoRaMacStatus_t SendFrameOnSelectedChannel( void )
+{
+    LoRaMacStatus_t status = LORAMAC_STATUS_PARAMETER_INVALID;
+
     // Compute window parameters, offsets, rx symbols, system errors etc.
     ComputeRxWindowParameters( );
 
@@ -2606,6 +2866,9 @@ static LoRaMacStatus_t SecureFrame( uint8_t txDr, uint8_t txCh )
     LoRaMacCryptoStatus_t macCryptoStatus = LORAMAC_CRYPTO_ERROR;
     uint32_t fCntUp = 0;
 
+    // Updates the DevNonce or the uplink frame counter
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_CRYPTO );
+
     switch( MacCtx.TxMsg.Type )
     {
         case LORAMAC_MSG_TYPE_JOIN_REQUEST:
@@ -2681,6 +2944,10 @@ static void ResetMacParameters( void )
     LoRaMacClassBCallback_t classBCallbacks;
     LoRaMacClassBParams_t classBParams;
 
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 |
+                       LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 |
+                       LORAMAC_NVM_NOTIFY_FLAG_CLASS_B );
+
     Nvm.MacGroup2.NetworkActivation = ACTIVATION_TYPE_NONE;
 
     // ADR counter
@@ -2792,7 +3059,15 @@ static void OpenContinuousRxCWindow( void )
     // Thus, there is no need to set the radio in standby mode.
     if( RegionRxConfig( Nvm.MacGroup2.Region, &MacCtx.RxWindowCConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate ) == true )
     {
-        Radio.Rx( 0 ); // Continuous mode
+        if( MacCtx.RxCSniff == true )
+        {
+            // Duty cycled, without missing a preamble
+            Radio.RxSniff( );
+        }
+        else
+        {
+            Radio.Rx( 0 ); // Continuous mode
+        }
         MacCtx.RxSlot = MacCtx.RxWindowCConfig.RxSlot;
     }
 }
@@ -3177,6 +3452,7 @@ static bool StopRetransmission( void )
         if( Nvm.MacGroup2.AdrCtrlOn == true )
         {
             Nvm.MacGroup1.AdrAckCounter = IncreaseAdrAckCounter( Nvm.MacGroup1.AdrAckCounter );
+            SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 );
         }
     }
 
@@ -3196,6 +3472,13 @@ static void CallNvmDataChangeCallback( uint16_t notifyFlags )
         MacCtx.MacCallbacks->NvmDataChange ( notifyFlags );
     }
 }
+
+static void SetNvmGroupsDirty( uint16_t groups )
+{
+    CRITICAL_SECTION_BEGIN( );
+    NvmDirtyGroups |= groups;
+    CRITICAL_SECTION_END( );
+}
 static uint8_t IsRequestPending( void )
 {
     if( ( MacCtx.MacFlags.Bits.MlmeReq == 1 ) ||
@@ -3367,6 +3650,7 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     MacCtx.RadioEvents.RxError = OnRadioRxError;
     MacCtx.RadioEvents.TxTimeout = OnRadioTxTimeout;
     MacCtx.RadioEvents.RxTimeout = OnRadioRxTimeout;
+    MacCtx.RadioEvents.ChannelSenseDone = OnRadioChannelSenseDone;
     Radio.Init( &MacCtx.RadioEvents );
 
     // Initialize the Secure Element driver
@@ -3399,11 +3683,41 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     Radio.SetPublicNetwork( Nvm.MacGroup2.PublicNetwork );
     Radio.Sleep( );
 
+    SetNvmGroupsDirty( LORAMAC_NVM_GROUPS_ALL );
+
     LoRaMacEnableRequests( LORAMAC_REQUEST_HANDLING_ON );
 
     return LORAMAC_STATUS_OK;
 }
 
+LoRaMacStatus_t LoRaMacContextSelect( uint16_t id )
+{
+    if( id >= LORAMAC_CONTEXTS )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+
+#if( LORAMAC_CONTEXTS > 1 )
+    InitDefaultsParams_t params;
+
+    ContextId = id;
+
+    LoRaMacCommandsContextSelect( id );
+    LoRaMacConfirmQueueContextSelect( id );
+    LoRaMacClassBContextSelect( id );
+    LoRaMacCryptoContextSelect( id );
+    SecureElementContextSelect( id );
+    TimerListSelect( id );
+
+    // The regions keep pointers to the non-volatile data of the context
+    params.Type = INIT_TYPE_SELECT_NVM;
+    params.NvmGroup1 = &Nvm.RegionGroup1;
+    params.NvmGroup2 = &Nvm.RegionGroup2;
+    RegionInitDefaults( Nvm.MacGroup2.Region, &params );
+#endif
+    return LORAMAC_STATUS_OK;
+}
+
 LoRaMacStatus_t LoRaMacStart( void )
 {
     MacCtx.MacState = LORAMAC_IDLE;
@@ -3671,6 +3985,11 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
             mibGet->Param.IsCertPortOn = Nvm.MacGroup2.IsCertPortOn;
             break;
         }
+        case MIB_RXC_SNIFF:
+        {
+            mibGet->Param.RxCSniff = MacCtx.RxCSniff;
+            break;
+        }
         default:
         {
             status = LoRaMacClassBMibGetRequestConfirm( mibGet );
@@ -3695,6 +4014,9 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
         return LORAMAC_STATUS_BUSY;
     }
 
+    // MIB changes are rare, check all the groups afterwards
+    SetNvmGroupsDirty( LORAMAC_NVM_GROUPS_ALL );
+
     switch( mibSet->Type )
     {
         case MIB_DEVICE_CLASS:
@@ -4227,6 +4549,7 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             if( RegionVerify( Nvm.MacGroup2.Region, &verify, PHY_TX_DR ) == true )
             {
                 Nvm.MacGroup1.ChannelsDatarate = verify.DatarateParams.Datarate;
+                SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 );
             }
             else
             {
@@ -4316,6 +4639,11 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             Nvm.MacGroup2.IsCertPortOn = mibSet->Param.IsCertPortOn;
             break;
         }
+        case MIB_RXC_SNIFF:
+        {
+            MacCtx.RxCSniff = mibSet->Param.RxCSniff;
+            break;
+        }
         default:
         {
             status = LoRaMacMibClassBSetRequestConfirm( mibSet );
@@ -4338,6 +4666,8 @@ LoRaMacStatus_t LoRaMacChannelAdd( uint8_t id, ChannelParams_t params )
         }
     }
 
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 );
+
     channelAdd.NewChannel = &params;
     channelAdd.ChannelId = id;
     return RegionChannelAdd( Nvm.MacGroup2.Region, &channelAdd );
@@ -4355,6 +4685,8 @@ LoRaMacStatus_t LoRaMacChannelRemove( uint8_t id )
         }
     }
 
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 );
+
     channelRemove.ChannelId = id;
 
     if( RegionChannelsRemove( Nvm.MacGroup2.Region, &channelRemove ) == false )
@@ -4371,6 +4703,9 @@ LoRaMacStatus_t LoRaMacMcChannelSetup( McChannelParams_t *channel )
         return LORAMAC_STATUS_BUSY;
     }
 
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_CRYPTO | LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 |
+                       LORAMAC_NVM_NOTIFY_FLAG_SECURE_ELEMENT | LORAMAC_NVM_NOTIFY_FLAG_CLASS_B );
+
     if( channel->GroupID >= LORAMAC_MAX_MC_CTX )
     {
         return LORAMAC_STATUS_MC_GROUP_UNDEFINED;
@@ -4423,6 +4758,8 @@ LoRaMacStatus_t LoRaMacMcChannelDelete( AddressIdentifier_t groupID )
         return LORAMAC_STATUS_BUSY;
     }
 
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 );
+
     if( ( groupID >= LORAMAC_MAX_MC_CTX ) ||
         ( Nvm.MacGroup2.MulticastChannelList[groupID].ChannelParams.IsEnabled == false ) )
     {
@@ -4459,6 +4796,8 @@ LoRaMacStatus_t LoRaMacMcChannelSetupRxParams( AddressIdentifier_t groupID, McRx
         return LORAMAC_STATUS_BUSY;
     }
 
+    SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 );
+
     DeviceClass_t devClass = Nvm.MacGroup2.MulticastChannelList[groupID].ChannelParams.Class;
     if( ( devClass == CLASS_A ) || ( devClass > CLASS_C ) )
     {
@@ -4551,6 +4890,9 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t* mlmeRequest )
                 return LORAMAC_STATUS_BUSY;
             }
 
+            SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 |
+                               LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 );
+
             if( mlmeRequest->Req.Join.NetworkActivation == ACTIVATION_TYPE_OTAA )
             {
                 ResetMacParameters( );
@@ -4619,6 +4961,7 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t* mlmeRequest )
 
                 // LoRaMac will send this command piggy-pack
                 LoRaMacClassBSetPingSlotInfo( mlmeRequest->Req.PingSlotInfo.PingSlot.Fields.Periodicity );
+                SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_CLASS_B );
                 macCmdPayload[0] = value;
                 status = LORAMAC_STATUS_OK;
                 if( LoRaMacCommandsAddCmd( MOTE_MAC_PING_SLOT_INFO_REQ, macCmdPayload, 1 ) != LORAMAC_COMMANDS_SUCCESS )
@@ -4783,6 +5126,7 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest )
             if( RegionVerify( Nvm.MacGroup2.Region, &verify, PHY_TX_DR ) == true )
             {
                 Nvm.MacGroup1.ChannelsDatarate = verify.DatarateParams.Datarate;
+                SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 );
             }
             else
             {
@@ -4817,6 +5161,7 @@ void LoRaMacTestSetDutyCycleOn( bool enable )
     if( RegionVerify( Nvm.MacGroup2.Region, &verify, PHY_DUTY_CYCLE ) == true )
     {
         Nvm.MacGroup2.DutyCycleOn = enable;
+        SetNvmGroupsDirty( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 );
     }
 }
 
@@ -460,6 +460,10 @@ typedef enum eLoRaMacEventInfoStatus
      * ToDo
      */
     LORAMAC_EVENT_INFO_STATUS_BEACON_NOT_FOUND,
+    /*!
+     * The listen before talk found all the channels busy
+     */
+    LORAMAC_EVENT_INFO_STATUS_CHANNEL_BUSY,
 }LoRaMacEventInfoStatus_t;
 
 /*!
@@ -1370,6 +1374,7 @@ typedef struct sMlmeIndication
  * \ref MIB_ABP_LORAWAN_VERSION                  | NO  | YES
  * \ref MIB_LORAWAN_VERSION                      | YES | NO
  * \ref MIB_IS_CERT_FPORT_ON                     | YES | YES
+ * \ref MIB_RXC_SNIFF                            | YES | YES
  *
  * The following table provides links to the function implementations of the
  * related MIB primitives:
@@ -1782,6 +1787,13 @@ typedef enum eMib
       * LoRaWAN certification FPort handling state (ON/OFF)
       */
      MIB_IS_CERT_FPORT_ON,
+     /*!
+      * Class C reception in radio duty cycle (ON/OFF)
+      *
+      * The radio sleeps between listen periods just long enough to detect
+      * the RXC preamble. Applies from the next opening of the RXC window.
+      */
+     MIB_RXC_SNIFF,
 }Mib_t;
 
 /*!
@@ -2210,6 +2222,12 @@ typedef union uMibParam
      * Related MIB type: \ref MIB_IS_CERT_FPORT_ON
      */
     bool IsCertPortOn;
+    /*!
+     * Class C reception in radio duty cycle (ON/OFF)
+     *
+     * Related MIB type: \ref MIB_RXC_SNIFF
+     */
+    bool RxCSniff;
 }MibParam_t;
 
 /*!
@@ -2457,6 +2475,24 @@ static const uint8_t LoRaMacMaxEirpTable[] = { 8, 10, 12, 13, 14, 16, 18, 20, 21
  */
 LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacCallback_t* callbacks, LoRaMacRegion_t region );
 
+/*!
+ * \brief   Selects the end device context used by all the following LoRaMAC
+ *          calls, including the radio and timer events
+ *
+ * \remark  Each context must be initialized with \ref LoRaMacInitialization
+ *          once selected. Only context 0 exists unless LORAMAC_CONTEXTS is
+ *          greater than 1. The radio driver, the RTC alarm and the region
+ *          variables outside of the NVM data are shared by all the contexts,
+ *          see LORAMAC_CONTEXTS.
+ *
+ * \param   [IN] id - Context identifier
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_PARAMETER_INVALID.
+ */
+LoRaMacStatus_t LoRaMacContextSelect( uint16_t id );
+
 /*!
  * \brief   Starts LoRaMAC layer
  *
@@ -94,12 +94,26 @@ typedef union uLoRaMacClassBEvents
     }Events;
 }LoRaMacClassBEvents_t;
 
+#if( LORAMAC_CONTEXTS > 1 )
+/*
+ * Module contexts and events, ContextId selects the ones in use.
+ */
+static LoRaMacClassBEvents_t LoRaMacClassBEventsList[LORAMAC_CONTEXTS];
+
+static LoRaMacClassBCtx_t CtxList[LORAMAC_CONTEXTS];
+
+static uint16_t ContextId = 0;
+
+#define LoRaMacClassBEvents                         LoRaMacClassBEventsList[ContextId]
+#define Ctx                                         CtxList[ContextId]
+#else
 LoRaMacClassBEvents_t LoRaMacClassBEvents = { .Value = 0 };
 
 /*
  * Module context.
  */
 static LoRaMacClassBCtx_t Ctx;
+#endif
 
 /*
  * Beacon transmit time precision in milliseconds.
@@ -113,7 +127,13 @@ static const uint8_t BeaconPrecTimeValue[4] = { 0, 1, 1, 1 };
  * Data structure which holds the parameters which needs to be stored
  * in the NVM.
  */
+#if( LORAMAC_CONTEXTS > 1 )
+static LoRaMacClassBNvmData_t* ClassBNvmList[LORAMAC_CONTEXTS];
+
+#define ClassBNvm                                   ClassBNvmList[ContextId]
+#else
 static LoRaMacClassBNvmData_t* ClassBNvm;
+#endif
 
 /*!
  * Computes the Ping Offset
@@ -372,6 +392,17 @@ static bool CalcNextSlotTime( uint16_t slotOffset, uint16_t pingPeriod, uint16_t
     return false;
 }
 
+#if( CRC_IMPLEMENTATION != CRC_BITWISE )
+/*!
+ * CCITT CRC of each nibble value
+ */
+static const uint16_t BeaconCrcNibbleTable[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+#endif
+
 /*!
  * \brief Calculates CRC's of the beacon frame
  *
@@ -382,8 +413,6 @@ static bool CalcNextSlotTime( uint16_t slotOffset, uint16_t pingPeriod, uint16_t
  */
 static uint16_t BeaconCrc( uint8_t *buffer, uint16_t length )
 {
-    // The CRC calculation follows CCITT
-    const uint16_t polynom = 0x1021;
     // CRC initial value
     uint16_t crc = 0x0000;
 
@@ -392,6 +421,16 @@ static uint16_t BeaconCrc( uint8_t *buffer, uint16_t length )
         return 0;
     }
 
+#if( CRC_IMPLEMENTATION != CRC_BITWISE )
+    for( uint16_t i = 0; i < length; ++i )
+    {
+        crc = ( crc << 4 ) ^ BeaconCrcNibbleTable[( crc >> 12 ) ^ ( buffer[i] >> 4 )];
+        crc = ( crc << 4 ) ^ BeaconCrcNibbleTable[( crc >> 12 ) ^ ( buffer[i] & 0x0F )];
+    }
+#else
+    // The CRC calculation follows CCITT
+    const uint16_t polynom = 0x1021;
+
     for( uint16_t i = 0; i < length; ++i )
     {
         crc ^= ( uint16_t ) buffer[i] << 8;
@@ -400,6 +439,7 @@ static uint16_t BeaconCrc( uint8_t *buffer, uint16_t length )
             crc = ( crc & 0x8000 ) ? ( crc << 1 ) ^ polynom : ( crc << 1 );
         }
     }
+#endif
 
     return crc;
 }
@@ -633,6 +673,15 @@ void LoRaMacClassBInit( LoRaMacClassBParams_t *classBParams, LoRaMacClassBCallba
 #endif // LORAMAC_CLASSB_ENABLED
 }
 
+#if( LORAMAC_CONTEXTS > 1 )
+void LoRaMacClassBContextSelect( uint16_t id )
+{
+#ifdef LORAMAC_CLASSB_ENABLED
+    ContextId = id;
+#endif // LORAMAC_CLASSB_ENABLED
+}
+#endif
+
 void LoRaMacClassBSetBeaconState( BeaconState_t beaconState )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
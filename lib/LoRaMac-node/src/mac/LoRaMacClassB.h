@@ -306,6 +306,15 @@ typedef void ( *LoRaMacClassBNvmEvent )( void );
 void LoRaMacClassBInit( LoRaMacClassBParams_t *classBParams, LoRaMacClassBCallback_t *callbacks,
                         LoRaMacClassBNvmData_t* nvm );
 
+#if( LORAMAC_CONTEXTS > 1 )
+/*!
+ * \brief Selects the module context used by the following calls
+ *
+ * \param [IN] id Context identifier
+ */
+void LoRaMacClassBContextSelect( uint16_t id );
+#endif
+
 /*!
  * \brief Set the state of the beacon state machine
  *
@@ -69,10 +69,21 @@ typedef struct sLoRaMacCommandsCtx
     size_t SerializedCmdsSize;
 } LoRaMacCommandsCtx_t;
 
+#if( LORAMAC_CONTEXTS > 1 )
+/*!
+ * Module contexts, ContextId selects the one in use.
+ */
+static LoRaMacCommandsCtx_t CommandsCtxList[LORAMAC_CONTEXTS];
+
+static uint16_t ContextId = 0;
+
+#define CommandsCtx                                 CommandsCtxList[ContextId]
+#else
 /*!
  * Non-volatile module context.
  */
 static LoRaMacCommandsCtx_t CommandsCtx;
+#endif
 
 /* Memory management functions */
 
@@ -296,6 +307,13 @@ LoRaMacCommandStatus_t LoRaMacCommandsInit( void )
     return LORAMAC_COMMANDS_SUCCESS;
 }
 
+#if( LORAMAC_CONTEXTS > 1 )
+void LoRaMacCommandsContextSelect( uint16_t id )
+{
+    ContextId = id;
+}
+#endif
+
 LoRaMacCommandStatus_t LoRaMacCommandsAddCmd( uint8_t cid, uint8_t* payload, size_t payloadSize )
 {
     if( payload == NULL )
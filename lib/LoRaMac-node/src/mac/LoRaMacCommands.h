@@ -123,6 +123,15 @@ typedef void ( *LoRaMacCommandsNvmEvent )( void );
  */
 LoRaMacCommandStatus_t LoRaMacCommandsInit( void );
 
+#if( LORAMAC_CONTEXTS > 1 )
+/*!
+ * \brief Selects the module context used by the following calls
+ *
+ * \param[IN]    id - Context identifier
+ */
+void LoRaMacCommandsContextSelect( uint16_t id );
+#endif
+
 /*!
  * \brief Adds a new MAC command to be sent.
  *
@@ -69,10 +69,21 @@ typedef struct sLoRaMacConfirmQueueCtx
     LoRaMacConfirmQueueNvmData_t Nvm;
 } LoRaMacConfirmQueueCtx_t;
 
+#if( LORAMAC_CONTEXTS > 1 )
+/*
+ * Module contexts, ContextId selects the one in use.
+ */
+static LoRaMacConfirmQueueCtx_t ConfirmQueueCtxList[LORAMAC_CONTEXTS];
+
+static uint16_t ContextId = 0;
+
+#define ConfirmQueueCtx                             ConfirmQueueCtxList[ContextId]
+#else
 /*
  * Module context.
  */
 static LoRaMacConfirmQueueCtx_t ConfirmQueueCtx;
+#endif
 
 static MlmeConfirmQueue_t* IncreaseBufferPointer( MlmeConfirmQueue_t* bufferPointer )
 {
@@ -160,6 +171,13 @@ void LoRaMacConfirmQueueInit( LoRaMacPrimitives_t* primitives )
     ConfirmQueueCtx.Nvm.CommonStatus = LORAMAC_EVENT_INFO_STATUS_ERROR;
 }
 
+#if( LORAMAC_CONTEXTS > 1 )
+void LoRaMacConfirmQueueContextSelect( uint16_t id )
+{
+    ContextId = id;
+}
+#endif
+
 bool LoRaMacConfirmQueueAdd( MlmeConfirmQueue_t* mlmeConfirm )
 {
     if( IsListFull( ConfirmQueueCtx.Nvm.MlmeConfirmQueueCnt ) == true )
@@ -85,6 +85,15 @@ typedef struct sMlmeConfirmQueue
  */
 void LoRaMacConfirmQueueInit( LoRaMacPrimitives_t* primitive );
 
+#if( LORAMAC_CONTEXTS > 1 )
+/*!
+ * \brief   Selects the module context used by the following calls
+ *
+ * \param   [IN] id - Context identifier
+ */
+void LoRaMacConfirmQueueContextSelect( uint16_t id );
+#endif
+
 /*!
  * \brief   Adds an element to the confirm queue.
  *
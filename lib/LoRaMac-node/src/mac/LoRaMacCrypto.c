@@ -94,6 +94,19 @@ typedef struct sKeyAddr
     KeyIdentifier_t RootKey;
 }KeyAddr_t;
 
+#if( LORAMAC_CONTEXTS > 1 )
+#if( USE_LRWAN_1_1_X_CRYPTO == 1 )
+static uint16_t RJcount0List[LORAMAC_CONTEXTS];
+
+#define RJcount0                                    RJcount0List[ContextId]
+#endif
+
+static LoRaMacCryptoNvmData_t* CryptoNvmList[LORAMAC_CONTEXTS];
+
+static uint16_t ContextId = 0;
+
+#define CryptoNvm                                   CryptoNvmList[ContextId]
+#else
 #if( USE_LRWAN_1_1_X_CRYPTO == 1 )
 /*
  * RJcount0 is a counter incremented with every Type 0 or 2 Rejoin frame transmitted.
@@ -105,6 +118,7 @@ static uint16_t RJcount0;
  * Non volatile module context.
  */
 static LoRaMacCryptoNvmData_t* CryptoNvm;
+#endif
 
 /*
  * Key-Address list
@@ -834,6 +848,13 @@ LoRaMacCryptoStatus_t LoRaMacCryptoInit( LoRaMacCryptoNvmData_t* nvm )
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
+#if( LORAMAC_CONTEXTS > 1 )
+void LoRaMacCryptoContextSelect( uint16_t id )
+{
+    ContextId = id;
+}
+#endif
+
 LoRaMacCryptoStatus_t LoRaMacCryptoSetLrWanVersion( Version_t version )
 {
     CryptoNvm->LrWanVersion = version;
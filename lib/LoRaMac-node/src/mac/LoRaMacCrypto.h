@@ -171,6 +171,15 @@ typedef void ( *LoRaMacCryptoNvmEvent )( void );
  */
 LoRaMacCryptoStatus_t LoRaMacCryptoInit( LoRaMacCryptoNvmData_t* nvm );
 
+#if( LORAMAC_CONTEXTS > 1 )
+/*!
+ * Selects the module context used by the following calls
+ *
+ * \param[IN]     id                 - Context identifier
+ */
+void LoRaMacCryptoContextSelect( uint16_t id );
+#endif
+
 /*!
  * Sets the LoRaWAN specification version to be used.
  *
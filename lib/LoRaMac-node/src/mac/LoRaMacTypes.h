@@ -60,6 +60,24 @@ extern "C"
  */
 #define LORAMAC_MAX_MC_CTX                          4
 
+/*!
+ * Number of end device contexts. When greater than 1 the MAC state is held
+ * per context and \ref LoRaMacContextSelect selects the one used by the
+ * following calls.
+ *
+ * \remark Only the MAC layer is per context: LoRaMac, commands, confirm
+ *         queue, class B, crypto, secure element and the region NVM data.
+ *         The radio driver, the other region module variables (e.g. the
+ *         listen before talk statistics) and the RTC alarm are shared, the
+ *         alarm following the selected timer list only. The caller has to
+ *         poll every list with \ref TimerGetNextExpiry, to fire the expired
+ *         ones with their context selected and to serialize the radio use,
+ *         as test/lorawan/contexts-test.c does.
+ */
+#ifndef LORAMAC_CONTEXTS
+#define LORAMAC_CONTEXTS                            1
+#endif
+
 /*!
  * Region       | SF
  * ------------ | :-----:
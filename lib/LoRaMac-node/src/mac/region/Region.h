@@ -338,7 +338,12 @@ typedef enum eInitType
      * Activates the default channels. Leaves all other active channels
      * active.
      */
-    INIT_TYPE_ACTIVATE_DEFAULT_CHANNELS
+    INIT_TYPE_ACTIVATE_DEFAULT_CHANNELS,
+    /*!
+     * Only assigns the non-volatile data of the region. Used to switch
+     * between LoRaMac contexts.
+     */
+    INIT_TYPE_SELECT_NVM
 }InitType_t;
 
 typedef enum eChannelsMask
@@ -798,6 +803,17 @@ typedef struct sNextChanParams
      * Payload length of the next frame
      */
     uint16_t PktLen;
+    /*!
+     * Set to true, if the carrier sense started by the previous call found
+     * the channel busy. The region selects another channel.
+     */
+    bool CarrierSenseBusy;
+    /*!
+     * Set by the region to true, if it started a carrier sense on the
+     * selected channel. The frame may only be sent once the radio reports
+     * the channel free.
+     */
+    bool CarrierSensePending;
 }NextChanParams_t;
 
 /*!
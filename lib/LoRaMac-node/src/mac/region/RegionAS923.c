@@ -126,11 +126,11 @@ static TimerTime_t GetTimeOnAir( int8_t datarate, uint16_t pktLen )
 
     if( datarate == DR_7 )
     { // High Speed FSK channel
-        timeOnAir = Radio.TimeOnAir( MODEM_FSK, bandwidth, phyDr * 1000, 0, 5, false, pktLen, true );
+        timeOnAir = Radio.TimeOnAirCached( MODEM_FSK, bandwidth, phyDr * 1000, 0, 5, false, pktLen, true );
     }
     else
     {
-        timeOnAir = Radio.TimeOnAir( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
+        timeOnAir = Radio.TimeOnAirCached( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
     }
     return timeOnAir;
 }
@@ -410,6 +410,17 @@ void RegionAS923InitDefaults( InitDefaultsParams_t* params )
             RegionNvmGroup2->ChannelsMask[0] |= RegionNvmGroup2->ChannelsDefaultMask[0];
             break;
         }
+        case INIT_TYPE_SELECT_NVM:
+        {
+            if( ( params->NvmGroup1 == NULL ) || ( params->NvmGroup2 == NULL ) )
+            {
+                return;
+            }
+
+            RegionNvmGroup1 = (RegionNvmDataGroup1_t*) params->NvmGroup1;
+            RegionNvmGroup2 = (RegionNvmDataGroup2_t*) params->NvmGroup2;
+            break;
+        }
         default:
         {
             break;
@@ -908,25 +919,21 @@ LoRaMacStatus_t RegionAS923NextChannel( NextChanParams_t* nextChanParams, uint8_
     {
 #if ( REGION_AS923_DEFAULT_CHANNEL_PLAN == CHANNEL_PLAN_GROUP_AS923_1_JP )
         // Executes the LBT algorithm when operating in Japan
-        uint8_t channelNext = 0;
-
-        for( uint8_t  i = 0, j = randr( 0, nbEnabledChannels - 1 ); i < AS923_MAX_NB_CHANNELS; i++ )
-        {
-            channelNext = enabledChannels[j];
-            j = ( j + 1 ) % nbEnabledChannels;
-
-            // Perform carrier sense for AS923_CARRIER_SENSE_TIME
-            // If the channel is free, we can stop the LBT mechanism
-            if( Radio.IsChannelFree( RegionNvmGroup2->Channels[channelNext].Frequency, AS923_LBT_RX_BANDWIDTH, AS923_RSSI_FREE_TH, AS923_CARRIER_SENSE_TIME ) == true )
-            {
-                // Free channel found
-                *channel = channelNext;
-                return LORAMAC_STATUS_OK;
-            }
-        }
-        // Even if one or more channels are available according to the channel plan, no free channel
-        // was found during the LBT procedure.
-        status = LORAMAC_STATUS_NO_FREE_CHANNEL_FOUND;
+        RegionCommonLbtParams_t lbtParams;
+
+        lbtParams.EnabledChannels = enabledChannels;
+        lbtParams.NbEnabledChannels = nbEnabledChannels;
+        lbtParams.MaxNbSenses = AS923_MAX_NB_CHANNELS;
+        lbtParams.Channels = RegionNvmGroup2->Channels;
+        lbtParams.RxBandwidth = AS923_LBT_RX_BANDWIDTH;
+        lbtParams.RssiFreeThreshold = AS923_RSSI_FREE_TH;
+        lbtParams.CarrierSenseTime = AS923_CARRIER_SENSE_TIME;
+        lbtParams.CarrierSenseBusy = nextChanParams->CarrierSenseBusy;
+
+        // Perform carrier sense for AS923_CARRIER_SENSE_TIME until a free channel is found. Even if
+        // one or more channels are available according to the channel plan, the LBT procedure may
+        // find none free.
+        status = RegionCommonLbtNextChannel( &lbtParams, &nextChanParams->CarrierSensePending, channel );
 #else
         // We found a valid channel
         *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
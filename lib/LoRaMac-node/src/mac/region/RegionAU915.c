@@ -75,7 +75,7 @@ static TimerTime_t GetTimeOnAir( int8_t datarate, uint16_t pktLen )
     int8_t phyDr = DataratesAU915[datarate];
     uint32_t bandwidth = RegionCommonGetBandwidth( datarate, BandwidthsAU915 );
 
-    return Radio.TimeOnAir( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
+    return Radio.TimeOnAirCached( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
 }
 
 PhyParam_t RegionAU915GetPhyParam( GetPhyParams_t* getPhy )
@@ -389,6 +389,17 @@ void RegionAU915InitDefaults( InitDefaultsParams_t* params )
             }
             break;
         }
+        case INIT_TYPE_SELECT_NVM:
+        {
+            if( ( params->NvmGroup1 == NULL ) || ( params->NvmGroup2 == NULL ) )
+            {
+                return;
+            }
+
+            RegionNvmGroup1 = (RegionNvmDataGroup1_t*) params->NvmGroup1;
+            RegionNvmGroup2 = (RegionNvmDataGroup2_t*) params->NvmGroup2;
+            break;
+        }
         default:
         {
             break;
@@ -287,7 +287,7 @@ static TimerTime_t GetTimeOnAir( int8_t datarate, uint16_t pktLen )
     int8_t phyDr = DataratesCN470[datarate];
     uint32_t bandwidth = RegionCommonGetBandwidth( datarate, BandwidthsCN470 );
 
-    return Radio.TimeOnAir( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
+    return Radio.TimeOnAirCached( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
 }
 
 PhyParam_t RegionCN470GetPhyParam( GetPhyParams_t* getPhy )
@@ -602,6 +602,23 @@ void RegionCN470InitDefaults( InitDefaultsParams_t* params )
             }
             break;
         }
+        case INIT_TYPE_SELECT_NVM:
+        {
+            if( ( params->NvmGroup1 == NULL ) || ( params->NvmGroup2 == NULL ) )
+            {
+                return;
+            }
+
+            RegionNvmGroup1 = (RegionNvmDataGroup1_t*) params->NvmGroup1;
+            RegionNvmGroup2 = (RegionNvmDataGroup2_t*) params->NvmGroup2;
+
+            // Restore the channel plan of the context
+            if( RegionNvmGroup2->ChannelPlan != CHANNEL_PLAN_UNKNOWN )
+            {
+                ApplyChannelPlanConfig( RegionNvmGroup2->ChannelPlan, &ChannelPlanCtx );
+            }
+            break;
+        }
         default:
         {
             break;
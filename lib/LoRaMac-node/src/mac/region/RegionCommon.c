@@ -72,6 +72,35 @@
         ( ( N ) / ( D ) )                                                      \
     )
 
+/*!
+ * Value of the channel index meaning no channel
+ */
+#define LBT_NO_CHANNEL                      0xFF
+
+/*!
+ * Listen before talk statistics of the channels
+ */
+static RegionCommonLbtChannelStats_t LbtChannelStats[REGION_NVM_MAX_NB_CHANNELS];
+
+/*!
+ * Listen before talk state of the frame being sent
+ */
+static struct
+{
+    /*!
+     * Channels found busy since the channels were all tried
+     */
+    uint16_t BusyChannels[REGION_NVM_CHANNELS_MASK_SIZE];
+    /*!
+     * Number of carrier senses performed
+     */
+    uint8_t NbSenses;
+    /*!
+     * Channel of the carrier sense started last
+     */
+    uint8_t Channel;
+}LbtState;
+
 static uint16_t GetDutyCycle( Band_t* band, bool joined, SysTime_t elapsedTimeSinceStartup )
 {
     uint16_t dutyCycle = band->DCycle;
@@ -676,3 +705,107 @@ uint32_t RegionCommonGetBandwidth( uint32_t drIndex, const uint32_t* bandwidths
             return 2;
     }
 }
+
+static void LbtSetChannelBusy( uint8_t channel )
+{
+    LbtChannelStats[channel].NbBusy++;
+    LbtChannelStats[channel].LastBusyTime = TimerGetCurrentTime( );
+
+    LbtState.BusyChannels[channel / 16] |= ( 1 << ( channel % 16 ) );
+}
+
+static uint8_t LbtSelectChannel( RegionCommonLbtParams_t* lbtParams )
+{
+    uint8_t channelNext = 0;
+    uint8_t selected = LBT_NO_CHANNEL;
+    TimerTime_t idleTime = 0;
+    TimerTime_t selectedIdleTime = 0;
+
+    for( uint8_t i = 0, j = randr( 0, lbtParams->NbEnabledChannels - 1 ); i < lbtParams->NbEnabledChannels; i++ )
+    {
+        channelNext = lbtParams->EnabledChannels[j];
+        j = ( j + 1 ) % lbtParams->NbEnabledChannels;
+
+        if( ( LbtState.BusyChannels[channelNext / 16] & ( 1 << ( channelNext % 16 ) ) ) != 0 )
+        {
+            continue;
+        }
+        if( LbtChannelStats[channelNext].NbBusy == 0 )
+        {
+            return channelNext;
+        }
+
+        idleTime = TimerGetElapsedTime( LbtChannelStats[channelNext].LastBusyTime );
+        if( idleTime >= REGION_COMMON_LBT_BUSY_HOLDOFF )
+        {
+            return channelNext;
+        }
+
+        // All channels found busy recently, the one busy the longest time ago is tried first
+        if( ( selected == LBT_NO_CHANNEL ) || ( idleTime > selectedIdleTime ) )
+        {
+            selected = channelNext;
+            selectedIdleTime = idleTime;
+        }
+    }
+    return selected;
+}
+
+LoRaMacStatus_t RegionCommonLbtNextChannel( RegionCommonLbtParams_t* lbtParams, bool* carrierSensePending, uint8_t* channel )
+{
+    uint8_t channelNext = 0;
+
+    if( lbtParams->CarrierSenseBusy == true )
+    {
+        LbtSetChannelBusy( LbtState.Channel );
+    }
+    else
+    {
+        // First carrier sense for this frame
+        memset1( ( uint8_t* )&LbtState, 0, sizeof( LbtState ) );
+    }
+    *carrierSensePending = false;
+
+    while( LbtState.NbSenses < lbtParams->MaxNbSenses )
+    {
+        channelNext = LbtSelectChannel( lbtParams );
+        if( channelNext == LBT_NO_CHANNEL )
+        {
+            // All channels were found busy, try them again
+            memset1( ( uint8_t* )LbtState.BusyChannels, 0, sizeof( LbtState.BusyChannels ) );
+            continue;
+        }
+
+        LbtState.NbSenses++;
+        LbtChannelStats[channelNext].NbSenses++;
+
+        if( Radio.StartChannelSense != NULL )
+        {
+            // The MAC gets the result from the radio events
+            LbtState.Channel = channelNext;
+            Radio.StartChannelSense( lbtParams->Channels[channelNext].Frequency, lbtParams->RxBandwidth,
+                                     lbtParams->RssiFreeThreshold, lbtParams->CarrierSenseTime );
+            *carrierSensePending = true;
+            *channel = channelNext;
+            return LORAMAC_STATUS_OK;
+        }
+
+        if( Radio.IsChannelFree( lbtParams->Channels[channelNext].Frequency, lbtParams->RxBandwidth,
+                                 lbtParams->RssiFreeThreshold, lbtParams->CarrierSenseTime ) == true )
+        {
+            *channel = channelNext;
+            return LORAMAC_STATUS_OK;
+        }
+        LbtSetChannelBusy( channelNext );
+    }
+    return LORAMAC_STATUS_NO_FREE_CHANNEL_FOUND;
+}
+
+const RegionCommonLbtChannelStats_t* RegionCommonLbtGetChannelStats( uint8_t channel )
+{
+    if( channel >= REGION_NVM_MAX_NB_CHANNELS )
+    {
+        return NULL;
+    }
+    return &LbtChannelStats[channel];
+}
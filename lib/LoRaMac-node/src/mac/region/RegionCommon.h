@@ -116,6 +116,12 @@ extern "C"
  */
 #define REGION_COMMON_CLASS_B_C_RESP_TIMEOUT            8000
 
+/*!
+ * Time in milli seconds during which a channel found busy by the listen
+ * before talk is only sensed again once the other channels were found busy.
+ */
+#define REGION_COMMON_LBT_BUSY_HOLDOFF                  2000
+
 
 typedef struct sRegionCommonLinkAdrParams
 {
@@ -337,6 +343,63 @@ typedef struct sRegionCommonGetNextLowerTxDrParams
     ChannelParams_t* Channels;
 }RegionCommonGetNextLowerTxDrParams_t;
 
+/*!
+ * Listen before talk statistics of a channel
+ */
+typedef struct sRegionCommonLbtChannelStats
+{
+    /*!
+     * Number of carrier senses performed on the channel.
+     */
+    uint32_t NbSenses;
+    /*!
+     * Number of carrier senses which found the channel busy.
+     */
+    uint32_t NbBusy;
+    /*!
+     * Time of the last carrier sense which found the channel busy.
+     */
+    TimerTime_t LastBusyTime;
+}RegionCommonLbtChannelStats_t;
+
+typedef struct sRegionCommonLbtParams
+{
+    /*!
+     * Pointer to the channels available, as identified by
+     * RegionCommonIdentifyChannels.
+     */
+    uint8_t* EnabledChannels;
+    /*!
+     * Number of channels available.
+     */
+    uint8_t NbEnabledChannels;
+    /*!
+     * Maximum number of carrier senses for one frame.
+     */
+    uint8_t MaxNbSenses;
+    /*!
+     * A pointer to the channels.
+     */
+    ChannelParams_t* Channels;
+    /*!
+     * Reception bandwidth of the carrier sense.
+     */
+    uint32_t RxBandwidth;
+    /*!
+     * RSSI threshold above which the channel is busy.
+     */
+    int16_t RssiFreeThreshold;
+    /*!
+     * Duration of the carrier sense.
+     */
+    uint32_t CarrierSenseTime;
+    /*!
+     * Set to true, if the carrier sense started by the previous call found
+     * the channel busy.
+     */
+    bool CarrierSenseBusy;
+}RegionCommonLbtParams_t;
+
 /*!
  * \brief Verifies, if a value is in a given range.
  *        This is a generic function and valid for all regions.
@@ -616,6 +679,35 @@ int8_t RegionCommonLimitTxPower( int8_t txPower, int8_t maxBandTxPower );
  */
 uint32_t RegionCommonGetBandwidth( uint32_t drIndex, const uint32_t* bandwidths );
 
+/*!
+ * \brief Selects the channel of the next uplink with the listen before talk.
+ *
+ * \details Channels are tried from a random one on, the channels found busy
+ *          recently being tried last. If the radio supports it, the carrier
+ *          sense is started without waiting for its result, which the MAC
+ *          reports through CarrierSenseBusy at the next call.
+ *
+ * \param [IN] lbtParams A pointer to the input parameters.
+ *
+ * \param [OUT] carrierSensePending Set to true, if the carrier sense of the
+ *                                  selected channel is in progress.
+ *
+ * \param [OUT] channel Selected channel.
+ *
+ * \retval Status of the operation. LORAMAC_STATUS_NO_FREE_CHANNEL_FOUND once
+ *         MaxNbSenses carrier senses found the channels busy.
+ */
+LoRaMacStatus_t RegionCommonLbtNextChannel( RegionCommonLbtParams_t* lbtParams, bool* carrierSensePending, uint8_t* channel );
+
+/*!
+ * \brief Gets the listen before talk statistics of a channel.
+ *
+ * \param [IN] channel Channel index.
+ *
+ * \retval A pointer to the statistics, NULL if the index is out of range.
+ */
+const RegionCommonLbtChannelStats_t* RegionCommonLbtGetChannelStats( uint8_t channel );
+
 /*! \} defgroup REGIONCOMMON */
 
 #ifdef __cplusplus
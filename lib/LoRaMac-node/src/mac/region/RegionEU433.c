@@ -65,11 +65,11 @@ static TimerTime_t GetTimeOnAir( int8_t datarate, uint16_t pktLen )
 
     if( datarate == DR_7 )
     { // High Speed FSK channel
-        timeOnAir = Radio.TimeOnAir( MODEM_FSK, bandwidth, phyDr * 1000, 0, 5, false, pktLen, true );
+        timeOnAir = Radio.TimeOnAirCached( MODEM_FSK, bandwidth, phyDr * 1000, 0, 5, false, pktLen, true );
     }
     else
     {
-        timeOnAir = Radio.TimeOnAir( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
+        timeOnAir = Radio.TimeOnAirCached( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
     }
     return timeOnAir;
 }
@@ -326,6 +326,17 @@ void RegionEU433InitDefaults( InitDefaultsParams_t* params )
             RegionNvmGroup2->ChannelsMask[0] |= RegionNvmGroup2->ChannelsDefaultMask[0];
             break;
         }
+        case INIT_TYPE_SELECT_NVM:
+        {
+            if( ( params->NvmGroup1 == NULL ) || ( params->NvmGroup2 == NULL ) )
+            {
+                return;
+            }
+
+            RegionNvmGroup1 = (RegionNvmDataGroup1_t*) params->NvmGroup1;
+            RegionNvmGroup2 = (RegionNvmDataGroup2_t*) params->NvmGroup2;
+            break;
+        }
         default:
         {
             break;
@@ -87,7 +87,7 @@ static TimerTime_t GetTimeOnAir( int8_t datarate, uint16_t pktLen )
     int8_t phyDr = DataratesKR920[datarate];
     uint32_t bandwidth = RegionCommonGetBandwidth( datarate, BandwidthsKR920 );
 
-    return Radio.TimeOnAir( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
+    return Radio.TimeOnAirCached( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
 }
 
 PhyParam_t RegionKR920GetPhyParam( GetPhyParams_t* getPhy )
@@ -346,6 +346,17 @@ void RegionKR920InitDefaults( InitDefaultsParams_t* params )
             RegionNvmGroup2->ChannelsMask[0] |= RegionNvmGroup2->ChannelsDefaultMask[0];
             break;
         }
+        case INIT_TYPE_SELECT_NVM:
+        {
+            if( ( params->NvmGroup1 == NULL ) || ( params->NvmGroup2 == NULL ) )
+            {
+                return;
+            }
+
+            RegionNvmGroup1 = (RegionNvmDataGroup1_t*) params->NvmGroup1;
+            RegionNvmGroup2 = (RegionNvmDataGroup2_t*) params->NvmGroup2;
+            break;
+        }
         default:
         {
             break;
@@ -765,7 +776,6 @@ int8_t RegionKR920AlternateDr( int8_t currentDr, AlternateDrType_t type )
 
 LoRaMacStatus_t RegionKR920NextChannel( NextChanParams_t* nextChanParams, uint8_t* channel, TimerTime_t* time, TimerTime_t* aggregatedTimeOff )
 {
-    uint8_t channelNext = 0;
     uint8_t nbEnabledChannels = 0;
     uint8_t nbRestrictedChannels = 0;
     uint8_t enabledChannels[KR920_MAX_NB_CHANNELS] = { 0 };
@@ -804,23 +814,21 @@ LoRaMacStatus_t RegionKR920NextChannel( NextChanParams_t* nextChanParams, uint8_
 
     if( status == LORAMAC_STATUS_OK )
     {
-        for( uint8_t  i = 0, j = randr( 0, nbEnabledChannels - 1 ); i < KR920_MAX_NB_CHANNELS; i++ )
-        {
-            channelNext = enabledChannels[j];
-            j = ( j + 1 ) % nbEnabledChannels;
-
-            // Perform carrier sense for KR920_CARRIER_SENSE_TIME
-            // If the channel is free, we can stop the LBT mechanism
-            if( Radio.IsChannelFree( RegionNvmGroup2->Channels[channelNext].Frequency, KR920_LBT_RX_BANDWIDTH, KR920_RSSI_FREE_TH, KR920_CARRIER_SENSE_TIME ) == true )
-            {
-                // Free channel found
-                *channel = channelNext;
-                return LORAMAC_STATUS_OK;
-            }
-        }
-        // Even if one or more channels are available according to the channel plan, no free channel
-        // was found during the LBT procedure.
-        status = LORAMAC_STATUS_NO_FREE_CHANNEL_FOUND;
+        RegionCommonLbtParams_t lbtParams;
+
+        lbtParams.EnabledChannels = enabledChannels;
+        lbtParams.NbEnabledChannels = nbEnabledChannels;
+        lbtParams.MaxNbSenses = KR920_MAX_NB_CHANNELS;
+        lbtParams.Channels = RegionNvmGroup2->Channels;
+        lbtParams.RxBandwidth = KR920_LBT_RX_BANDWIDTH;
+        lbtParams.RssiFreeThreshold = KR920_RSSI_FREE_TH;
+        lbtParams.CarrierSenseTime = KR920_CARRIER_SENSE_TIME;
+        lbtParams.CarrierSenseBusy = nextChanParams->CarrierSenseBusy;
+
+        // Perform carrier sense for KR920_CARRIER_SENSE_TIME until a free channel is found. Even if
+        // one or more channels are available according to the channel plan, the LBT procedure may
+        // find none free.
+        status = RegionCommonLbtNextChannel( &lbtParams, &nextChanParams->CarrierSensePending, channel );
     }
     else if( status == LORAMAC_STATUS_NO_CHANNEL_FOUND )
     {
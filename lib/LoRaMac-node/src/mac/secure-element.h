@@ -95,6 +95,15 @@ typedef enum eSecureElementStatus
  */
 SecureElementStatus_t SecureElementInit( SecureElementNvmData_t* nvm );
 
+#if( LORAMAC_CONTEXTS > 1 )
+/*!
+ * Selects the secure element context used by the following calls
+ *
+ * \param[IN]  id                - Context identifier
+ */
+void SecureElementContextSelect( uint16_t id );
+#endif
+
 /*!
  * Sets a key
  *
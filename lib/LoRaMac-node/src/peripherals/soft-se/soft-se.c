@@ -37,7 +37,15 @@
 #include "se-identity.h"
 #include "soft-se-hal.h"
 #include "stdio.h"
+#if( LORAMAC_CONTEXTS > 1 )
+static SecureElementNvmData_t* SeNvmList[LORAMAC_CONTEXTS];
+
+static uint16_t ContextId = 0;
+
+#define SeNvm                                       SeNvmList[ContextId]
+#else
 static SecureElementNvmData_t* SeNvm;
+#endif
 
 /*
  * Local functions
@@ -162,6 +170,13 @@ SecureElementStatus_t SecureElementInit( SecureElementNvmData_t* nvm )
     return SECURE_ELEMENT_SUCCESS;
 }
 
+#if( LORAMAC_CONTEXTS > 1 )
+void SecureElementContextSelect( uint16_t id )
+{
+    ContextId = id;
+}
+#endif
+
 SecureElementStatus_t SecureElementSetKey( KeyIdentifier_t keyID, uint8_t* key )
 {
     if( key == NULL )
@@ -106,8 +106,36 @@ typedef struct
      * \brief  Gnss Done Done callback prototype.
     */
     void    ( *WifiDone )( void );
+
+    /*!
+     * \brief Channel Sense Done callback prototype.
+     *
+     * \param [IN] channelFree  [true: Channel is free, false: Channel is not free]
+     */
+    void ( *ChannelSenseDone )( bool channelFree );
 }RadioEvents_t;
 
+/*!
+ * \brief Latency from a radio IRQ to its callback [us]
+ */
+typedef struct RadioIrqLatency_s
+{
+    uint32_t Count;
+    uint32_t Min;
+    uint32_t Avg;
+    uint32_t Max;
+    uint64_t Total;
+}RadioIrqLatency_t;
+
+/*!
+ * \brief Radio IRQ latencies, per callback
+ */
+typedef struct RadioIrqLatencyStats_s
+{
+    RadioIrqLatency_t TxDone;
+    RadioIrqLatency_t RxDone;
+}RadioIrqLatencyStats_t;
+
 /*!
  * \brief Radio driver definition
  */
@@ -400,6 +428,69 @@ struct Radio_s
      * \param [in]  sleepTime     Structure describing sleep timeout value
      */
     void ( *SetRxDutyCycle ) ( uint32_t rxTime, uint32_t sleepTime );
+    /*!
+     * \brief Checks if a radio irq is waiting to be handled by IrqProcess
+     *
+     * \remark Available on radios using IrqProcess only.
+     *
+     * \retval pending true if IrqProcess has work to do
+     */
+    bool ( *IsIrqPending )( void );
+    /*!
+     * \brief Gets the time of the last radio irq, captured on IRQ entry
+     *
+     * \remark Available on radios using IrqProcess only.
+     *
+     * \retval time Time of the last radio irq [ms]
+     */
+    uint32_t ( *GetIrqTime )( void );
+    /*!
+     * \brief Gets the packet time on air in ms, computed once per
+     *        configuration and payload length
+     *
+     * \remark Same parameters and result as \ref TimeOnAir, to be used on
+     *         the MAC paths which compute it for every uplink.
+     *
+     * \retval airTime        Computed airTime (ms) for the given packet payload length
+     */
+    uint32_t ( *TimeOnAirCached )( RadioModems_t modem, uint32_t bandwidth,
+                                   uint32_t datarate, uint8_t coderate,
+                                   uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
+                                   bool crcOn );
+    /*!
+     * \brief Sets the radio in reception duty cycle, listening just long
+     *        enough to detect the preamble configured by SetRxConfig
+     *
+     * \remark Falls back to continuous reception for FSK and when the
+     *         preamble is too short to sleep between two listen periods.
+     *         Available on SX126x only.
+     */
+    void ( *RxSniff )( void );
+    /*!
+     * \brief Starts checking if the channel is free for the given time,
+     *        without blocking
+     *
+     * \remark The result is reported by the ChannelSenseDone event, the RSSI
+     *         being sampled by IrqProcess. Each IrqProcess call samples it
+     *         back to back for at most a millisecond, the next call follows
+     *         right away until the carrier sense time is covered.
+     *         Available on SX126x only.
+     *
+     * \param [IN] freq                Channel RF frequency in Hertz
+     * \param [IN] rxBandwidth         Rx bandwidth in Hertz
+     * \param [IN] rssiThresh          RSSI threshold in dBm
+     * \param [IN] maxCarrierSenseTime Max time in milliseconds while the RSSI is measured
+     */
+    void ( *StartChannelSense )( uint32_t freq, uint32_t rxBandwidth, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
+    /*!
+     * \brief Gets the latency from the DIO1 edges to the TxDone and RxDone
+     *        callbacks
+     *
+     * \remark Available on SX126x only.
+     *
+     * \retval stats Statistics collected since startup
+     */
+    const RadioIrqLatencyStats_t* ( *GetIrqLatencyStats )( void );
 };
 
 /*!
@@ -25,9 +25,11 @@
 #include "utilities.h"
 #include "timer.h"
 #include "delay.h"
+#include "entropy.h"
 #include "radio.h"
 #include "sx126x.h"
 #include "sx126x-board.h"
+#include "rtc-board.h"
 #include "board.h"
 
 /*!
@@ -72,6 +74,19 @@ void RadioSetChannel( uint32_t freq );
  */
 bool RadioIsChannelFree( uint32_t freq, uint32_t rxBandwidth, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
 
+/*!
+ * \brief Starts checking if the channel is free for the given time, without
+ *        blocking. The result is reported by the ChannelSenseDone event.
+ *
+ * \remark The FSK modem is always used for this task as we can select the Rx bandwidth at will.
+ *
+ * \param [IN] freq                Channel RF frequency in Hertz
+ * \param [IN] rxBandwidth         Rx bandwidth in Hertz
+ * \param [IN] rssiThresh          RSSI threshold in dBm
+ * \param [IN] maxCarrierSenseTime Max time in milliseconds while the RSSI is measured
+ */
+void RadioStartChannelSense( uint32_t freq, uint32_t rxBandwidth, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
+
 /*!
  * \brief Generates a 32 bits random value based on the RSSI readings
  *
@@ -211,6 +226,29 @@ uint32_t RadioTimeOnAir( RadioModems_t modem, uint32_t bandwidth,
                               uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
                               bool crcOn );
 
+/*!
+ * \brief Gets the packet time on air in ms from the time on air cache
+ *
+ * \remark Returns the same value as \ref RadioTimeOnAir. The time on air of
+ *         every payload length is computed once per configuration and cached
+ *         for the RADIO_TIME_ON_AIR_CACHE_SIZE last used configurations.
+ *
+ * \param [IN] modem        Radio modem to be used [0: FSK, 1: LoRa]
+ * \param [IN] bandwidth    Sets the bandwidth
+ * \param [IN] datarate     Sets the Datarate
+ * \param [IN] coderate     Sets the coding rate (LoRa only)
+ * \param [IN] preambleLen  Sets the Preamble length
+ * \param [IN] fixLen       Fixed length packets [0: variable, 1: fixed]
+ * \param [IN] payloadLen   Sets payload length when fixed length is used
+ * \param [IN] crcOn        Enables/Disables the CRC [0: OFF, 1: ON]
+ *
+ * \retval airTime        Computed airTime (ms) for the given packet payload length
+ */
+uint32_t RadioTimeOnAirCached( RadioModems_t modem, uint32_t bandwidth,
+                              uint32_t datarate, uint8_t coderate,
+                              uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
+                              bool crcOn );
+
 /*!
  * \brief Sends the buffer of size. Prepares the packet to be sent and sets
  *        the radio in transmission
@@ -336,6 +374,37 @@ void RadioRxBoosted( uint32_t timeout );
  */
 void RadioSetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime );
 
+/*!
+ * \brief Sets the radio in reception duty cycle, listening just long enough
+ *        to detect the LoRa preamble configured by RadioSetRxConfig
+ *
+ * \remark Falls back to continuous reception for FSK and when the preamble is
+ *         too short to sleep between two listen periods.
+ */
+void RadioRxSniff( void );
+
+/*!
+ * \brief Checks if a radio irq is waiting to be handled by RadioIrqProcess
+ *
+ * \retval pending true if RadioIrqProcess has work to do
+ */
+bool RadioIsIrqPending( void );
+
+/*!
+ * \brief Gets the time of the last DIO1 irq, captured on IRQ entry
+ *
+ * \retval time Time of the last radio irq [ms]
+ */
+uint32_t RadioGetIrqTime( void );
+
+/*!
+ * \brief Gets the latency from the DIO1 edges to the TxDone and RxDone
+ *        callbacks
+ *
+ * \retval stats Statistics collected since startup
+ */
+const RadioIrqLatencyStats_t* RadioGetIrqLatencyStats( void );
+
 /*!
  * Radio driver structure initialization
  */
@@ -368,7 +437,13 @@ const struct Radio_s Radio =
     RadioIrqProcess,
     // Available on SX126x only
     RadioRxBoosted,
-    RadioSetRxDutyCycle
+    RadioSetRxDutyCycle,
+    RadioIsIrqPending,
+    RadioGetIrqTime,
+    RadioTimeOnAirCached,
+    RadioRxSniff,
+    RadioStartChannelSense,
+    RadioGetIrqLatencyStats
 };
 
 /*
@@ -418,6 +493,17 @@ const RadioLoRaBandwidths_t Bandwidths[] = { LORA_BW_125, LORA_BW_250, LORA_BW_5
 
 uint8_t MaxPayloadLength = 0xFF;
 
+/*!
+ * Entropy credited to a random number read while the LNA is enabled, the
+ * received signal makes it less random than with SX126xGetRandom
+ */
+#define RADIO_ENTROPY_BITS                          4
+
+/*!
+ * Generator register value read by the last refill
+ */
+static uint32_t RadioEntropyLastSample = 0;
+
 uint32_t TxTimeout = 0;
 uint32_t RxTimeout = 0;
 
@@ -426,8 +512,112 @@ bool RxContinuous = false;
 
 PacketStatus_t RadioPktStatus;
 uint8_t RadioRxPayload[255];
+uint8_t RadioRxPayloadSize = 0;
+
+volatile bool IrqFired = false;
+
+/*!
+ * Time of the DIO1 edge being handled, latched by RadioOnDioIrq [RTC ticks]
+ */
+static volatile TimerTick_t RadioIrqTimestamp = 0;
+
+static RadioIrqLatencyStats_t RadioIrqLatencyStats;
+
+/*!
+ * Time given to the receiver to settle before the first carrier sense sample [ms]
+ */
+#ifndef RADIO_CHANNEL_SENSE_SETTLE_TIME
+#define RADIO_CHANNEL_SENSE_SETTLE_TIME             1
+#endif
+
+/*!
+ * Longest run of back to back carrier sense RSSI samples taken by one
+ * IrqProcess call [ms]. The carrier sense timer is restarted right away in
+ * between, IrqProcess returns to the main loop without leaving a gap in the
+ * sampling. With 0 the RSSI is sampled back to back over the whole carrier
+ * sense time, IrqProcess only returns once it is done.
+ */
+#ifndef RADIO_CHANNEL_SENSE_BURST_TIME
+#define RADIO_CHANNEL_SENSE_BURST_TIME              1
+#endif
+
+/*!
+ * Carrier sense started by RadioStartChannelSense
+ */
+typedef struct
+{
+    bool Running;
+    bool Sampling;
+    int16_t RssiThresh;
+    uint32_t MaxCarrierSenseTime;
+    /*!
+     * Time of the first RSSI sample
+     */
+    TimerTime_t StartTime;
+}RadioChannelSense_t;
+
+static RadioChannelSense_t RadioChannelSense;
+
+/*!
+ * Set by the carrier sense timer, the RSSI is sampled by RadioIrqProcess
+ */
+static volatile bool ChannelSenseFired = false;
+
+/*!
+ * Set once the received payload is in RadioRxPayload, RxDone is signalled by
+ * RadioIrqProcess
+ */
+static volatile bool RxPayloadReadFired = false;
+
+/*!
+ * Preamble symbols the LoRa modem needs to report a preamble in reception
+ * duty cycle
+ */
+#ifndef RADIO_SNIFF_DETECT_SYMBOLS
+#define RADIO_SNIFF_DETECT_SYMBOLS                  2
+#endif
+
+/*!
+ * Symbols added to each listen period of the reception duty cycle to absorb
+ * the timing errors
+ */
+#ifndef RADIO_SNIFF_MARGIN_SYMBOLS
+#define RADIO_SNIFF_MARGIN_SYMBOLS                  1
+#endif
+
+/*!
+ * Number of configurations kept by the time on air cache
+ */
+#ifndef RADIO_TIME_ON_AIR_CACHE_SIZE
+#define RADIO_TIME_ON_AIR_CACHE_SIZE                4
+#endif
+
+/*!
+ * Time on air of every payload length for a given configuration
+ */
+typedef struct
+{
+    RadioModems_t Modem;
+    uint32_t Bandwidth;
+    uint32_t Datarate;
+    uint8_t CodeRate;
+    uint16_t PreambleLen;
+    bool FixLen;
+    bool CrcOn;
+    bool Valid;
+    /*!
+     * Time on air [ms] indexed by payload length, 0 when not computed yet.
+     * Times which do not fit are not cached.
+     */
+    uint16_t TimeOnAir[256];
+}RadioTimeOnAirCache_t;
 
-bool IrqFired = false;
+static RadioTimeOnAirCache_t RadioTimeOnAirCache[RADIO_TIME_ON_AIR_CACHE_SIZE];
+
+/*!
+ * Next cache entry to be replaced
+ */
+static uint8_t RadioTimeOnAirCacheNext = 0;
 
 /*
  * SX126x DIO IRQ callback functions prototype
@@ -448,6 +638,11 @@ void RadioOnTxTimeoutIrq( void* context );
  */
 void RadioOnRxTimeoutIrq( void* context );
 
+/*!
+ * \brief Carrier sense timer callback
+ */
+void RadioOnChannelSenseIrq( void* context );
+
 /*
  * Private global variables
  */
@@ -464,6 +659,21 @@ typedef struct
 
 static RadioPublicNetwork_t RadioPublicNetwork = { false };
 
+/*!
+ * Holds the configuration last sent to the radio, the configuration functions
+ * only send the parameters which differ from it
+ */
+typedef struct
+{
+    bool Valid;
+    uint32_t Generation;                            //!< Generation of the SX126x command shadows it was sent in
+    bool FskSyncWord;                               //!< FSK sync word and whitening seed were written
+    ModulationParams_t ModulationParams;
+    PacketParams_t PacketParams;
+}RadioAppliedConfig_t;
+
+static RadioAppliedConfig_t RadioAppliedConfig = { false };
+
 /*!
  * Radio callbacks variable
  */
@@ -484,6 +694,11 @@ SX126x_t SX126x;
 TimerEvent_t TxTimeoutTimer;
 TimerEvent_t RxTimeoutTimer;
 
+/*!
+ * Carrier sense sampling timer
+ */
+TimerEvent_t ChannelSenseTimer;
+
 /*!
  * Returns the known FSK bandwidth registers value
  *
@@ -510,6 +725,97 @@ static uint8_t RadioGetFskBandwidthRegValue( uint32_t bandwidth )
     while( 1 );
 }
 
+/*!
+ * \brief Checks if the radio still holds the configuration last applied
+ *
+ * \retval valid true when the applied configuration can be used for a diff
+ */
+static bool RadioIsAppliedConfigValid( void )
+{
+    return ( RadioAppliedConfig.Valid == true ) &&
+           ( RadioAppliedConfig.Generation == SX126xGetShadowGeneration( ) );
+}
+
+/*!
+ * \brief Sends the packet parameters when they differ from the applied ones
+ */
+static void RadioApplyPacketParams( void )
+{
+    if( ( RadioIsAppliedConfigValid( ) == true ) &&
+        ( memcmp( &RadioAppliedConfig.PacketParams, &SX126x.PacketParams, sizeof( PacketParams_t ) ) == 0 ) )
+    {
+        // Opcode and parameters
+        SX126xShadowAddSaved( ( SX126x.PacketParams.PacketType == PACKET_TYPE_LORA ) ? 1 + 6 : 1 + 9 );
+        return;
+    }
+    SX126xSetPacketParams( &SX126x.PacketParams );
+    memcpy( &RadioAppliedConfig.PacketParams, &SX126x.PacketParams, sizeof( PacketParams_t ) );
+}
+
+/*!
+ * \brief Puts the radio in standby and sends the modem, modulation and packet
+ *        parameters held by SX126x which differ from the applied ones
+ *
+ * \param [IN] packetParams Send the packet parameters, false when the caller
+ *                          sends them later anyway
+ */
+static void RadioApplyConfig( bool packetParams )
+{
+    bool valid = RadioIsAppliedConfigValid( );
+
+    // The configuration commands are only accepted in standby
+    if( SX126xGetOperatingMode( ) != MODE_STDBY_RC )
+    {
+        RadioStandby( );
+    }
+    else
+    {
+        SX126xShadowAddSaved( 1 + 1 );
+    }
+
+    if( ( valid == false ) || ( RadioAppliedConfig.ModulationParams.PacketType != SX126x.ModulationParams.PacketType ) )
+    {
+        RadioSetModem( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK ) ? MODEM_FSK : MODEM_LORA );
+        // Switching the packet type invalidates the parameters held by the radio
+        valid = ( valid == true ) && ( RadioAppliedConfig.Generation == SX126xGetShadowGeneration( ) );
+    }
+
+    if( ( valid == true ) &&
+        ( memcmp( &RadioAppliedConfig.ModulationParams, &SX126x.ModulationParams, sizeof( ModulationParams_t ) ) == 0 ) )
+    {
+        SX126xShadowAddSaved( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_LORA ) ? 1 + 4 : 1 + 8 );
+    }
+    else
+    {
+        SX126xSetModulationParams( &SX126x.ModulationParams );
+    }
+
+    if( valid == false )
+    {
+        RadioAppliedConfig.FskSyncWord = false;
+        RadioAppliedConfig.Generation = SX126xGetShadowGeneration( );
+        RadioAppliedConfig.Valid = true;
+        // Forces the packet parameters to be sent
+        memset( &RadioAppliedConfig.PacketParams, 0xFF, sizeof( PacketParams_t ) );
+    }
+    memcpy( &RadioAppliedConfig.ModulationParams, &SX126x.ModulationParams, sizeof( ModulationParams_t ) );
+
+    if( packetParams == true )
+    {
+        RadioApplyPacketParams( );
+    }
+
+    if( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK )
+    {
+        if( RadioAppliedConfig.FskSyncWord == false )
+        {
+            SX126xSetSyncWord( ( uint8_t[] ){ 0xC1, 0x94, 0xC1, 0x00, 0x00, 0x00, 0x00, 0x00 } );
+            SX126xSetWhiteningSeed( 0x01FF );
+            RadioAppliedConfig.FskSyncWord = true;
+        }
+    }
+}
+
 void RadioInit( RadioEvents_t *events )
 {
     RadioEvents = events;
@@ -525,8 +831,12 @@ void RadioInit( RadioEvents_t *events )
     // Initialize driver timeout timers
     TimerInit( &TxTimeoutTimer, RadioOnTxTimeoutIrq );
     TimerInit( &RxTimeoutTimer, RadioOnRxTimeoutIrq );
+    TimerInit( &ChannelSenseTimer, RadioOnChannelSenseIrq );
 
     IrqFired = false;
+    ChannelSenseFired = false;
+    RxPayloadReadFired = false;
+    RadioChannelSense.Running = false;
 }
 
 RadioState_t RadioGetStatus( void )
@@ -536,6 +846,7 @@ RadioState_t RadioGetStatus( void )
         case MODE_TX:
             return RF_TX_RUNNING;
         case MODE_RX:
+        case MODE_RX_DC:
             return RF_RX_RUNNING;
         case MODE_CAD:
             return RF_CAD;
@@ -606,10 +917,106 @@ bool RadioIsChannelFree( uint32_t freq, uint32_t rxBandwidth, int16_t rssiThresh
     return status;
 }
 
+/*!
+ * \brief Stops the carrier sense in progress, without reporting it
+ */
+static void RadioChannelSenseStop( void )
+{
+    TimerStop( &ChannelSenseTimer );
+
+    CRITICAL_SECTION_BEGIN( );
+    ChannelSenseFired = false;
+    CRITICAL_SECTION_END( );
+
+    RadioChannelSense.Running = false;
+}
+
+void RadioStartChannelSense( uint32_t freq, uint32_t rxBandwidth, int16_t rssiThresh, uint32_t maxCarrierSenseTime )
+{
+    RadioChannelSenseStop( );
+
+    RadioSetModem( MODEM_FSK );
+
+    RadioSetChannel( freq );
+
+    // Set Rx bandwidth. Other parameters are not used.
+    RadioSetRxConfig( MODEM_FSK, rxBandwidth, 600, 0, rxBandwidth, 3, 0, false,
+                      0, false, 0, 0, false, true );
+    RadioRx( 0 );
+
+    // Only the RSSI is used, the frames received meanwhile are not reported
+    SX126xSetDioIrqParams( IRQ_RADIO_NONE, IRQ_RADIO_NONE, IRQ_RADIO_NONE, IRQ_RADIO_NONE );
+
+    RadioChannelSense.RssiThresh = rssiThresh;
+    RadioChannelSense.MaxCarrierSenseTime = maxCarrierSenseTime;
+    RadioChannelSense.Sampling = false;
+    RadioChannelSense.Running = true;
+
+    TimerSetValue( &ChannelSenseTimer, RADIO_CHANNEL_SENSE_SETTLE_TIME );
+    TimerStart( &ChannelSenseTimer );
+}
+
+/*!
+ * \brief Takes the carrier sense RSSI samples and reports the result once the
+ *        channel is found busy or the carrier sense time elapsed
+ */
+static void RadioChannelSenseProcess( void )
+{
+    bool isFree = true;
+    bool elapsed = false;
+    TimerTick_t burstStart = RtcGetTimerValue( );
+
+    if( RadioChannelSense.Running == false )
+    {
+        return;
+    }
+
+    if( RadioChannelSense.Sampling == false )
+    {
+        RadioChannelSense.StartTime = TimerGetCurrentTime( );
+        RadioChannelSense.Sampling = true;
+    }
+
+    do
+    {
+        if( RadioRssi( MODEM_FSK ) > RadioChannelSense.RssiThresh )
+        {
+            isFree = false;
+            break;
+        }
+        elapsed = TimerGetElapsedTime( RadioChannelSense.StartTime ) >= RadioChannelSense.MaxCarrierSenseTime;
+    }while( ( elapsed == false ) &&
+            ( ( RADIO_CHANNEL_SENSE_BURST_TIME == 0 ) ||
+              ( ( RtcGetTimerValue( ) - burstStart ) < RtcMs2Tick( RADIO_CHANNEL_SENSE_BURST_TIME ) ) ) );
+
+    if( ( isFree == true ) && ( elapsed == false ) )
+    {
+        // The next burst follows as soon as the main loop gets back to it
+        TimerSetValue( &ChannelSenseTimer, 0 );
+        TimerStart( &ChannelSenseTimer );
+        return;
+    }
+    RadioChannelSense.Running = false;
+
+    // Kept in standby, the transmission or the next carrier sense follows
+    SX126xSetStandby( STDBY_RC );
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->ChannelSenseDone != NULL ) )
+    {
+        RadioEvents->ChannelSenseDone( isFree );
+    }
+}
+
 uint32_t RadioRandom( void )
 {
     uint32_t rnd = 0;
 
+    // Served by the pool when the receptions have refilled it
+    if( EntropyGet( &rnd ) == true )
+    {
+        return rnd;
+    }
+
     /*
      * Radio setup for random number generation
      */
@@ -621,6 +1028,10 @@ uint32_t RadioRandom( void )
 
     rnd = SX126xGetRandom( );
 
+    // The LNA and mixer were disabled, the sample is full entropy
+    EntropyAdd( ENTROPY_SOURCE_RADIO, rnd, 32 );
+    EntropyGet( &rnd );
+
     return rnd;
 }
 
@@ -674,12 +1085,7 @@ void RadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
             }
             SX126x.PacketParams.Params.Gfsk.DcFree = RADIO_DC_FREEWHITENING;
 
-            RadioStandby( );
-            RadioSetModem( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK ) ? MODEM_FSK : MODEM_LORA );
-            SX126xSetModulationParams( &SX126x.ModulationParams );
-            SX126xSetPacketParams( &SX126x.PacketParams );
-            SX126xSetSyncWord( ( uint8_t[] ){ 0xC1, 0x94, 0xC1, 0x00, 0x00, 0x00, 0x00, 0x00 } );
-            SX126xSetWhiteningSeed( 0x01FF );
+            RadioApplyConfig( true );
 
             RxTimeout = ( uint32_t )symbTimeout * 8000UL / datarate;
             break;
@@ -726,22 +1132,19 @@ void RadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
             SX126x.PacketParams.Params.LoRa.CrcMode = ( RadioLoRaCrcModes_t )crcOn;
             SX126x.PacketParams.Params.LoRa.InvertIQ = ( RadioLoRaIQModes_t )iqInverted;
 
-            RadioStandby( );
-            RadioSetModem( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK ) ? MODEM_FSK : MODEM_LORA );
-            SX126xSetModulationParams( &SX126x.ModulationParams );
-            SX126xSetPacketParams( &SX126x.PacketParams );
+            RadioApplyConfig( true );
             SX126xSetLoRaSymbNumTimeout( symbTimeout );
 
             // WORKAROUND - Optimizing the Inverted IQ Operation, see DS_SX1261-2_V1.2 datasheet chapter 15.4
             if( SX126x.PacketParams.Params.LoRa.InvertIQ == LORA_IQ_INVERTED )
             {
                 // RegIqPolaritySetup = @address 0x0736
-                SX126xWriteRegister( 0x0736, SX126xReadRegister( 0x0736 ) & ~( 1 << 2 ) );
+                SX126xWriteRegisterCached( REG_IQ_POLARITY, SX126xReadRegisterCached( REG_IQ_POLARITY ) & ~( 1 << 2 ) );
             }
             else
             {
                 // RegIqPolaritySetup @address 0x0736
-                SX126xWriteRegister( 0x0736, SX126xReadRegister( 0x0736 ) | ( 1 << 2 ) );
+                SX126xWriteRegisterCached( REG_IQ_POLARITY, SX126xReadRegisterCached( REG_IQ_POLARITY ) | ( 1 << 2 ) );
             }
             // WORKAROUND END
 
@@ -786,12 +1189,8 @@ void RadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
             }
             SX126x.PacketParams.Params.Gfsk.DcFree = RADIO_DC_FREEWHITENING;
 
-            RadioStandby( );
-            RadioSetModem( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK ) ? MODEM_FSK : MODEM_LORA );
-            SX126xSetModulationParams( &SX126x.ModulationParams );
-            SX126xSetPacketParams( &SX126x.PacketParams );
-            SX126xSetSyncWord( ( uint8_t[] ){ 0xC1, 0x94, 0xC1, 0x00, 0x00, 0x00, 0x00, 0x00 } );
-            SX126xSetWhiteningSeed( 0x01FF );
+            // The payload length is only known by RadioSend, which sends the packet parameters
+            RadioApplyConfig( false );
             break;
 
         case MODEM_LORA:
@@ -834,10 +1233,8 @@ void RadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
             SX126x.PacketParams.Params.LoRa.CrcMode = ( RadioLoRaCrcModes_t )crcOn;
             SX126x.PacketParams.Params.LoRa.InvertIQ = ( RadioLoRaIQModes_t )iqInverted;
 
-            RadioStandby( );
-            RadioSetModem( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK ) ? MODEM_FSK : MODEM_LORA );
-            SX126xSetModulationParams( &SX126x.ModulationParams );
-            SX126xSetPacketParams( &SX126x.PacketParams );
+            // The payload length is only known by RadioSend, which sends the packet parameters
+            RadioApplyConfig( false );
             break;
     }
 
@@ -845,12 +1242,12 @@ void RadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
     if( ( modem == MODEM_LORA ) && ( SX126x.ModulationParams.Params.LoRa.Bandwidth == LORA_BW_500 ) )
     {
         // RegTxModulation = @address 0x0889
-        SX126xWriteRegister( 0x0889, SX126xReadRegister( 0x0889 ) & ~( 1 << 2 ) );
+        SX126xWriteRegisterCached( REG_TX_MODULATION, SX126xReadRegisterCached( REG_TX_MODULATION ) & ~( 1 << 2 ) );
     }
     else
     {
         // RegTxModulation = @address 0x0889
-        SX126xWriteRegister( 0x0889, SX126xReadRegister( 0x0889 ) | ( 1 << 2 ) );
+        SX126xWriteRegisterCached( REG_TX_MODULATION, SX126xReadRegisterCached( REG_TX_MODULATION ) | ( 1 << 2 ) );
     }
     // WORKAROUND END
 
@@ -1017,6 +1414,59 @@ uint32_t RadioTimeOnAir( RadioModems_t modem, uint32_t bandwidth,
     return ( numerator + denominator - 1 ) / denominator;
 }
 
+uint32_t RadioTimeOnAirCached( RadioModems_t modem, uint32_t bandwidth,
+                              uint32_t datarate, uint8_t coderate,
+                              uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
+                              bool crcOn )
+{
+    RadioTimeOnAirCache_t *cache = NULL;
+    uint32_t timeOnAir = 0;
+
+    for( uint8_t i = 0; i < RADIO_TIME_ON_AIR_CACHE_SIZE; i++ )
+    {
+        if( ( RadioTimeOnAirCache[i].Valid == true ) &&
+            ( RadioTimeOnAirCache[i].Modem == modem ) &&
+            ( RadioTimeOnAirCache[i].Bandwidth == bandwidth ) &&
+            ( RadioTimeOnAirCache[i].Datarate == datarate ) &&
+            ( RadioTimeOnAirCache[i].CodeRate == coderate ) &&
+            ( RadioTimeOnAirCache[i].PreambleLen == preambleLen ) &&
+            ( RadioTimeOnAirCache[i].FixLen == fixLen ) &&
+            ( RadioTimeOnAirCache[i].CrcOn == crcOn ) )
+        {
+            cache = &RadioTimeOnAirCache[i];
+            break;
+        }
+    }
+
+    if( cache == NULL )
+    {
+        // Replace the entries in turn
+        cache = &RadioTimeOnAirCache[RadioTimeOnAirCacheNext];
+        RadioTimeOnAirCacheNext = ( RadioTimeOnAirCacheNext + 1 ) % RADIO_TIME_ON_AIR_CACHE_SIZE;
+
+        memset( cache->TimeOnAir, 0, sizeof( cache->TimeOnAir ) );
+        cache->Modem = modem;
+        cache->Bandwidth = bandwidth;
+        cache->Datarate = datarate;
+        cache->CodeRate = coderate;
+        cache->PreambleLen = preambleLen;
+        cache->FixLen = fixLen;
+        cache->CrcOn = crcOn;
+        cache->Valid = true;
+    }
+
+    timeOnAir = cache->TimeOnAir[payloadLen];
+    if( timeOnAir == 0 )
+    {
+        timeOnAir = RadioTimeOnAir( modem, bandwidth, datarate, coderate, preambleLen, fixLen, payloadLen, crcOn );
+        if( timeOnAir <= UINT16_MAX )
+        {
+            cache->TimeOnAir[payloadLen] = ( uint16_t )timeOnAir;
+        }
+    }
+    return timeOnAir;
+}
+
 void RadioSend( uint8_t *buffer, uint8_t size )
 {
     SX126xSetDioIrqParams( IRQ_TX_DONE | IRQ_RX_TX_TIMEOUT,
@@ -1032,7 +1482,7 @@ void RadioSend( uint8_t *buffer, uint8_t size )
     {
         SX126x.PacketParams.Params.Gfsk.PayloadLength = size;
     }
-    SX126xSetPacketParams( &SX126x.PacketParams );
+    RadioApplyPacketParams( );
 
     SX126xSendPayload( buffer, size, 0 );
     TimerSetValue( &TxTimeoutTimer, TxTimeout );
@@ -1043,6 +1493,8 @@ void RadioSleep( void )
 {
     SleepParams_t params = { 0 };
 
+    RadioChannelSenseStop( );
+
     params.Fields.WarmStart = 1;
     SX126xSetSleep( params );
 
@@ -1051,6 +1503,7 @@ void RadioSleep( void )
 
 void RadioStandby( void )
 {
+    RadioChannelSenseStop( );
     SX126xSetStandby( STDBY_RC );
 }
 
@@ -1105,6 +1558,50 @@ void RadioSetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime )
     SX126xSetRxDutyCycle( rxTime, sleepTime );
 }
 
+void RadioRxSniff( void )
+{
+    uint32_t symbolTime = 0;
+    uint32_t preambleTime = 0;
+    uint32_t guardTime = 0;
+    uint32_t rxTime = 0;
+
+    if( SX126xGetPacketType( ) != PACKET_TYPE_LORA )
+    {
+        RadioRx( 0 );
+        return;
+    }
+
+    // Times in us
+    symbolTime = ( ( 1UL << SX126x.ModulationParams.Params.LoRa.SpreadingFactor ) * 1000000UL ) /
+                 RadioGetLoRaBandwidthInHz( SX126x.ModulationParams.Params.LoRa.Bandwidth );
+    // The hardware adds 4.25 symbols to the preamble
+    preambleTime = ( ( 4 * ( SX126x.PacketParams.Params.LoRa.PreambleLength + 4 ) + 1 ) * symbolTime ) / 4;
+    rxTime = ( RADIO_SNIFF_DETECT_SYMBOLS + RADIO_SNIFF_MARGIN_SYMBOLS ) * symbolTime;
+
+    // A preamble starting just too late to be detected by a listen period
+    // must still hold the detection symbols when the next one starts, after
+    // the sleep and the wake-up of the radio
+    guardTime = ( 2 * RADIO_SNIFF_DETECT_SYMBOLS + RADIO_SNIFF_MARGIN_SYMBOLS ) * symbolTime +
+                SX126xGetBoardTcxoWakeupTime( ) * 1000;
+    if( preambleTime <= guardTime )
+    {
+        RadioRx( 0 );
+        return;
+    }
+
+    SX126xSetDioIrqParams( IRQ_RADIO_ALL, //IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT,
+                           IRQ_RADIO_ALL, //IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT,
+                           IRQ_RADIO_NONE,
+                           IRQ_RADIO_NONE );
+
+    // Keep receiving once a preamble is detected, the header may come later
+    // than the duty cycle timeout
+    SX126xSetStopRxTimerOnPreambleDetect( true );
+
+    // Convert to the SX126x 15.625 us time base, the listen period rounded up
+    SX126xSetRxDutyCycle( ( ( rxTime << 6 ) + 999 ) / 1000, ( ( preambleTime - guardTime ) << 6 ) / 1000 );
+}
+
 void RadioStartCad( void )
 {
     SX126xSetDioIrqParams( IRQ_CAD_DONE | IRQ_CAD_ACTIVITY_DETECTED, IRQ_CAD_DONE | IRQ_CAD_ACTIVITY_DETECTED, IRQ_RADIO_NONE, IRQ_RADIO_NONE );
@@ -1130,17 +1627,18 @@ int16_t RadioRssi( RadioModems_t modem )
 
 void RadioWrite( uint32_t addr, uint8_t data )
 {
-    SX126xWriteRegister( addr, data );
+    SX126xWriteRegisterCached( addr, data );
 }
 
 uint8_t RadioRead( uint32_t addr )
 {
-    return SX126xReadRegister( addr );
+    return SX126xReadRegisterCached( addr );
 }
 
 void RadioWriteBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
 {
     SX126xWriteRegisters( addr, buffer, size );
+    SX126xShadowInvalidateRegisters( addr, size );
 }
 
 void RadioReadBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
@@ -1153,14 +1651,14 @@ void RadioSetMaxPayloadLength( RadioModems_t modem, uint8_t max )
     if( modem == MODEM_LORA )
     {
         SX126x.PacketParams.Params.LoRa.PayloadLength = MaxPayloadLength = max;
-        SX126xSetPacketParams( &SX126x.PacketParams );
+        RadioApplyPacketParams( );
     }
     else
     {
         if( SX126x.PacketParams.Params.Gfsk.HeaderType == RADIO_PACKET_VARIABLE_LENGTH )
         {
             SX126x.PacketParams.Params.Gfsk.PayloadLength = MaxPayloadLength = max;
-            SX126xSetPacketParams( &SX126x.PacketParams );
+            RadioApplyPacketParams( );
         }
     }
 }
@@ -1173,14 +1671,14 @@ void RadioSetPublicNetwork( bool enable )
     if( enable == true )
     {
         // Change LoRa modem SyncWord
-        SX126xWriteRegister( REG_LR_SYNCWORD, ( LORA_MAC_PUBLIC_SYNCWORD >> 8 ) & 0xFF );
-        SX126xWriteRegister( REG_LR_SYNCWORD + 1, LORA_MAC_PUBLIC_SYNCWORD & 0xFF );
+        SX126xWriteRegisterCached( REG_LR_SYNCWORD, ( LORA_MAC_PUBLIC_SYNCWORD >> 8 ) & 0xFF );
+        SX126xWriteRegisterCached( REG_LR_SYNCWORD + 1, LORA_MAC_PUBLIC_SYNCWORD & 0xFF );
     }
     else
     {
         // Change LoRa modem SyncWord
-        SX126xWriteRegister( REG_LR_SYNCWORD, ( LORA_MAC_PRIVATE_SYNCWORD >> 8 ) & 0xFF );
-        SX126xWriteRegister( REG_LR_SYNCWORD + 1, LORA_MAC_PRIVATE_SYNCWORD & 0xFF );
+        SX126xWriteRegisterCached( REG_LR_SYNCWORD, ( LORA_MAC_PRIVATE_SYNCWORD >> 8 ) & 0xFF );
+        SX126xWriteRegisterCached( REG_LR_SYNCWORD + 1, LORA_MAC_PRIVATE_SYNCWORD & 0xFF );
     }
 }
 
@@ -1205,13 +1703,125 @@ void RadioOnRxTimeoutIrq( void* context )
     }
 }
 
+void RadioOnChannelSenseIrq( void* context )
+{
+    ChannelSenseFired = true;
+}
+
+/*!
+ * \brief Accounts for the time elapsed since the DIO1 edge being handled
+ *
+ * \param [IN] latency Statistics of the callback about to be called
+ */
+static void RadioIrqLatencyUpdate( RadioIrqLatency_t* latency )
+{
+    // RTC ticks are microseconds on this platform
+    uint32_t time = ( uint32_t )( RtcGetTimerValue( ) - RadioIrqTimestamp );
+
+    if( ( latency->Count == 0 ) || ( time < latency->Min ) )
+    {
+        latency->Min = time;
+    }
+    if( time > latency->Max )
+    {
+        latency->Max = time;
+    }
+    latency->Total += time;
+    latency->Count++;
+}
+
+/*!
+ * \brief Called once the received packet has been read out of the radio,
+ *        possibly from the DMA interrupt
+ */
+static void RadioOnRxPayloadRead( void )
+{
+    RxPayloadReadFired = true;
+}
+
+/*!
+ * \brief Signals the received packet read by the background transfer
+ */
+static void RadioRxPayloadProcess( void )
+{
+    RadioIrqLatencyUpdate( &RadioIrqLatencyStats.RxDone );
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
+    {
+        RadioEvents->RxDone( RadioRxPayload, RadioRxPayloadSize, RadioPktStatus.Params.LoRa.RssiPkt, RadioPktStatus.Params.LoRa.SnrPkt );
+    }
+}
+
+/*!
+ * \brief Feeds the entropy pool with the random number generated during the
+ *        reception which just ended, without reconfiguring the radio
+ *
+ * \remark Called on an RX timeout only, the receiver then ran for the whole
+ *         window and the generator register, which the radio updates from
+ *         the receiver noise while in RX, holds a value drawn during it. A
+ *         register left unchanged since the last refill is stale and its
+ *         value is not credited.
+ */
+static void RadioEntropyRefill( void )
+{
+    uint32_t sample = 0;
+
+    if( EntropyGetBits( ) < ENTROPY_POOL_BITS )
+    {
+        SX126xReadRegisters( RANDOM_NUMBER_GENERATORBASEADDR, ( uint8_t* )&sample, 4 );
+        if( sample != RadioEntropyLastSample )
+        {
+            RadioEntropyLastSample = sample;
+            EntropyAdd( ENTROPY_SOURCE_RADIO, sample, RADIO_ENTROPY_BITS );
+        }
+    }
+}
+
 void RadioOnDioIrq( void* context )
 {
+    RadioIrqTimestamp = SX126xGetDio1IrqTimestamp( );
     IrqFired = true;
 }
 
+bool RadioIsIrqPending( void )
+{
+    return ( IrqFired == true ) || ( ChannelSenseFired == true ) || ( RxPayloadReadFired == true );
+}
+
+uint32_t RadioGetIrqTime( void )
+{
+    return RtcTick2Ms( RadioIrqTimestamp );
+}
+
+const RadioIrqLatencyStats_t* RadioGetIrqLatencyStats( void )
+{
+    CRITICAL_SECTION_BEGIN( );
+
+    RadioIrqLatency_t* latencies[] = { &RadioIrqLatencyStats.TxDone, &RadioIrqLatencyStats.RxDone };
+
+    for( uint8_t i = 0; i < 2; i++ )
+    {
+        if( latencies[i]->Count != 0 )
+        {
+            latencies[i]->Avg = ( uint32_t )( latencies[i]->Total / latencies[i]->Count );
+        }
+    }
+
+    CRITICAL_SECTION_END( );
+    return &RadioIrqLatencyStats;
+}
+
 void RadioIrqProcess( void )
 {
+    if( ChannelSenseFired == true )
+    {
+        CRITICAL_SECTION_BEGIN( );
+        ChannelSenseFired = false;
+        CRITICAL_SECTION_END( );
+
+        RadioChannelSenseProcess( );
+    }
+
     if( IrqFired == true )
     {
         CRITICAL_SECTION_BEGIN( );
@@ -1219,14 +1829,27 @@ void RadioIrqProcess( void )
         IrqFired = false;
         CRITICAL_SECTION_END( );
 
+        // Latched before the radio is accessed, which may wake it up
+        RadioOperatingModes_t operatingMode = SX126xGetOperatingMode( );
         uint16_t irqRegs = SX126xGetIrqStatus( );
+        bool rxDutyCycle = false;
         SX126xClearIrqStatus( irqRegs );
 
+        // A reception or a timeout ends the reception duty cycle, the radio
+        // is put in standby so that it is restarted from a known state
+        if( ( operatingMode == MODE_RX_DC ) &&
+            ( ( irqRegs & ( IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT | IRQ_HEADER_ERROR ) ) != 0 ) )
+        {
+            rxDutyCycle = true;
+            SX126xSetStandby( STDBY_RC );
+        }
+
         if( ( irqRegs & IRQ_TX_DONE ) == IRQ_TX_DONE )
         {
             TimerStop( &TxTimeoutTimer );
             //!< Update operating mode state to a value lower than \ref MODE_STDBY_XOSC
             SX126xSetOperatingMode( MODE_STDBY_RC );
+            RadioIrqLatencyUpdate( &RadioIrqLatencyStats.TxDone );
             if( ( RadioEvents != NULL ) && ( RadioEvents->TxDone != NULL ) )
             {
                 RadioEvents->TxDone( );
@@ -1249,7 +1872,7 @@ void RadioIrqProcess( void )
             }
             else
             {
-                uint8_t size;
+                uint8_t offset = 0;
 
                 TimerStop( &RxTimeoutTimer );
                 if( RxContinuous == false )
@@ -1258,18 +1881,22 @@ void RadioIrqProcess( void )
                     SX126xSetOperatingMode( MODE_STDBY_RC );
 
                     // WORKAROUND - Implicit Header Mode Timeout Behavior, see DS_SX1261-2_V1.2 datasheet chapter 15.3
-                    // RegRtcControl = @address 0x0902
-                    SX126xWriteRegister( 0x0902, 0x00 );
-                    // RegEventMask = @address 0x0944
-                    SX126xWriteRegister( 0x0944, SX126xReadRegister( 0x0944 ) | ( 1 << 1 ) );
+                    // The RTC is only left running in implicit header mode
+                    if( ( SX126xGetPacketType( ) == PACKET_TYPE_LORA ) &&
+                        ( SX126x.PacketParams.Params.LoRa.HeaderType == LORA_PACKET_IMPLICIT ) )
+                    {
+                        // RegRtcControl = @address 0x0902
+                        SX126xWriteRegister( 0x0902, 0x00 );
+                        // RegEventMask = @address 0x0944
+                        SX126xWriteRegister( 0x0944, SX126xReadRegister( 0x0944 ) | ( 1 << 1 ) );
+                    }
                     // WORKAROUND END
                 }
-                SX126xGetPayload( RadioRxPayload, &size , 255 );
                 SX126xGetPacketStatus( &RadioPktStatus );
-                if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
-                {
-                    RadioEvents->RxDone( RadioRxPayload, size, RadioPktStatus.Params.LoRa.RssiPkt, RadioPktStatus.Params.LoRa.SnrPkt );
-                }
+                SX126xGetRxBufferStatus( &RadioRxPayloadSize, &offset );
+                // RxDone is signalled by RadioIrqProcess once the payload is
+                // in RadioRxPayload
+                SX126xReadBufferAsync( offset, RadioRxPayload, RadioRxPayloadSize, RadioOnRxPayloadRead );
             }
         }
 
@@ -1295,11 +1922,12 @@ void RadioIrqProcess( void )
                     RadioEvents->TxTimeout( );
                 }
             }
-            else if( SX126xGetOperatingMode( ) == MODE_RX )
+            else if( ( SX126xGetOperatingMode( ) == MODE_RX ) || ( rxDutyCycle == true ) )
             {
                 TimerStop( &RxTimeoutTimer );
                 //!< Update operating mode state to a value lower than \ref MODE_STDBY_XOSC
                 SX126xSetOperatingMode( MODE_STDBY_RC );
+                RadioEntropyRefill( );
                 if( ( RadioEvents != NULL ) && ( RadioEvents->RxTimeout != NULL ) )
                 {
                     RadioEvents->RxTimeout( );
@@ -1336,4 +1964,14 @@ void RadioIrqProcess( void )
             }
         }
     }
+
+    // Already set when the payload read above did not use DMA
+    if( RxPayloadReadFired == true )
+    {
+        CRITICAL_SECTION_BEGIN( );
+        RxPayloadReadFired = false;
+        CRITICAL_SECTION_END( );
+
+        RadioRxPayloadProcess( );
+    }
 }
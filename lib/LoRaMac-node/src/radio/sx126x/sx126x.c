@@ -48,6 +48,17 @@
  */
 #define SX126X_MAX_LORA_SYMB_NUM_TIMEOUT            248
 
+/*!
+ * \brief Maximum size of the parameters of a shadowed command
+ */
+#define SX126X_SHADOW_COMMAND_SIZE_MAX              9
+
+/*!
+ * \brief SPI bytes of a register access: opcode, address and, for a read, status
+ */
+#define SX126X_REGISTER_WRITE_HEADER_SIZE           3
+#define SX126X_REGISTER_READ_HEADER_SIZE            4
+
 /*!
  * \brief Radio registers definition
  */
@@ -67,6 +78,12 @@ static RadioPacketTypes_t PacketType;
  */
 static volatile RadioLoRaPacketLengthsMode_t LoRaHeaderType;
 
+/*!
+ * \brief Stores the current LoRa payload length set in the radio, the length
+ *        of the packets received with a fixed length header
+ */
+static uint8_t LoRaPayloadLength;
+
 /*!
  * \brief Stores the last frequency error measured on LoRa received packet
  */
@@ -77,6 +94,77 @@ volatile uint32_t FrequencyError = 0;
  */
 static bool ImageCalibrated = false;
 
+/*!
+ * \brief Shadow of a configuration register
+ */
+typedef struct
+{
+    uint16_t      Addr;                             //!< The address of the register
+    uint8_t       Value;                            //!< The last value written to or read from the register
+    bool          Valid;                            //!< Value matches the radio
+}SX126xRegisterShadow_t;
+
+/*!
+ * \brief Shadow of the last parameters sent with a configuration command
+ */
+typedef struct
+{
+    RadioCommands_t Opcode;                         //!< The command
+    uint16_t      Dependent;                        //!< Register the radio rewrites when executing the command, 0 if none
+    uint8_t       Size;                             //!< Size of the last parameters, 0 when not valid
+    uint8_t       Buffer[SX126X_SHADOW_COMMAND_SIZE_MAX];
+}SX126xCommandShadow_t;
+
+/*!
+ * \brief Registers only changed by the driver
+ */
+static SX126xRegisterShadow_t RegisterShadows[] =
+{
+    { REG_LR_SYNCWORD },
+    { REG_LR_SYNCWORD + 1 },
+    { REG_LR_SYNCH_TIMEOUT },
+    { REG_IQ_POLARITY },
+    { REG_RX_GAIN },
+    { REG_TX_MODULATION },
+    { REG_TX_CLAMP_CFG },
+    { REG_ANA_LNA },
+    { REG_ANA_MIXER },
+};
+
+/*!
+ * \brief Commands whose parameters are kept by the radio until reset or cold
+ *        start, sending them again with the same parameters has no effect
+ */
+static SX126xCommandShadow_t CommandShadows[] =
+{
+    { RADIO_SET_PACKETTYPE, 0 },
+    { RADIO_SET_RFFREQUENCY, 0 },
+    { RADIO_SET_MODULATIONPARAMS, REG_TX_MODULATION },
+    { RADIO_SET_PACKETPARAMS, REG_IQ_POLARITY },
+    { RADIO_SET_TXPARAMS, 0 },
+    { RADIO_SET_PACONFIG, 0 },
+    { RADIO_SET_CADPARAMS, 0 },
+    { RADIO_SET_BUFFERBASEADDRESS, 0 },
+    { RADIO_CFG_DIOIRQ, 0 },
+    { RADIO_SET_STOPRXTIMERONPREAMBLE, 0 },
+    { RADIO_SET_LORASYMBTIMEOUT, REG_LR_SYNCH_TIMEOUT },
+    { RADIO_SET_REGULATORMODE, 0 },
+    { RADIO_SET_TXFALLBACKMODE, 0 },
+    { RADIO_SET_RFSWITCHMODE, 0 },
+};
+
+/*!
+ * \brief SPI traffic saved by the shadows
+ */
+static SX126xShadowStats_t ShadowStats;
+static uint32_t ShadowCycleTransactions = 0;
+static uint32_t ShadowCycleBytes = 0;
+
+/*!
+ * \brief Incremented each time command shadows are invalidated
+ */
+static uint32_t ShadowGeneration = 0;
+
 /*!
  * \brief Get the number of PLL steps for a given frequency in Hertz
  *
@@ -86,6 +174,25 @@ static bool ImageCalibrated = false;
  */
 static uint32_t SX126xConvertFreqInHzToPllStep( uint32_t freqInHz );
 
+/*!
+ * \brief Sends a configuration command unless the radio already holds its
+ *        parameters
+ *
+ * \param [in] opcode Command to send
+ * \param [in] buffer Parameters of the command
+ * \param [in] size   Size of the parameters
+ *
+ * \retval sent true when the command was sent to the radio
+ */
+static bool SX126xWriteCommandCached( RadioCommands_t opcode, uint8_t *buffer, uint16_t size );
+
+/*!
+ * \brief Invalidates the shadow of a command
+ *
+ * \param [in] opcode Command
+ */
+static void SX126xShadowInvalidateCommand( RadioCommands_t opcode );
+
 /*
  * SX126x DIO IRQ callback functions prototype
  */
@@ -113,6 +220,7 @@ void SX126xProcessIrqs( void );
 void SX126xInit( DioIrqHandler dioIrq )
 {
     SX126xReset( );
+    SX126xShadowInvalidate( );
 
     SX126xIoIrqInit( dioIrq );
 
@@ -130,11 +238,19 @@ void SX126xInit( DioIrqHandler dioIrq )
 
 void SX126xCheckDeviceReady( void )
 {
-    if( ( SX126xGetOperatingMode( ) == MODE_SLEEP ) || ( SX126xGetOperatingMode( ) == MODE_RX_DC ) )
+    RadioOperatingModes_t mode = SX126xGetOperatingMode( );
+
+    if( ( mode == MODE_SLEEP ) || ( mode == MODE_RX_DC ) )
     {
         SX126xWakeup( );
         // Switch is turned off when device is in sleep mode and turned on is all other modes
         SX126xAntSwOn( );
+        // The reception duty cycle is only ended by a mode command, the
+        // configuration must not be sent without leaving it first
+        if( mode == MODE_RX_DC )
+        {
+            SX126xSetOperatingMode( MODE_RX_DC );
+        }
     }
     SX126xWaitOnBusy( );
 }
@@ -229,11 +345,11 @@ uint32_t SX126xGetRandom( void )
     uint8_t regAnaLna = 0;
     uint8_t regAnaMixer = 0;
 
-    regAnaLna = SX126xReadRegister( REG_ANA_LNA );
-    SX126xWriteRegister( REG_ANA_LNA, regAnaLna & ~( 1 << 0 ) );
+    regAnaLna = SX126xReadRegisterCached( REG_ANA_LNA );
+    SX126xWriteRegisterCached( REG_ANA_LNA, regAnaLna & ~( 1 << 0 ) );
 
-    regAnaMixer = SX126xReadRegister( REG_ANA_MIXER );
-    SX126xWriteRegister( REG_ANA_MIXER, regAnaMixer & ~( 1 << 7 ) );
+    regAnaMixer = SX126xReadRegisterCached( REG_ANA_MIXER );
+    SX126xWriteRegisterCached( REG_ANA_MIXER, regAnaMixer & ~( 1 << 7 ) );
 
     // Set radio in continuous reception
     SX126xSetRx( 0xFFFFFF ); // Rx Continuous
@@ -242,8 +358,8 @@ uint32_t SX126xGetRandom( void )
 
     SX126xSetStandby( STDBY_RC );
 
-    SX126xWriteRegister( REG_ANA_LNA, regAnaLna );
-    SX126xWriteRegister( REG_ANA_MIXER, regAnaMixer );
+    SX126xWriteRegisterCached( REG_ANA_LNA, regAnaLna );
+    SX126xWriteRegisterCached( REG_ANA_MIXER, regAnaMixer );
 
     return number;
 }
@@ -257,6 +373,15 @@ void SX126xSetSleep( SleepParams_t sleepConfig )
                       ( ( uint8_t )sleepConfig.Fields.WakeUpRTC ) );
     SX126xWriteCommand( RADIO_SET_SLEEP, &value, 1 );
     SX126xSetOperatingMode( MODE_SLEEP );
+
+    if( sleepConfig.Fields.WarmStart == 1 )
+    {
+        SX126xShadowInvalidateRegisters( 0x0000, 0xFFFF );
+    }
+    else
+    {
+        SX126xShadowInvalidate( );
+    }
 }
 
 void SX126xSetStandby( RadioStandbyModes_t standbyConfig )
@@ -284,6 +409,12 @@ void SX126xSetTx( uint32_t timeout )
 
     SX126xSetOperatingMode( MODE_TX );
 
+    // A transmission ends the current uplink/downlink cycle
+    ShadowStats.CycleSavedTransactions = ShadowCycleTransactions;
+    ShadowStats.CycleSavedBytes = ShadowCycleBytes;
+    ShadowCycleTransactions = 0;
+    ShadowCycleBytes = 0;
+
     buf[0] = ( uint8_t )( ( timeout >> 16 ) & 0xFF );
     buf[1] = ( uint8_t )( ( timeout >> 8 ) & 0xFF );
     buf[2] = ( uint8_t )( timeout & 0xFF );
@@ -308,7 +439,7 @@ void SX126xSetRxBoosted( uint32_t timeout )
 
     SX126xSetOperatingMode( MODE_RX );
 
-    SX126xWriteRegister( REG_RX_GAIN, 0x96 ); // max LNA gain, increase current by ~2mA for around ~3dB in sensivity
+    SX126xWriteRegisterCached( REG_RX_GAIN, 0x96 ); // max LNA gain, increase current by ~2mA for around ~3dB in sensivity
 
     buf[0] = ( uint8_t )( ( timeout >> 16 ) & 0xFF );
     buf[1] = ( uint8_t )( ( timeout >> 8 ) & 0xFF );
@@ -350,7 +481,7 @@ void SX126xSetTxInfinitePreamble( void )
 
 void SX126xSetStopRxTimerOnPreambleDetect( bool enable )
 {
-    SX126xWriteCommand( RADIO_SET_STOPRXTIMERONPREAMBLE, ( uint8_t* )&enable, 1 );
+    SX126xWriteCommandCached( RADIO_SET_STOPRXTIMERONPREAMBLE, ( uint8_t* )&enable, 1 );
 }
 
 void SX126xSetLoRaSymbNumTimeout( uint8_t symbNum )
@@ -368,18 +499,18 @@ void SX126xSetLoRaSymbNumTimeout( uint8_t symbNum )
     }
 
     reg = mant << ( 2 * exp + 1 );
-    SX126xWriteCommand( RADIO_SET_LORASYMBTIMEOUT, &reg, 1 );
+    SX126xWriteCommandCached( RADIO_SET_LORASYMBTIMEOUT, &reg, 1 );
 
     if( symbNum != 0 )
     {
         reg = exp + ( mant << 3 );
-        SX126xWriteRegister( REG_LR_SYNCH_TIMEOUT, reg );
+        SX126xWriteRegisterCached( REG_LR_SYNCH_TIMEOUT, reg );
     }
 }
 
 void SX126xSetRegulatorMode( RadioRegulatorMode_t mode )
 {
-    SX126xWriteCommand( RADIO_SET_REGULATORMODE, ( uint8_t* )&mode, 1 );
+    SX126xWriteCommandCached( RADIO_SET_REGULATORMODE, ( uint8_t* )&mode, 1 );
 }
 
 void SX126xCalibrate( CalibrationParams_t calibParam )
@@ -393,6 +524,8 @@ void SX126xCalibrate( CalibrationParams_t calibParam )
                       ( ( uint8_t )calibParam.Fields.RC64KEnable ) );
 
     SX126xWriteCommand( RADIO_CALIBRATE, &value, 1 );
+    // Calibrations update analog registers
+    SX126xShadowInvalidateRegisters( 0x0000, 0xFFFF );
 }
 
 void SX126xCalibrateImage( uint32_t freq )
@@ -425,6 +558,7 @@ void SX126xCalibrateImage( uint32_t freq )
         calFreq[1] = 0x6F;
     }
     SX126xWriteCommand( RADIO_CALIBRATEIMAGE, calFreq, 2 );
+    SX126xShadowInvalidateRegisters( 0x0000, 0xFFFF );
 }
 
 void SX126xSetPaConfig( uint8_t paDutyCycle, uint8_t hpMax, uint8_t deviceSel, uint8_t paLut )
@@ -435,12 +569,12 @@ void SX126xSetPaConfig( uint8_t paDutyCycle, uint8_t hpMax, uint8_t deviceSel, u
     buf[1] = hpMax;
     buf[2] = deviceSel;
     buf[3] = paLut;
-    SX126xWriteCommand( RADIO_SET_PACONFIG, buf, 4 );
+    SX126xWriteCommandCached( RADIO_SET_PACONFIG, buf, 4 );
 }
 
 void SX126xSetRxTxFallbackMode( uint8_t fallbackMode )
 {
-    SX126xWriteCommand( RADIO_SET_TXFALLBACKMODE, &fallbackMode, 1 );
+    SX126xWriteCommandCached( RADIO_SET_TXFALLBACKMODE, &fallbackMode, 1 );
 }
 
 void SX126xSetDioIrqParams( uint16_t irqMask, uint16_t dio1Mask, uint16_t dio2Mask, uint16_t dio3Mask )
@@ -455,7 +589,7 @@ void SX126xSetDioIrqParams( uint16_t irqMask, uint16_t dio1Mask, uint16_t dio2Ma
     buf[5] = ( uint8_t )( dio2Mask & 0x00FF );
     buf[6] = ( uint8_t )( ( dio3Mask >> 8 ) & 0x00FF );
     buf[7] = ( uint8_t )( dio3Mask & 0x00FF );
-    SX126xWriteCommand( RADIO_CFG_DIOIRQ, buf, 8 );
+    SX126xWriteCommandCached( RADIO_CFG_DIOIRQ, buf, 8 );
 }
 
 uint16_t SX126xGetIrqStatus( void )
@@ -468,7 +602,7 @@ uint16_t SX126xGetIrqStatus( void )
 
 void SX126xSetDio2AsRfSwitchCtrl( uint8_t enable )
 {
-    SX126xWriteCommand( RADIO_SET_RFSWITCHMODE, &enable, 1 );
+    SX126xWriteCommandCached( RADIO_SET_RFSWITCHMODE, &enable, 1 );
 }
 
 void SX126xSetDio3AsTcxoCtrl( RadioTcxoCtrlVoltage_t tcxoVoltage, uint32_t timeout )
@@ -499,14 +633,20 @@ void SX126xSetRfFrequency( uint32_t frequency )
     buf[1] = ( uint8_t )( ( freqInPllSteps >> 16 ) & 0xFF );
     buf[2] = ( uint8_t )( ( freqInPllSteps >> 8 ) & 0xFF );
     buf[3] = ( uint8_t )( freqInPllSteps & 0xFF );
-    SX126xWriteCommand( RADIO_SET_RFFREQUENCY, buf, 4 );
+    SX126xWriteCommandCached( RADIO_SET_RFFREQUENCY, buf, 4 );
 }
 
 void SX126xSetPacketType( RadioPacketTypes_t packetType )
 {
     // Save packet type internally to avoid questioning the radio
     PacketType = packetType;
-    SX126xWriteCommand( RADIO_SET_PACKETTYPE, ( uint8_t* )&packetType, 1 );
+    if( SX126xWriteCommandCached( RADIO_SET_PACKETTYPE, ( uint8_t* )&packetType, 1 ) == true )
+    {
+        // Switching the packet type resets the modem registers and parameters
+        SX126xShadowInvalidateRegisters( 0x0000, 0xFFFF );
+        SX126xShadowInvalidateCommand( RADIO_SET_MODULATIONPARAMS );
+        SX126xShadowInvalidateCommand( RADIO_SET_PACKETPARAMS );
+    }
 }
 
 RadioPacketTypes_t SX126xGetPacketType( void )
@@ -541,7 +681,7 @@ void SX126xSetTxParams( int8_t power, RadioRampTimes_t rampTime )
     {
         // WORKAROUND - Better Resistance of the SX1262 Tx to Antenna Mismatch, see DS_SX1261-2_V1.2 datasheet chapter 15.2
         // RegTxClampConfig = @address 0x08D8
-        SX126xWriteRegister( 0x08D8, SX126xReadRegister( 0x08D8 ) | ( 0x0F << 1 ) );
+        SX126xWriteRegisterCached( REG_TX_CLAMP_CFG, SX126xReadRegisterCached( REG_TX_CLAMP_CFG ) | ( 0x0F << 1 ) );
         // WORKAROUND END
 
         SX126xSetPaConfig( 0x04, 0x07, 0x00, 0x01 );
@@ -556,7 +696,7 @@ void SX126xSetTxParams( int8_t power, RadioRampTimes_t rampTime )
     }
     buf[0] = power;
     buf[1] = ( uint8_t )rampTime;
-    SX126xWriteCommand( RADIO_SET_TXPARAMS, buf, 2 );
+    SX126xWriteCommandCached( RADIO_SET_TXPARAMS, buf, 2 );
 }
 
 void SX126xSetModulationParams( ModulationParams_t *modulationParams )
@@ -586,7 +726,7 @@ void SX126xSetModulationParams( ModulationParams_t *modulationParams )
         buf[5] = ( tempVal >> 16 ) & 0xFF;
         buf[6] = ( tempVal >> 8 ) & 0xFF;
         buf[7] = ( tempVal& 0xFF );
-        SX126xWriteCommand( RADIO_SET_MODULATIONPARAMS, buf, n );
+        SX126xWriteCommandCached( RADIO_SET_MODULATIONPARAMS, buf, n );
         break;
     case PACKET_TYPE_LORA:
         n = 4;
@@ -595,7 +735,7 @@ void SX126xSetModulationParams( ModulationParams_t *modulationParams )
         buf[2] = modulationParams->Params.LoRa.CodingRate;
         buf[3] = modulationParams->Params.LoRa.LowDatarateOptimize;
 
-        SX126xWriteCommand( RADIO_SET_MODULATIONPARAMS, buf, n );
+        SX126xWriteCommandCached( RADIO_SET_MODULATIONPARAMS, buf, n );
 
         break;
     default:
@@ -652,7 +792,7 @@ void SX126xSetPacketParams( PacketParams_t *packetParams )
         buf[0] = ( packetParams->Params.LoRa.PreambleLength >> 8 ) & 0xFF;
         buf[1] = packetParams->Params.LoRa.PreambleLength;
         buf[2] = LoRaHeaderType = packetParams->Params.LoRa.HeaderType;
-        buf[3] = packetParams->Params.LoRa.PayloadLength;
+        buf[3] = LoRaPayloadLength = packetParams->Params.LoRa.PayloadLength;
         buf[4] = packetParams->Params.LoRa.CrcMode;
         buf[5] = packetParams->Params.LoRa.InvertIQ;
         break;
@@ -660,7 +800,7 @@ void SX126xSetPacketParams( PacketParams_t *packetParams )
     case PACKET_TYPE_NONE:
         return;
     }
-    SX126xWriteCommand( RADIO_SET_PACKETPARAMS, buf, n );
+    SX126xWriteCommandCached( RADIO_SET_PACKETPARAMS, buf, n );
 }
 
 void SX126xSetCadParams( RadioLoRaCadSymbols_t cadSymbolNum, uint8_t cadDetPeak, uint8_t cadDetMin, RadioCadExitModes_t cadExitMode, uint32_t cadTimeout )
@@ -674,7 +814,7 @@ void SX126xSetCadParams( RadioLoRaCadSymbols_t cadSymbolNum, uint8_t cadDetPeak,
     buf[4] = ( uint8_t )( ( cadTimeout >> 16 ) & 0xFF );
     buf[5] = ( uint8_t )( ( cadTimeout >> 8 ) & 0xFF );
     buf[6] = ( uint8_t )( cadTimeout & 0xFF );
-    SX126xWriteCommand( RADIO_SET_CADPARAMS, buf, 7 );
+    SX126xWriteCommandCached( RADIO_SET_CADPARAMS, buf, 7 );
     SX126xSetOperatingMode( MODE_CAD );
 }
 
@@ -684,7 +824,7 @@ void SX126xSetBufferBaseAddress( uint8_t txBaseAddress, uint8_t rxBaseAddress )
 
     buf[0] = txBaseAddress;
     buf[1] = rxBaseAddress;
-    SX126xWriteCommand( RADIO_SET_BUFFERBASEADDRESS, buf, 2 );
+    SX126xWriteCommandCached( RADIO_SET_BUFFERBASEADDRESS, buf, 2 );
 }
 
 RadioStatus_t SX126xGetStatus( void )
@@ -714,11 +854,11 @@ void SX126xGetRxBufferStatus( uint8_t *payloadLength, uint8_t *rxStartBufferPoin
 
     SX126xReadCommand( RADIO_GET_RXBUFFERSTATUS, status, 2 );
 
-    // In case of LORA fixed header, the payloadLength is obtained by reading
-    // the register REG_LR_PAYLOADLENGTH
+    // In case of LORA fixed header, the payloadLength is the one written to
+    // the register REG_LR_PAYLOADLENGTH by SX126xSetPacketParams
     if( ( SX126xGetPacketType( ) == PACKET_TYPE_LORA ) && ( LoRaHeaderType == LORA_PACKET_FIXED_LENGTH ) )
     {
-        *payloadLength = SX126xReadRegister( REG_LR_PAYLOADLENGTH );
+        *payloadLength = LoRaPayloadLength;
     }
     else
     {
@@ -793,6 +933,148 @@ void SX126xClearIrqStatus( uint16_t irq )
     SX126xWriteCommand( RADIO_CLR_IRQSTATUS, buf, 2 );
 }
 
+void SX126xShadowAddSaved( uint16_t bytes )
+{
+    ShadowStats.SavedTransactions++;
+    ShadowStats.SavedBytes += bytes;
+    ShadowCycleTransactions++;
+    ShadowCycleBytes += bytes;
+}
+
+static SX126xRegisterShadow_t* SX126xGetRegisterShadow( uint16_t address )
+{
+    for( uint8_t i = 0; i < sizeof( RegisterShadows ) / sizeof( RegisterShadows[0] ); i++ )
+    {
+        if( RegisterShadows[i].Addr == address )
+        {
+            return &RegisterShadows[i];
+        }
+    }
+    return NULL;
+}
+
+void SX126xWriteRegisterCached( uint16_t address, uint8_t value )
+{
+    SX126xRegisterShadow_t *shadow = SX126xGetRegisterShadow( address );
+
+    if( shadow == NULL )
+    {
+        SX126xWriteRegister( address, value );
+        return;
+    }
+    if( ( shadow->Valid == true ) && ( shadow->Value == value ) )
+    {
+        SX126xShadowAddSaved( SX126X_REGISTER_WRITE_HEADER_SIZE + 1 );
+        return;
+    }
+    SX126xWriteRegister( address, value );
+    shadow->Value = value;
+    shadow->Valid = true;
+}
+
+uint8_t SX126xReadRegisterCached( uint16_t address )
+{
+    SX126xRegisterShadow_t *shadow = SX126xGetRegisterShadow( address );
+
+    if( shadow == NULL )
+    {
+        return SX126xReadRegister( address );
+    }
+    if( shadow->Valid == true )
+    {
+        SX126xShadowAddSaved( SX126X_REGISTER_READ_HEADER_SIZE + 1 );
+        return shadow->Value;
+    }
+    shadow->Value = SX126xReadRegister( address );
+    shadow->Valid = true;
+    return shadow->Value;
+}
+
+void SX126xShadowInvalidateRegisters( uint16_t address, uint16_t size )
+{
+    for( uint8_t i = 0; i < sizeof( RegisterShadows ) / sizeof( RegisterShadows[0] ); i++ )
+    {
+        if( ( RegisterShadows[i].Addr >= address ) && ( ( uint32_t )( RegisterShadows[i].Addr - address ) < size ) )
+        {
+            RegisterShadows[i].Valid = false;
+        }
+    }
+}
+
+static void SX126xShadowInvalidateCommand( RadioCommands_t opcode )
+{
+    for( uint8_t i = 0; i < sizeof( CommandShadows ) / sizeof( CommandShadows[0] ); i++ )
+    {
+        if( CommandShadows[i].Opcode == opcode )
+        {
+            CommandShadows[i].Size = 0;
+        }
+    }
+    ShadowGeneration++;
+}
+
+void SX126xShadowInvalidate( void )
+{
+    SX126xShadowInvalidateRegisters( 0x0000, 0xFFFF );
+
+    for( uint8_t i = 0; i < sizeof( CommandShadows ) / sizeof( CommandShadows[0] ); i++ )
+    {
+        CommandShadows[i].Size = 0;
+    }
+    ShadowGeneration++;
+}
+
+uint32_t SX126xGetShadowGeneration( void )
+{
+    return ShadowGeneration;
+}
+
+static bool SX126xWriteCommandCached( RadioCommands_t opcode, uint8_t *buffer, uint16_t size )
+{
+    SX126xCommandShadow_t *shadow = NULL;
+
+    for( uint8_t i = 0; i < sizeof( CommandShadows ) / sizeof( CommandShadows[0] ); i++ )
+    {
+        if( CommandShadows[i].Opcode == opcode )
+        {
+            shadow = &CommandShadows[i];
+            break;
+        }
+    }
+
+    if( ( shadow != NULL ) && ( shadow->Size != 0 ) && ( shadow->Size == size ) && ( memcmp( shadow->Buffer, buffer, size ) == 0 ) )
+    {
+        // Opcode and parameters
+        SX126xShadowAddSaved( 1 + size );
+        return false;
+    }
+
+    SX126xWriteCommand( opcode, buffer, size );
+
+    if( shadow != NULL )
+    {
+        if( ( size > 0 ) && ( size <= SX126X_SHADOW_COMMAND_SIZE_MAX ) )
+        {
+            memcpy( shadow->Buffer, buffer, size );
+            shadow->Size = size;
+        }
+        else
+        {
+            shadow->Size = 0;
+        }
+        if( shadow->Dependent != 0 )
+        {
+            SX126xShadowInvalidateRegisters( shadow->Dependent, 1 );
+        }
+    }
+    return true;
+}
+
+const SX126xShadowStats_t* SX126xGetShadowStats( void )
+{
+    return &ShadowStats;
+}
+
 static uint32_t SX126xConvertFreqInHzToPllStep( uint32_t freqInHz )
 {
     uint32_t stepsInt;
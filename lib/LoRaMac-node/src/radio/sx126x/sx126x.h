@@ -151,6 +151,21 @@ extern "C"
  */
 #define REG_OCP                                     0x08E7
 
+/*!
+ * The address of the register holding the IQ polarity setup, see DS_SX1261-2_V1.2 datasheet chapter 15.4
+ */
+#define REG_IQ_POLARITY                             0x0736
+
+/*!
+ * The address of the register holding the TX modulation setup, see DS_SX1261-2_V1.2 datasheet chapter 15.1
+ */
+#define REG_TX_MODULATION                           0x0889
+
+/*!
+ * The address of the register holding the TX clamping setup, see DS_SX1261-2_V1.2 datasheet chapter 15.2
+ */
+#define REG_TX_CLAMP_CFG                            0x08D8
+
 /*!
  * \brief Structure describing the radio status
  */
@@ -687,6 +702,20 @@ typedef struct SX126x_s
     ModulationParams_t ModulationParams;
 }SX126x_t;
 
+/*!
+ * SPI traffic saved by the shadow of the radio registers and commands
+ *
+ * \remark A cycle starts with a transmission and ends with the next one, it
+ *         covers an uplink and its downlink windows.
+ */
+typedef struct SX126xShadowStats_s
+{
+    uint32_t SavedTransactions;                     //!< Transactions saved since startup
+    uint32_t SavedBytes;                            //!< Bytes saved since startup
+    uint32_t CycleSavedTransactions;                //!< Transactions saved during the last cycle
+    uint32_t CycleSavedBytes;                       //!< Bytes saved during the last cycle
+}SX126xShadowStats_t;
+
 /*!
  * Hardware IO IRQ callback function definition
  */
@@ -726,6 +755,8 @@ void SX126xInit( DioIrqHandler dioIrq );
 
 /*!
  * \brief Wakeup the radio if it is in Sleep mode and check that Busy is low
+ *
+ * \remark The operating mode of a running reception duty cycle is kept
  */
 void SX126xCheckDeviceReady( void );
 
@@ -949,6 +980,74 @@ void SX126xWriteRegisters( uint16_t address, uint8_t *buffer, uint16_t size );
  */
 void SX126xReadRegisters( uint16_t address, uint8_t *buffer, uint16_t size );
 
+/*!
+ * \brief Writes a register through its shadow, an unchanged value is not sent
+ *
+ * \remark Registers without a shadow are always written.
+ *
+ * \param [in]  address       The address of the register
+ * \param [in]  value         The value to be written
+ */
+void SX126xWriteRegisterCached( uint16_t address, uint8_t value );
+
+/*!
+ * \brief Reads a register from its shadow, the radio is only read when the
+ *        shadow is not valid
+ *
+ * \remark Registers without a shadow are always read from the radio.
+ *
+ * \param [in]  address       The address of the register
+ * \retval      value         The value of the register
+ */
+uint8_t SX126xReadRegisterCached( uint16_t address );
+
+/*!
+ * \brief Invalidates the shadows of a range of registers
+ *
+ * To be called when registers are written without going through
+ * \ref SX126xWriteRegisterCached.
+ *
+ * \param [in]  address       The address of the first register
+ * \param [in]  size          The number of registers
+ */
+void SX126xShadowInvalidateRegisters( uint16_t address, uint16_t size );
+
+/*!
+ * \brief Invalidates the shadows of all the registers and commands
+ *
+ * \remark Done on reset and when the radio goes to sleep with a cold start.
+ *         A warm start keeps the commands configuration but not all the
+ *         registers, only the register shadows are invalidated then.
+ */
+void SX126xShadowInvalidate( void );
+
+/*!
+ * \brief Gets the generation of the command shadows
+ *
+ * The generation changes each time command shadows are invalidated. A
+ * configuration applied by an upper layer is still held by the radio as long
+ * as the generation did not change.
+ *
+ * \retval generation Current generation
+ */
+uint32_t SX126xGetShadowGeneration( void );
+
+/*!
+ * \brief Accounts for an SPI transaction made unnecessary by a shadow
+ *
+ * \remark Also used by upper layers skipping commands the radio already holds.
+ *
+ * \param [in]  bytes         Size of the transaction
+ */
+void SX126xShadowAddSaved( uint16_t bytes );
+
+/*!
+ * \brief Gets the SPI traffic saved by the shadows
+ *
+ * \retval stats Statistics collected since startup
+ */
+const SX126xShadowStats_t* SX126xGetShadowStats( void );
+
 /*!
  * \brief Write data to the buffer holding the payload in the radio
  *
@@ -967,6 +1066,20 @@ void SX126xWriteBuffer( uint8_t offset, uint8_t *buffer, uint8_t size );
  */
 void SX126xReadBuffer( uint8_t offset, uint8_t *buffer, uint8_t size );
 
+/*!
+ * \brief Read data from the buffer holding the payload in the radio in the
+ *        background
+ *
+ * \remark The next radio access waits until the transfer is done. The
+ *         callback may be called from IRQ context.
+ *
+ * \param [in]  offset        The offset to start reading the payload
+ * \param [out] buffer        A pointer to a buffer holding the data from the radio
+ * \param [in]  size          The number of byte to be read
+ * \param [in]  callback      Function called once the data is in buffer
+ */
+void SX126xReadBufferAsync( uint8_t offset, uint8_t *buffer, uint8_t size, void ( *callback )( void ) );
+
 /*!
  * \brief   Sets the IRQ mask and DIO masks
  *
@@ -0,0 +1,198 @@
+/*!
+ * \file      entropy.c
+ *
+ * \brief     Entropy pool fed in the background by the radio and the board
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ */
+#include "utilities.h"
+#include "entropy.h"
+
+/*!
+ * Pool size in 32 bits words
+ */
+#define ENTROPY_POOL_SIZE                           ( ENTROPY_POOL_BITS / 32 )
+
+/*!
+ * Health tests false positive probability is 2^-ENTROPY_HEALTH_ALPHA_LOG2
+ */
+#define ENTROPY_HEALTH_ALPHA_LOG2                   20
+
+/*!
+ * Adaptive proportion test window, in samples
+ */
+#define ENTROPY_APT_WINDOW                          64
+
+/*!
+ * Adaptive proportion test cutoff for the minimum entropy of 1 bit per
+ * sample over ENTROPY_APT_WINDOW samples
+ */
+#define ENTROPY_APT_CUTOFF                          51
+
+/*!
+ * Health tests state of a source
+ */
+typedef struct EntropyHealth_s
+{
+    /*!
+     * Repetition count test
+     */
+    uint32_t RctSample;
+    uint8_t RctCount;
+    /*!
+     * Adaptive proportion test
+     */
+    uint32_t AptSample;
+    uint8_t AptCount;
+    uint8_t AptIndex;
+    /*!
+     * Number of samples discarded
+     */
+    uint32_t Failures;
+}EntropyHealth_t;
+
+static uint32_t Pool[ENTROPY_POOL_SIZE];
+static uint8_t PoolIndex = 0;
+static uint16_t PoolBits = 0;
+static uint32_t PoolCounter = 0;
+
+static EntropyHealth_t Health[ENTROPY_SOURCE_MAX];
+
+/*!
+ * \brief Avalanches the bits of a word, each input bit flips half the output bits
+ */
+static uint32_t EntropyMix( uint32_t x )
+{
+    x ^= x >> 16;
+    x *= 0x85EBCA6B;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35;
+    x ^= x >> 16;
+    return x;
+}
+
+static void EntropyStir( uint32_t sample )
+{
+    uint8_t previous = ( PoolIndex + ENTROPY_POOL_SIZE - 1 ) % ENTROPY_POOL_SIZE;
+
+    Pool[PoolIndex] ^= EntropyMix( sample + Pool[previous] );
+    PoolIndex = ( PoolIndex + 1 ) % ENTROPY_POOL_SIZE;
+}
+
+/*!
+ * \brief Runs the continuous health tests of NIST SP 800-90B on a raw sample
+ *
+ * \retval status true when the sample passed the tests
+ */
+static bool EntropyHealthTest( EntropyHealth_t *health, uint32_t sample, uint8_t bits )
+{
+    bool status = true;
+
+    // Repetition count test, the cutoff depends on the claimed entropy
+    if( ( health->RctCount > 0 ) && ( sample == health->RctSample ) )
+    {
+        health->RctCount++;
+        if( health->RctCount >= ( 1 + ( ENTROPY_HEALTH_ALPHA_LOG2 + bits - 1 ) / bits ) )
+        {
+            status = false;
+        }
+    }
+    else
+    {
+        health->RctSample = sample;
+        health->RctCount = 1;
+    }
+
+    // Adaptive proportion test
+    if( health->AptIndex == 0 )
+    {
+        health->AptSample = sample;
+        health->AptCount = 1;
+    }
+    else if( sample == health->AptSample )
+    {
+        health->AptCount++;
+        if( health->AptCount >= ENTROPY_APT_CUTOFF )
+        {
+            status = false;
+        }
+    }
+    health->AptIndex = ( health->AptIndex + 1 ) % ENTROPY_APT_WINDOW;
+
+    return status;
+}
+
+void EntropyAdd( EntropySource_t source, uint32_t sample, uint8_t bits )
+{
+    if( ( source >= ENTROPY_SOURCE_MAX ) || ( bits == 0 ) || ( bits > 32 ) )
+    {
+        return;
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+
+    if( EntropyHealthTest( &Health[source], sample, bits ) == true )
+    {
+        EntropyStir( sample );
+        PoolBits = MIN( PoolBits + bits, ENTROPY_POOL_BITS );
+    }
+    else
+    {
+        // The source may be stuck, do not trust what it already gave
+        Health[source].Failures++;
+        PoolBits = 0;
+    }
+
+    CRITICAL_SECTION_END( );
+}
+
+bool EntropyGet( uint32_t *value )
+{
+    bool status = false;
+
+    CRITICAL_SECTION_BEGIN( );
+
+    if( PoolBits >= 32 )
+    {
+        uint32_t output = PoolCounter++;
+
+        for( uint8_t i = 0; i < ENTROPY_POOL_SIZE; i++ )
+        {
+            output = EntropyMix( output ^ Pool[i] );
+        }
+        // Feed back so that the pool cannot be rewound from an output
+        EntropyStir( ~output );
+        PoolBits -= 32;
+
+        *value = output;
+        status = true;
+    }
+
+    CRITICAL_SECTION_END( );
+    return status;
+}
+
+uint16_t EntropyGetBits( void )
+{
+    return PoolBits;
+}
+
+uint32_t EntropyGetFailures( EntropySource_t source )
+{
+    if( source >= ENTROPY_SOURCE_MAX )
+    {
+        return 0;
+    }
+    return Health[source].Failures;
+}
@@ -0,0 +1,86 @@
+/*!
+ * \file      entropy.h
+ *
+ * \brief     Entropy pool fed in the background by the radio and the board
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ */
+#ifndef __ENTROPY_H__
+#define __ENTROPY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * Maximum amount of entropy held by the pool, in bits
+ */
+#define ENTROPY_POOL_BITS                           128
+
+/*!
+ * Entropy sources, each one has its own health tests state
+ */
+typedef enum eEntropySource
+{
+    ENTROPY_SOURCE_RADIO,
+    ENTROPY_SOURCE_BOARD,
+    ENTROPY_SOURCE_MAX,
+}EntropySource_t;
+
+/*!
+ * \brief Adds a raw sample to the pool
+ *
+ * The sample runs through the repetition count and adaptive proportion
+ * health tests of its source. A failing sample is discarded and the pool
+ * entropy estimate is cleared.
+ *
+ * \param [IN] source Source of the sample
+ * \param [IN] sample Raw sample
+ * \param [IN] bits   Entropy carried by the sample, in bits [1:32]
+ */
+void EntropyAdd( EntropySource_t source, uint32_t sample, uint8_t bits );
+
+/*!
+ * \brief Gets a random number out of the pool
+ *
+ * \param [OUT] value Random number
+ * \retval status     false when the pool holds less than 32 bits of entropy,
+ *                    value is then left untouched
+ */
+bool EntropyGet( uint32_t *value );
+
+/*!
+ * \brief Gets the entropy currently held by the pool
+ *
+ * \retval bits Entropy estimate, in bits
+ */
+uint16_t EntropyGetBits( void );
+
+/*!
+ * \brief Gets the number of samples discarded by the health tests
+ *
+ * \param [IN] source Source of the samples
+ * \retval failures   Number of failed samples
+ */
+uint32_t EntropyGetFailures( EntropySource_t source );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ENTROPY_H__
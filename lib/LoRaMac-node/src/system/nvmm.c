@@ -29,6 +29,13 @@
 #include "eeprom-board.h"
 #include "nvmm.h"
 
+/*!
+ * Number of bytes read from the NVM at once while checking a CRC
+ */
+#ifndef NVMM_CRC32_CHECK_CHUNK_SIZE
+#define NVMM_CRC32_CHECK_CHUNK_SIZE                 64
+#endif
+
 uint16_t NvmmWrite( uint8_t* src, uint16_t size, uint16_t offset )
 {
     if( EepromMcuWriteBuffer( offset, src, size ) == SUCCESS )
@@ -49,7 +56,8 @@ uint16_t NvmmRead( uint8_t* dest, uint16_t size, uint16_t offset )
 
 bool NvmmCrc32Check( uint16_t size, uint16_t offset )
 {
-    uint8_t data = 0;
+    uint8_t data[NVMM_CRC32_CHECK_CHUNK_SIZE];
+    uint16_t chunkSize = 0;
     uint32_t calculatedCrc32 = 0;
     uint32_t readCrc32 = 0;
 
@@ -58,13 +66,14 @@ bool NvmmCrc32Check( uint16_t size, uint16_t offset )
     {
         // Calculate crc
         calculatedCrc32 = Crc32Init( );
-        for( uint16_t i = 0; i < ( size - sizeof( readCrc32 ) ); i++ )
+        for( uint16_t i = 0; i < ( size - sizeof( readCrc32 ) ); i += chunkSize )
         {
-            if( NvmmRead( &data, 1, offset + i ) != 1 )
+            chunkSize = MIN( sizeof( data ), ( size - sizeof( readCrc32 ) ) - i );
+            if( NvmmRead( data, chunkSize, offset + i ) != chunkSize )
             {
                 return false;
             }
-            calculatedCrc32 = Crc32Update( calculatedCrc32, &data, 1 );
+            calculatedCrc32 = Crc32Update( calculatedCrc32, data, chunkSize );
         }
         calculatedCrc32 = Crc32Finalize( calculatedCrc32 );
 
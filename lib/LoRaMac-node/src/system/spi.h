@@ -102,6 +102,51 @@ void SpiFrequency( Spi_t *obj, uint32_t hz );
  */
 uint16_t SpiInOut( Spi_t *obj, uint16_t outData );
 
+/*!
+ * \brief Sends and receives a block of bytes in one transfer
+ *
+ * \param [IN]  obj    SPI object
+ * \param [IN]  txData Bytes to be sent, zeros are sent when NULL
+ * \param [OUT] rxData Received bytes, discarded when NULL
+ * \param [IN]  size   Number of bytes to transfer
+ */
+void SpiTransfer( Spi_t *obj, const uint8_t *txData, uint8_t *rxData, uint16_t size );
+
+/*!
+ * \brief Transfer completion callback
+ *
+ * \param [IN] context User defined data object pointer
+ */
+typedef void ( *SpiTransferCallback_t )( void *context );
+
+/*!
+ * \brief Starts a transfer in the background
+ *
+ * \remark The callback is called from IRQ context once the transfer is done.
+ *         Boards without DMA support complete the transfer before returning.
+ *         Nothing is started while an earlier transfer still runs, the call
+ *         does not wait for it.
+ *
+ * \param [IN]  obj      SPI object
+ * \param [IN]  txData   Bytes to be sent, zeros are sent when NULL
+ * \param [OUT] rxData   Received bytes, discarded when NULL
+ * \param [IN]  size     Number of bytes to transfer
+ * \param [IN]  callback Function called once the transfer is done
+ * \param [IN]  context  User defined data object pointer passed to callback
+ * \retval started False when a transfer was already running, callback is
+ *                 then not called
+ */
+bool SpiTransferAsync( Spi_t *obj, const uint8_t *txData, uint8_t *rxData, uint16_t size,
+                       SpiTransferCallback_t callback, void *context );
+
+/*!
+ * \brief Checks if a background transfer is running
+ *
+ * \param [IN] obj SPI object
+ * \retval pending True while a transfer started by SpiTransferAsync runs
+ */
+bool SpiIsTransferPending( Spi_t *obj );
+
 #ifdef __cplusplus
 }
 #endif
@@ -41,10 +41,21 @@
         }                                      \
     }while( 0 );
 
+#if( TIMER_LISTS > 1 )
+/*!
+ * Timers list head pointers, TimerListId selects the one in use
+ */
+static TimerEvent_t *TimerListHeads[TIMER_LISTS];
+
+static uint16_t TimerListId = 0;
+
+#define TimerListHead                               TimerListHeads[TimerListId]
+#else
 /*!
  * Timers list head pointer
  */
 static TimerEvent_t *TimerListHead = NULL;
+#endif
 
 /*!
  * \brief Adds or replace the head timer of the list.
@@ -83,6 +94,17 @@ static void TimerSetTimeout( TimerEvent_t *obj );
  */
 static bool TimerExists( TimerEvent_t *obj );
 
+/*!
+ * \brief Sets the RTC timer context to the current time
+ *
+ * \remark The timestamps of every list are relative to the single RTC timer
+ *         context. The ones of the lists not selected are rebased on the new
+ *         context, the selected list is rebased by the caller.
+ *
+ * \retval now New timer context
+ */
+static TimerTick_t TimerSetContextNow( void );
+
 void TimerInit( TimerEvent_t *obj, void ( *callback )( void *context ) )
 {
     obj->Timestamp = 0;
@@ -101,7 +123,7 @@ void TimerSetContext( TimerEvent_t *obj, void* context )
 
 void TimerStart( TimerEvent_t *obj )
 {
-    uint32_t elapsedTime = 0;
+    TimerTick_t elapsedTime = 0;
 
     CRITICAL_SECTION_BEGIN( );
 
@@ -117,7 +139,7 @@ void TimerStart( TimerEvent_t *obj )
 
     if( TimerListHead == NULL )
     {
-        RtcSetTimerContext( );
+        TimerSetContextNow( );
         // Inserts a timer at time now + obj->Timestamp
         TimerInsertNewHeadTimer( obj );
     }
@@ -185,12 +207,12 @@ void TimerIrqHandler( void )
     TimerEvent_t* cur;
     TimerEvent_t* next;
 
-    uint32_t old =  RtcGetTimerContext( );
-    uint32_t now =  RtcSetTimerContext( );
-    uint32_t deltaContext = now - old; // intentional wrap around
+    TimerTick_t old =  RtcGetTimerContext( );
+    TimerTick_t now =  TimerSetContextNow( );
+    TimerTick_t deltaContext = now - old; // intentional wrap around
 
     // Update timeStamp based upon new Time Reference
-    // because delta context should never exceed 2^32
+    // because delta context should never exceed the tick range
     if( TimerListHead != NULL )
     {
         for( cur = TimerListHead; cur->Next != NULL; cur = cur->Next )
@@ -328,7 +350,7 @@ void TimerReset( TimerEvent_t *obj )
 void TimerSetValue( TimerEvent_t *obj, uint32_t value )
 {
     uint32_t minValue = 0;
-    uint32_t ticks = RtcMs2Tick( value );
+    TimerTick_t ticks = RtcMs2Tick( value );
 
     TimerStop( obj );
 
@@ -343,9 +365,36 @@ void TimerSetValue( TimerEvent_t *obj, uint32_t value )
     obj->ReloadValue = ticks;
 }
 
+bool TimerGetNextExpiry( TimerTick_t *ticks )
+{
+    TimerTick_t elapsedTime = 0;
+
+    CRITICAL_SECTION_BEGIN( );
+
+    if( TimerListHead == NULL )
+    {
+        CRITICAL_SECTION_END( );
+        return false;
+    }
+
+    elapsedTime = RtcGetTimerElapsedTime( );
+
+    if( TimerListHead->Timestamp > elapsedTime )
+    {
+        *ticks = TimerListHead->Timestamp - elapsedTime;
+    }
+    else
+    {
+        *ticks = 0;
+    }
+
+    CRITICAL_SECTION_END( );
+    return true;
+}
+
 TimerTime_t TimerGetCurrentTime( void )
 {
-    uint32_t now = RtcGetTimerValue( );
+    TimerTick_t now = RtcGetTimerValue( );
     return  RtcTick2Ms( now );
 }
 
@@ -355,11 +404,16 @@ TimerTime_t TimerGetElapsedTime( TimerTime_t past )
     {
         return 0;
     }
+#if( TIMER_TICK_64BIT == 1 )
+    // The ticks do not wrap but the time in ms does, intentional wrap around
+    return TimerGetCurrentTime( ) - past;
+#else
     uint32_t nowInTicks = RtcGetTimerValue( );
     uint32_t pastInTicks = RtcMs2Tick( past );
 
     // Intentional wrap around. Works Ok if tick duration below 1ms
     return RtcTick2Ms( nowInTicks - pastInTicks );
+#endif
 }
 
 static void TimerSetTimeout( TimerEvent_t *obj )
@@ -375,6 +429,37 @@ static void TimerSetTimeout( TimerEvent_t *obj )
     RtcSetAlarm( obj->Timestamp );
 }
 
+static TimerTick_t TimerSetContextNow( void )
+{
+#if( TIMER_LISTS > 1 )
+    TimerTick_t old = RtcGetTimerContext( );
+    TimerTick_t now = RtcSetTimerContext( );
+    TimerTick_t deltaContext = now - old; // intentional wrap around
+
+    for( uint16_t id = 0; id < TIMER_LISTS; id++ )
+    {
+        if( id == TimerListId )
+        {
+            continue;
+        }
+        for( TimerEvent_t *cur = TimerListHeads[id]; cur != NULL; cur = cur->Next )
+        {
+            if( cur->Timestamp > deltaContext )
+            {
+                cur->Timestamp -= deltaContext;
+            }
+            else
+            {
+                cur->Timestamp = 0;
+            }
+        }
+    }
+    return now;
+#else
+    return RtcSetTimerContext( );
+#endif
+}
+
 TimerTime_t TimerTempCompensation( TimerTime_t period, float temperature )
 {
     return RtcTempCompensation( period, temperature );
@@ -384,3 +469,13 @@ void TimerProcess( void )
 {
     RtcProcess( );
 }
+
+#if( TIMER_LISTS > 1 )
+void TimerListSelect( uint16_t id )
+{
+    if( id < TIMER_LISTS )
+    {
+        TimerListId = id;
+    }
+}
+#endif
@@ -32,13 +32,41 @@ extern "C"
 #include <stdbool.h>
 #include <stdint.h>
 
+/*!
+ * Number of independent timer lists, one per LoRaMac context by default
+ */
+#ifndef TIMER_LISTS
+#ifdef LORAMAC_CONTEXTS
+#define TIMER_LISTS                                 LORAMAC_CONTEXTS
+#else
+#define TIMER_LISTS                                 1
+#endif
+#endif
+
+/*!
+ * Set to 1 when the board RTC provides a 64 bits tick counter, timers then
+ * never wrap and can last as long as TimerTime_t allows
+ */
+#ifndef TIMER_TICK_64BIT
+#define TIMER_TICK_64BIT                            0
+#endif
+
+/*!
+ * \brief Timer tick variable definition
+ */
+#if( TIMER_TICK_64BIT == 1 )
+typedef uint64_t TimerTick_t;
+#else
+typedef uint32_t TimerTick_t;
+#endif
+
 /*!
  * \brief Timer object description
  */
 typedef struct TimerEvent_s
 {
-    uint32_t Timestamp;                  //! Current timer value
-    uint32_t ReloadValue;                //! Timer delay value
+    TimerTick_t Timestamp;               //! Current timer value
+    TimerTick_t ReloadValue;             //! Timer delay value
     bool IsStarted;                      //! Is the timer currently running
     bool IsNext2Expire;                  //! Is the next timer to expire
     void ( *Callback )( void* context ); //! Timer IRQ callback function
@@ -117,6 +145,28 @@ void TimerReset( TimerEvent_t *obj );
  */
 void TimerSetValue( TimerEvent_t *obj, uint32_t value );
 
+/*!
+ * \brief Gets the time remaining until the next timer of the list expires
+ *
+ * \param [OUT] ticks Remaining time in RTC ticks
+ *
+ * \retval status  returns true if a timer is running, false if the timer
+ *                 list is empty
+ */
+bool TimerGetNextExpiry( TimerTick_t *ticks );
+
+#if( TIMER_LISTS > 1 )
+/*!
+ * \brief Selects the timer list used by the following timer calls
+ *
+ * \remark The RTC alarm only follows the selected list. The other lists
+ *         have to be polled through \ref TimerGetNextExpiry.
+ *
+ * \param [IN] id List identifier
+ */
+void TimerListSelect( uint16_t id );
+#endif
+
 /*!
  * \brief Read the current time
  *
@@ -11,8 +11,35 @@
 #include "pico.h"
 #include "pico/unique_id.h"
 #include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "hardware/structs/rosc.h"
 
 #include "board.h"
+#include "entropy.h"
+#include "lpm-board.h"
+
+/*!
+ * Entropy credited to a whitened word of ring oscillator random bits. The
+ * extractor removes the bias but not the correlation with the system clock,
+ * which runs from the same oscillator until the crystal is started.
+ */
+#define BOARD_ROSC_ENTROPY_BITS                     1
+
+/*!
+ * Time between two reads of the ring oscillator random bit, lets the
+ * oscillator jitter accumulate between the bits
+ */
+#define BOARD_ROSC_BIT_SPACING_US                   1
+
+/*!
+ * Maximum number of bit pairs read for one whitened word
+ */
+#define BOARD_ROSC_PAIRS_MAX                        256
+
+/*!
+ * Maximum number of ring oscillator words read to fill the entropy pool
+ */
+#define BOARD_ROSC_SAMPLES_MAX                      ( 4 * ENTROPY_POOL_BITS / BOARD_ROSC_ENTROPY_BITS )
 
 void BoardInitMcu( void )
 {
@@ -24,7 +51,17 @@ void BoardInitPeriph( void )
 
 void BoardLowPowerHandler( void )
 {
-    __wfi();
+    /*!
+     * An interrupt raised once they are disabled is kept pending and the
+     * core does not enter low power. One served before is not: the caller
+     * checks its pending work within a critical section and only calls this
+     * function from it when there is none.
+     */
+    uint32_t ints = save_and_disable_interrupts();
+
+    LpmEnterLowPower( );
+
+    restore_interrupts(ints);
 }
 
 uint8_t BoardGetBatteryLevel( void )
@@ -32,13 +69,50 @@ uint8_t BoardGetBatteryLevel( void )
     return 0;
 }
 
+/*!
+ * \brief Reads a word of ring oscillator random bits through a von Neumann
+ *        extractor
+ *
+ * \retval sample Whitened bits, fewer than 32 when the bit seems stuck
+ */
+static uint32_t BoardRoscSample( void )
+{
+    uint32_t sample = 0;
+    uint8_t bits = 0;
+
+    for (uint16_t n = 0; (n < BOARD_ROSC_PAIRS_MAX) && (bits < 32); n++) {
+        uint8_t first = rosc_hw->randombit & 1;
+        busy_wait_us_32(BOARD_ROSC_BIT_SPACING_US);
+        uint8_t second = rosc_hw->randombit & 1;
+        busy_wait_us_32(BOARD_ROSC_BIT_SPACING_US);
+
+        // Equal bits are dropped, 01 and 10 are equally likely
+        if (first != second) {
+            sample = (sample << 1) | first;
+            bits++;
+        }
+    }
+    return sample;
+}
+
 uint32_t BoardGetRandomSeed( void )
 {
     uint8_t id[8];
+    uint32_t seed;
+    uint32_t random = 0;
+
+    // The ring oscillator jitter makes the seed differ between boots and
+    // boards, the loop is bounded in case the oscillator fails the health tests
+    for (uint16_t n = 0; (n < BOARD_ROSC_SAMPLES_MAX) && (EntropyGetBits() < ENTROPY_POOL_BITS); n++) {
+        EntropyAdd(ENTROPY_SOURCE_BOARD, BoardRoscSample(), BOARD_ROSC_ENTROPY_BITS);
+    }
+    EntropyGet(&random);
 
     BoardGetUniqueId(id);
 
-    return (id[3] << 24) | (id[2] << 16) | (id[1] << 1) | id[0];
+    seed = (id[3] << 24) | (id[2] << 16) | (id[1] << 1) | id[0];
+
+    return seed ^ random;
 }
 
 void BoardGetUniqueId( uint8_t *id )
@@ -2,18 +2,376 @@
  * Copyright (c) 2021 Arm Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
- * 
+ *
  */
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "pico.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+#ifndef LORAWAN_MULTICORE
+#define LORAWAN_MULTICORE                           0
+#endif
+
+#if( LORAWAN_MULTICORE == 1 )
+#include "pico/multicore.h"
+#endif
+
 #include "utilities.h"
+#include "LoRaMac.h"
 #include "eeprom-board.h"
 
+/*!
+ * Number of flash sectors, at the end of the flash, holding the EEPROM log.
+ * The sectors are used round robin to spread the erase cycles.
+ */
+#ifndef EEPROM_FLASH_SECTORS
+#define EEPROM_FLASH_SECTORS                        4
+#endif
+
+/*!
+ * Flash offset of the first EEPROM log sector
+ */
+#define EEPROM_FLASH_OFFSET                         ( PICO_FLASH_SIZE_BYTES - ( EEPROM_FLASH_SECTORS * FLASH_SECTOR_SIZE ) )
+
+/*!
+ * Emulated EEPROM size, enough to hold all the LoRaMac NVM groups
+ */
+#define EEPROM_SIZE                                 sizeof( LoRaMacNvmData_t )
+
+#define EEPROM_SECTOR_MAGIC                         0x314D564E // "NVM1"
+
+#define EEPROM_RECORD_MAGIC                         0xA55A
+
+/*!
+ * Maximum data size of the records written when a sector is compacted
+ */
+#define EEPROM_SNAPSHOT_RECORD_SIZE                 512
+
+/*!
+ * Flash space used by a record holding size bytes of data
+ */
+#define EEPROM_RECORD_SIZE( size )                  ( ( sizeof( EepromRecordHeader_t ) + ( size ) + 3 ) & ~3 )
+
+/*!
+ * Sector header, programmed once the sector holds a complete snapshot
+ */
+typedef struct EepromSectorHeader_s
+{
+    uint32_t Magic;
+    uint32_t Sequence;
+    uint32_t SequenceInv;
+    uint32_t Reserved;
+}EepromSectorHeader_t;
+
+/*!
+ * Record header, followed by Size bytes to be stored at Addr
+ */
+typedef struct EepromRecordHeader_s
+{
+    uint16_t Magic;
+    uint16_t Addr;
+    uint16_t Size;
+    uint16_t Reserved;
+    uint32_t Crc;
+}EepromRecordHeader_t;
+
+_Static_assert( ( sizeof( EepromSectorHeader_t ) +
+                  ( ( EEPROM_SIZE + EEPROM_SNAPSHOT_RECORD_SIZE - 1 ) / EEPROM_SNAPSHOT_RECORD_SIZE ) * EEPROM_RECORD_SIZE( 0 ) +
+                  EEPROM_SIZE ) < FLASH_SECTOR_SIZE, "EEPROM snapshot does not fit into a flash sector" );
+
+/*!
+ * RAM image of the EEPROM, reads are served from it and writes only log the
+ * bytes which differ from it
+ */
+static uint8_t EepromCache[EEPROM_SIZE];
+
+/*!
+ * Flash page being merged with new data before programming
+ */
+static uint8_t EepromPageBuffer[FLASH_PAGE_SIZE];
+
+static bool EepromMounted = false;
+
+/*!
+ * Sector holding the current log, its sequence number and the offset of the
+ * next record
+ */
+static uint8_t EepromSector = EEPROM_FLASH_SECTORS - 1;
+static uint32_t EepromSequence = 0;
+static uint32_t EepromWriteOffset = FLASH_SECTOR_SIZE;
+
+static const uint8_t* EepromFlashPtr( uint8_t sector, uint32_t offset )
+{
+    return ( const uint8_t* )( XIP_BASE + EEPROM_FLASH_OFFSET + ( sector * FLASH_SECTOR_SIZE ) + offset );
+}
+
+/*!
+ * \brief Keeps every core off the flash while it is erased or programmed
+ *
+ * \remark With LORAWAN_MULTICORE the LoRaMac stack writes from core1, core0
+ *         is parked in RAM by its lockout handler, installed by
+ *         lorawan_init_abp or lorawan_init_otaa, until EepromFlashUnlock.
+ *
+ * \retval ints Interrupts state to be given to EepromFlashUnlock
+ */
+static uint32_t EepromFlashLock( void )
+{
+#if( LORAWAN_MULTICORE == 1 )
+    multicore_lockout_start_blocking( );
+#endif
+    return save_and_disable_interrupts( );
+}
+
+static void EepromFlashUnlock( uint32_t ints )
+{
+    restore_interrupts( ints );
+#if( LORAWAN_MULTICORE == 1 )
+    multicore_lockout_end_blocking( );
+#endif
+}
+
+static void EepromFlashErase( uint8_t sector )
+{
+    uint32_t ints = EepromFlashLock( );
+
+    flash_range_erase( EEPROM_FLASH_OFFSET + ( sector * FLASH_SECTOR_SIZE ), FLASH_SECTOR_SIZE );
+
+    EepromFlashUnlock( ints );
+}
+
+/*!
+ * Programs data at any offset of a sector. Each page is merged with its
+ * current content, bytes already programmed are programmed again with the
+ * same value.
+ */
+static void EepromFlashProgram( uint8_t sector, uint32_t offset, const uint8_t* data, uint32_t size )
+{
+    while( size > 0 )
+    {
+        uint32_t pageOffset = offset & ~( FLASH_PAGE_SIZE - 1 );
+        uint32_t inPage = offset - pageOffset;
+        uint32_t chunk = MIN( size, FLASH_PAGE_SIZE - inPage );
+
+        memcpy( EepromPageBuffer, EepromFlashPtr( sector, pageOffset ), FLASH_PAGE_SIZE );
+        memcpy( EepromPageBuffer + inPage, data, chunk );
+
+        uint32_t ints = EepromFlashLock( );
+
+        flash_range_program( EEPROM_FLASH_OFFSET + ( sector * FLASH_SECTOR_SIZE ) + pageOffset, EepromPageBuffer, FLASH_PAGE_SIZE );
+
+        EepromFlashUnlock( ints );
+
+        offset += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+static uint32_t EepromRecordCrc( const EepromRecordHeader_t* header, const uint8_t* data )
+{
+    uint32_t crc = Crc32Init( );
+
+    crc = Crc32Update( crc, ( uint8_t* )header, offsetof( EepromRecordHeader_t, Crc ) );
+    crc = Crc32Update( crc, ( uint8_t* )data, header->Size );
+
+    return Crc32Finalize( crc );
+}
+
+/*!
+ * Appends a record to a sector and returns the offset following it
+ */
+static uint32_t EepromAppend( uint8_t sector, uint32_t offset, uint16_t addr, const uint8_t* data, uint16_t size )
+{
+    EepromRecordHeader_t header =
+    {
+        .Magic = EEPROM_RECORD_MAGIC,
+        .Addr = addr,
+        .Size = size,
+        .Reserved = 0xFFFF,
+    };
+
+    header.Crc = EepromRecordCrc( &header, data );
+
+    // An interrupted write leaves a header with a mismatching CRC
+    EepromFlashProgram( sector, offset, ( const uint8_t* )&header, sizeof( header ) );
+    EepromFlashProgram( sector, offset + sizeof( header ), data, size );
+
+    return offset + EEPROM_RECORD_SIZE( size );
+}
+
+/*!
+ * Writes the whole cache into the next sector and makes it the current one
+ */
+static void EepromCompact( void )
+{
+    uint8_t sector = ( EepromSector + 1 ) % EEPROM_FLASH_SECTORS;
+    uint32_t offset = sizeof( EepromSectorHeader_t );
+
+    EepromFlashErase( sector );
+
+    for( uint16_t addr = 0; addr < EEPROM_SIZE; addr += EEPROM_SNAPSHOT_RECORD_SIZE )
+    {
+        uint16_t size = MIN( EEPROM_SNAPSHOT_RECORD_SIZE, EEPROM_SIZE - addr );
+        uint16_t i = 0;
+
+        // Erased chunks are restored as erased without a record
+        while( ( i < size ) && ( EepromCache[addr + i] == 0xFF ) )
+        {
+            i++;
+        }
+        if( i < size )
+        {
+            offset = EepromAppend( sector, offset, addr, EepromCache + addr, size );
+        }
+    }
+
+    // The sector becomes valid only once the snapshot is complete
+    EepromSectorHeader_t header =
+    {
+        .Magic = EEPROM_SECTOR_MAGIC,
+        .Sequence = EepromSequence + 1,
+        .SequenceInv = ~( EepromSequence + 1 ),
+        .Reserved = 0xFFFFFFFF,
+    };
+
+    EepromFlashProgram( sector, 0, ( const uint8_t* )&header, sizeof( header ) );
+
+    EepromSector = sector;
+    EepromSequence++;
+    EepromWriteOffset = offset;
+}
+
+/*!
+ * Replays the records of a sector into the cache
+ *
+ * \retval offset Offset following the last valid record, FLASH_SECTOR_SIZE
+ *                if the log is damaged and must be compacted
+ */
+static uint32_t EepromReplay( uint8_t sector )
+{
+    uint32_t offset = sizeof( EepromSectorHeader_t );
+
+    while( ( offset + sizeof( EepromRecordHeader_t ) ) <= FLASH_SECTOR_SIZE )
+    {
+        const EepromRecordHeader_t* header = ( const EepromRecordHeader_t* )EepromFlashPtr( sector, offset );
+        const uint8_t* data = ( const uint8_t* )( header + 1 );
+
+        if( header->Magic == 0xFFFF )
+        {
+            // End of the log
+            return offset;
+        }
+
+        if( ( header->Magic != EEPROM_RECORD_MAGIC ) ||
+            ( ( header->Addr + header->Size ) > EEPROM_SIZE ) ||
+            ( ( offset + EEPROM_RECORD_SIZE( header->Size ) ) > FLASH_SECTOR_SIZE ) ||
+            ( EepromRecordCrc( header, data ) != header->Crc ) )
+        {
+            // Interrupted write
+            return FLASH_SECTOR_SIZE;
+        }
+
+        memcpy( EepromCache + header->Addr, data, header->Size );
+        offset += EEPROM_RECORD_SIZE( header->Size );
+    }
+
+    return offset;
+}
+
+static void EepromMount( void )
+{
+    bool found = false;
+
+    memset( EepromCache, 0xFF, EEPROM_SIZE );
+
+    // The valid sector with the most recent sequence holds the current log
+    for( uint8_t sector = 0; sector < EEPROM_FLASH_SECTORS; sector++ )
+    {
+        const EepromSectorHeader_t* header = ( const EepromSectorHeader_t* )EepromFlashPtr( sector, 0 );
+
+        if( ( header->Magic != EEPROM_SECTOR_MAGIC ) || ( header->Sequence != ~header->SequenceInv ) )
+        {
+            continue;
+        }
+
+        if( ( found == false ) || ( ( int32_t )( header->Sequence - EepromSequence ) > 0 ) )
+        {
+            found = true;
+            EepromSector = sector;
+            EepromSequence = header->Sequence;
+        }
+    }
+
+    if( found == true )
+    {
+        EepromWriteOffset = EepromReplay( EepromSector );
+    }
+
+    EepromMounted = true;
+}
+
 uint8_t EepromMcuReadBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
 {
-    return FAIL;
+    if( ( addr + size ) > EEPROM_SIZE )
+    {
+        return FAIL;
+    }
+
+    if( EepromMounted == false )
+    {
+        EepromMount( );
+    }
+
+    memcpy( buffer, EepromCache + addr, size );
+
+    return SUCCESS;
 }
 
 uint8_t EepromMcuWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
 {
-    return FAIL;
+    uint16_t first = 0;
+    uint16_t last = size;
+
+    if( ( addr + size ) > EEPROM_SIZE )
+    {
+        return FAIL;
+    }
+
+    if( EepromMounted == false )
+    {
+        EepromMount( );
+    }
+
+    // Only log the bytes which changed
+    while( ( first < size ) && ( EepromCache[addr + first] == buffer[first] ) )
+    {
+        first++;
+    }
+    if( first == size )
+    {
+        return SUCCESS;
+    }
+    while( EepromCache[addr + last - 1] == buffer[last - 1] )
+    {
+        last--;
+    }
+
+    memcpy( EepromCache + addr + first, buffer + first, last - first );
+
+    if( ( EepromWriteOffset + EEPROM_RECORD_SIZE( last - first ) ) > FLASH_SECTOR_SIZE )
+    {
+        // Sector full, the snapshot already includes the new data
+        EepromCompact( );
+    }
+    else
+    {
+        EepromWriteOffset = EepromAppend( EepromSector, EepromWriteOffset, addr + first, buffer + first, last - first );
+    }
+
+    return SUCCESS;
 }
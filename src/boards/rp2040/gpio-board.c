@@ -5,10 +5,72 @@
  * 
  */
 
+#include "pico/time.h"
 #include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/structs/iobank0.h"
 
 #include "gpio-board.h"
 
+/*!
+ * GPIO objects owning an interrupt, indexed by pin
+ */
+static Gpio_t *GpioIrq[NUM_BANK0_GPIOS];
+
+/*!
+ * Time of the last interrupt of each pin, captured on IRQ entry
+ */
+static uint64_t GpioIrqTimestamp[NUM_BANK0_GPIOS];
+
+/*!
+ * All the pins share the bank interrupt, it runs at the highest priority
+ * requested
+ */
+static uint8_t GpioIrqPriority = PICO_LOWEST_IRQ_PRIORITY;
+
+static bool GpioIrqInstalled = false;
+
+/*!
+ * \brief Dispatches the bank interrupt to the handlers of the pending pins
+ *
+ * Pins without a handler are left to the other bank handlers, such as the
+ * Pico SDK GPIO callback.
+ */
+static void GpioMcuIrqHandler( void )
+{
+    uint64_t now = time_us_64( );
+    io_irq_ctrl_hw_t *irqCtrl = ( get_core_num( ) == 1 ) ? &iobank0_hw->proc1_irq_ctrl : &iobank0_hw->proc0_irq_ctrl;
+
+    // Each status register holds the 4 events of 8 pins
+    for( uint8_t reg = 0; reg < count_of( irqCtrl->ints ); reg++ )
+    {
+        uint32_t status = irqCtrl->ints[reg];
+
+        while( status != 0 )
+        {
+            uint8_t shift = __builtin_ctz( status ) & ~3;
+            uint8_t pin = ( reg * 8 ) + ( shift / 4 );
+            uint32_t events = ( status >> shift ) & 0xF;
+            Gpio_t *obj = GpioIrq[pin];
+
+            status &= ~( 0xFu << shift );
+
+            if( obj == NULL )
+            {
+                continue;
+            }
+
+            GpioIrqTimestamp[pin] = now;
+            gpio_acknowledge_irq( pin, events );
+
+            if( obj->IrqHandler != NULL )
+            {
+                obj->IrqHandler( obj->Context );
+            }
+        }
+    }
+}
+
 void GpioMcuInit( Gpio_t *obj, PinNames pin, PinModes mode, PinConfigs config, PinTypes type, uint32_t value )
 {
     obj->pin = pin;
@@ -56,6 +118,16 @@ void GpioMcuWrite( Gpio_t *obj, uint32_t value )
     gpio_put(obj->pin, value);
 }
 
+void GpioMcuSetContext( Gpio_t *obj, void* context )
+{
+    obj->Context = context;
+}
+
+void GpioMcuToggle( Gpio_t *obj )
+{
+    gpio_xor_mask(1u << obj->pin);
+}
+
 uint32_t GpioMcuRead( Gpio_t *obj )
 {
     return gpio_get(obj->pin);
@@ -63,13 +135,85 @@ uint32_t GpioMcuRead( Gpio_t *obj )
 
 void GpioMcuSetInterrupt( Gpio_t *obj, IrqModes irqMode, IrqPriorities irqPriority, GpioIrqHandler *irqHandler )
 {
-    // gpio_set_irq_enabled(obj->pin,GPIO_IRQ_EDGE_RISE,true);
-    // obj->IrqHandler = irqHandler;
-    gpio_set_irq_enabled_with_callback(obj->pin,GPIO_IRQ_EDGE_RISE,true,irqHandler);
+    uint32_t events = 0;
+    uint8_t priority;
+
+    if( ( obj->pin == NC ) || ( obj->pin >= NUM_BANK0_GPIOS ) || ( irqHandler == NULL ) )
+    {
+        return;
+    }
+
+    switch( irqMode )
+    {
+        case IRQ_RISING_EDGE:
+            events = GPIO_IRQ_EDGE_RISE;
+            break;
+        case IRQ_FALLING_EDGE:
+            events = GPIO_IRQ_EDGE_FALL;
+            break;
+        case IRQ_RISING_FALLING_EDGE:
+            events = GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL;
+            break;
+        default:
+            return;
+    }
+
+    // The NVIC implements 4 levels, the lowest value is the highest priority
+    switch( irqPriority )
+    {
+        case IRQ_VERY_HIGH_PRIORITY:
+            priority = PICO_HIGHEST_IRQ_PRIORITY;
+            break;
+        case IRQ_HIGH_PRIORITY:
+            priority = 0x40;
+            break;
+        case IRQ_MEDIUM_PRIORITY:
+            priority = 0x80;
+            break;
+        default:
+            priority = PICO_LOWEST_IRQ_PRIORITY;
+            break;
+    }
 
+    obj->IrqHandler = irqHandler;
+
+    gpio_set_irq_enabled( obj->pin, GPIO_IRQ_LEVEL_LOW | GPIO_IRQ_LEVEL_HIGH | GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, false );
+    gpio_acknowledge_irq( obj->pin, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE );
+    GpioIrq[obj->pin] = obj;
+
+    if( GpioIrqInstalled == false )
+    {
+        irq_add_shared_handler( IO_IRQ_BANK0, GpioMcuIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY );
+        GpioIrqInstalled = true;
+    }
+    if( priority < GpioIrqPriority )
+    {
+        GpioIrqPriority = priority;
+        irq_set_priority( IO_IRQ_BANK0, GpioIrqPriority );
+    }
+
+    // Enabled for the calling core, which serves the interrupt
+    gpio_set_irq_enabled( obj->pin, events, true );
+    irq_set_enabled( IO_IRQ_BANK0, true );
 }
 
 void GpioMcuRemoveInterrupt( Gpio_t *obj )
 {
-    gpio_set_irq_enabled(obj->pin,GPIO_IRQ_EDGE_RISE,false);
+    if( ( obj->pin == NC ) || ( obj->pin >= NUM_BANK0_GPIOS ) )
+    {
+        return;
+    }
+
+    gpio_set_irq_enabled( obj->pin, GPIO_IRQ_LEVEL_LOW | GPIO_IRQ_LEVEL_HIGH | GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, false );
+    GpioIrq[obj->pin] = NULL;
+}
+
+TimerTick_t GpioMcuGetIrqTimestamp( Gpio_t *obj )
+{
+    if( ( obj->pin == NC ) || ( obj->pin >= NUM_BANK0_GPIOS ) )
+    {
+        return 0;
+    }
+    // RTC ticks are microseconds on this platform
+    return GpioIrqTimestamp[obj->pin];
 }
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2021 Arm Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdint.h>
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
+#include "hardware/structs/clocks.h"
+#include "hardware/structs/scb.h"
+
+#include "utilities.h"
+#include "timer.h"
+#include "sx126x-board.h"
+#include "lpm-board.h"
+
+/*!
+ * Minimum time to the next timer event for the clock gated sleep to be used
+ */
+#ifndef LPM_STOP_MODE_MIN_US
+#define LPM_STOP_MODE_MIN_US                        2000
+#endif
+
+/*!
+ * Clocks kept running during the clock gated sleep: the timer and its tick
+ * generator, the GPIOs waking up on DIO1 and the stdio interface.
+ */
+#define LPM_STOP_SLEEP_EN0                          ( CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS )
+
+#if defined( LIB_PICO_STDIO_USB )
+#define LPM_STOP_SLEEP_EN1_STDIO                    ( CLOCKS_SLEEP_EN1_CLK_SYS_USBCTRL_BITS | CLOCKS_SLEEP_EN1_CLK_USB_USBCTRL_BITS )
+#elif defined( LIB_PICO_STDIO_UART )
+#define LPM_STOP_SLEEP_EN1_STDIO                    ( CLOCKS_SLEEP_EN1_CLK_SYS_UART0_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART0_BITS | \
+                                                      CLOCKS_SLEEP_EN1_CLK_SYS_UART1_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART1_BITS )
+#else
+#define LPM_STOP_SLEEP_EN1_STDIO                    0
+#endif
+
+#define LPM_STOP_SLEEP_EN1                          ( CLOCKS_SLEEP_EN1_CLK_SYS_TIMER_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_WATCHDOG_BITS | \
+                                                      LPM_STOP_SLEEP_EN1_STDIO )
+
+static uint32_t StopModeDisable = 0;
+static uint32_t OffModeDisable = 0;
+
+static LpmStats_t LpmStats;
+
+void LpmSetOffMode( LpmId_t id, LpmSetMode_t mode )
+{
+    CRITICAL_SECTION_BEGIN( );
+
+    switch( mode )
+    {
+        case LPM_DISABLE:
+        {
+            OffModeDisable |= ( uint32_t )id;
+            break;
+        }
+        case LPM_ENABLE:
+        {
+            OffModeDisable &= ~( uint32_t )id;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    CRITICAL_SECTION_END( );
+    return;
+}
+
+void LpmSetStopMode( LpmId_t id, LpmSetMode_t mode )
+{
+    CRITICAL_SECTION_BEGIN( );
+
+    switch( mode )
+    {
+        case LPM_DISABLE:
+        {
+            StopModeDisable |= ( uint32_t )id;
+            break;
+        }
+        case LPM_ENABLE:
+        {
+            StopModeDisable &= ~( uint32_t )id;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    CRITICAL_SECTION_END( );
+    return;
+}
+
+/*!
+ * \brief Checks if the radio and the timer list allow the clock gated sleep
+ *
+ * The radio IRQs must be served with the lowest latency while it is active
+ * and an SPI DMA transfer needs its clocks. Short sleeps are not worth
+ * gating the clocks.
+ */
+static bool LpmIsStopModeAllowed( void )
+{
+    TimerTick_t ticks;
+
+    switch( SX126xGetOperatingMode( ) )
+    {
+        case MODE_TX:
+        case MODE_RX:
+        case MODE_RX_DC:
+        case MODE_CAD:
+        case MODE_FS:
+        {
+            return false;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    if( SpiIsTransferPending( &SX126x.Spi ) == true )
+    {
+        return false;
+    }
+
+    // RTC ticks are microseconds on this platform
+    if( ( TimerGetNextExpiry( &ticks ) == true ) && ( ticks < LPM_STOP_MODE_MIN_US ) )
+    {
+        return false;
+    }
+    return true;
+}
+
+void LpmEnterLowPower( void )
+{
+    uint64_t start = time_us_64( );
+
+    /*!
+     * The RP2040 dormant mode stops the oscillators the timer runs from, the
+     * deepest mode waking up on a timer event is the clock gated sleep
+     */
+    if( ( StopModeDisable == 0 ) && ( LpmIsStopModeAllowed( ) == true ) )
+    {
+        LpmEnterStopMode( );
+        LpmExitStopMode( );
+
+        LpmStats.StopTime += time_us_64( ) - start;
+        LpmStats.StopCount++;
+    }
+    else
+    {
+        LpmEnterSleepMode( );
+        LpmExitSleepMode( );
+
+        LpmStats.SleepTime += time_us_64( ) - start;
+        LpmStats.SleepCount++;
+    }
+    return;
+}
+
+LpmGetMode_t LpmGetMode(void)
+{
+    LpmGetMode_t mode;
+
+    CRITICAL_SECTION_BEGIN( );
+
+    if( StopModeDisable != 0 )
+    {
+        mode = LPM_SLEEP_MODE;
+    }
+    else
+    {
+        mode = LPM_STOP_MODE;
+    }
+
+    CRITICAL_SECTION_END( );
+    return mode;
+}
+
+const LpmStats_t* LpmGetStats( void )
+{
+    CRITICAL_SECTION_BEGIN( );
+
+    LpmStats.RunTime = time_us_64( ) - LpmStats.SleepTime - LpmStats.StopTime;
+
+    CRITICAL_SECTION_END( );
+    return &LpmStats;
+}
+
+void LpmEnterSleepMode( void )
+{
+    __wfi( );
+}
+
+void LpmExitSleepMode( void )
+{
+}
+
+void LpmEnterStopMode( void )
+{
+    // The clocks are only gated once both cores sleep
+    clocks_hw->sleep_en0 = LPM_STOP_SLEEP_EN0;
+    clocks_hw->sleep_en1 = LPM_STOP_SLEEP_EN1;
+
+    scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+    __wfi( );
+}
+
+void LpmExitStopMode( void )
+{
+    scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+
+    clocks_hw->sleep_en0 = CLOCKS_SLEEP_EN0_RESET;
+    clocks_hw->sleep_en1 = CLOCKS_SLEEP_EN1_RESET;
+}
+
+void LpmEnterOffMode( void )
+{
+}
+
+void LpmExitOffMode( void )
+{
+}
@@ -10,6 +10,10 @@
 
 #include "rtc-board.h"
 
+#if( TIMER_TICK_64BIT != 1 )
+#error "The RP2040 RTC ticks are 64 bits, TIMER_TICK_64BIT must be set to 1"
+#endif
+
 static alarm_pool_t* rtc_alarm_pool = NULL;
 static absolute_time_t rtc_timer_context;
 static alarm_id_t last_rtc_alarm_id = -1;
@@ -36,27 +40,23 @@ void RtcBkupRead( uint32_t *data0, uint32_t *data1 )
     *data1 = 0;
 }
 
-uint32_t RtcGetTimerElapsedTime( void )
+TimerTick_t RtcGetTimerElapsedTime( void )
 {
     int64_t delta = absolute_time_diff_us(rtc_timer_context, get_absolute_time());
 
     return delta;
 }
 
-uint32_t RtcSetTimerContext( void )
+TimerTick_t RtcSetTimerContext( void )
 {
     rtc_timer_context = get_absolute_time();
 
-    uint64_t ticks = to_us_since_boot(rtc_timer_context);
-
-    return ticks;
+    return to_us_since_boot(rtc_timer_context);
 }
 
-uint32_t RtcGetTimerContext( void )
+TimerTick_t RtcGetTimerContext( void )
 {
-    uint64_t ticks = to_us_since_boot(rtc_timer_context);
-
-    return ticks;
+    return to_us_since_boot(rtc_timer_context);
 }
 
 uint32_t RtcGetMinimumTimeout( void )
@@ -70,7 +70,7 @@ static int64_t alarm_callback(alarm_id_t id, void *user_data) {
     return 0;
 }
 
-void RtcSetAlarm( uint32_t timeout )
+void RtcSetAlarm( TimerTick_t timeout )
 {
     if (last_rtc_alarm_id > -1) {
         alarm_pool_cancel_alarm(rtc_alarm_pool, last_rtc_alarm_id);
@@ -86,19 +86,17 @@ void RtcStopAlarm( void )
     }
 }
 
-uint32_t RtcMs2Tick( TimerTime_t milliseconds )
+TimerTick_t RtcMs2Tick( TimerTime_t milliseconds )
 {
-    return milliseconds * 1000;
+    return (TimerTick_t)milliseconds * 1000;
 }
 
-uint32_t RtcGetTimerValue( void )
+TimerTick_t RtcGetTimerValue( void )
 {
-    uint64_t now = to_us_since_boot(get_absolute_time());
-
-    return now;
+    return to_us_since_boot(get_absolute_time());
 }
 
-TimerTime_t RtcTick2Ms( uint32_t tick )
+TimerTime_t RtcTick2Ms( TimerTick_t tick )
 {
     return us_to_ms(tick);
 }
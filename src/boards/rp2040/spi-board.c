@@ -10,6 +10,82 @@
 
 #include "spi-board.h"
 
+/*!
+ * Set to 1 to run SpiTransferAsync transfers with DMA, otherwise they
+ * complete before returning
+ */
+#ifndef SPI_DMA_ENABLED
+#define SPI_DMA_ENABLED                             0
+#endif
+
+#if( SPI_DMA_ENABLED == 1 )
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+/*!
+ * DMA channels claimed by SpiInit. Only one SPI instance, the radio one,
+ * uses the DMA path.
+ */
+static int SpiDmaTxChannel = -1;
+static int SpiDmaRxChannel = -1;
+
+static volatile bool SpiDmaBusy = false;
+
+static SpiTransferCallback_t SpiDmaCallback;
+static void *SpiDmaContext;
+
+/*!
+ * Source of the bytes sent and sink of the bytes received when the caller
+ * provides no buffer
+ */
+static const uint8_t SpiDmaTxDummy = 0x00;
+static uint8_t SpiDmaRxDummy;
+
+static void SpiDmaIrqHandler( void )
+{
+    if( ( SpiDmaRxChannel < 0 ) || ( dma_channel_get_irq0_status( SpiDmaRxChannel ) == false ) )
+    {
+        return;
+    }
+    dma_channel_acknowledge_irq0( SpiDmaRxChannel );
+
+    // The receive channel completes last
+    SpiDmaBusy = false;
+
+    if( SpiDmaCallback != NULL )
+    {
+        SpiDmaCallback( SpiDmaContext );
+    }
+}
+
+static void SpiDmaInit( spi_inst_t *spi )
+{
+    if( SpiDmaRxChannel >= 0 )
+    {
+        return;
+    }
+
+    SpiDmaTxChannel = dma_claim_unused_channel(true);
+    SpiDmaRxChannel = dma_claim_unused_channel(true);
+
+    dma_channel_config config = dma_channel_get_default_config(SpiDmaTxChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_dreq(&config, spi_get_dreq(spi, true));
+    channel_config_set_write_increment(&config, false);
+    dma_channel_configure(SpiDmaTxChannel, &config, &spi_get_hw(spi)->dr, NULL, 0, false);
+
+    config = dma_channel_get_default_config(SpiDmaRxChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_dreq(&config, spi_get_dreq(spi, false));
+    channel_config_set_read_increment(&config, false);
+    dma_channel_configure(SpiDmaRxChannel, &config, NULL, &spi_get_hw(spi)->dr, 0, false);
+
+    dma_channel_set_irq0_enabled(SpiDmaRxChannel, true);
+    irq_add_shared_handler(DMA_IRQ_0, SpiDmaIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+#endif
+
 void SpiInit( Spi_t *obj, SpiId_t spiId, PinNames mosi, PinNames miso, PinNames sclk, PinNames nss )
 {
     obj->SpiId=spiId; //bnn
@@ -18,6 +94,10 @@ void SpiInit( Spi_t *obj, SpiId_t spiId, PinNames mosi, PinNames miso, PinNames
     gpio_set_function(mosi, GPIO_FUNC_SPI);
     gpio_set_function(miso, GPIO_FUNC_SPI);
     gpio_set_function(sclk, GPIO_FUNC_SPI);
+
+#if( SPI_DMA_ENABLED == 1 )
+    SpiDmaInit((spiId == 0) ? spi0 : spi1);
+#endif
 }
 
 uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
@@ -29,3 +109,76 @@ uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
 
     return inDataB;
 }
+
+void SpiTransfer( Spi_t *obj, const uint8_t *txData, uint8_t *rxData, uint16_t size )
+{
+    spi_inst_t *spi = (obj->SpiId == 0) ? spi0 : spi1;
+
+    if( txData == NULL )
+    {
+        spi_read_blocking(spi, 0x00, rxData, size);
+    }
+    else if( rxData == NULL )
+    {
+        spi_write_blocking(spi, txData, size);
+    }
+    else
+    {
+        spi_write_read_blocking(spi, txData, rxData, size);
+    }
+}
+
+bool SpiTransferAsync( Spi_t *obj, const uint8_t *txData, uint8_t *rxData, uint16_t size,
+                       SpiTransferCallback_t callback, void *context )
+{
+#if( SPI_DMA_ENABLED == 1 )
+    if( SpiDmaBusy == true )
+    {
+        return false;
+    }
+    if( size == 0 )
+    {
+        if( callback != NULL )
+        {
+            callback( context );
+        }
+        return true;
+    }
+
+    SpiDmaCallback = callback;
+    SpiDmaContext = context;
+    SpiDmaBusy = true;
+
+    dma_channel_config config = dma_get_channel_config(SpiDmaTxChannel);
+    channel_config_set_read_increment(&config, txData != NULL);
+    dma_channel_set_config(SpiDmaTxChannel, &config, false);
+    dma_channel_set_read_addr(SpiDmaTxChannel, (txData != NULL) ? txData : &SpiDmaTxDummy, false);
+    dma_channel_set_trans_count(SpiDmaTxChannel, size, false);
+
+    config = dma_get_channel_config(SpiDmaRxChannel);
+    channel_config_set_write_increment(&config, rxData != NULL);
+    dma_channel_set_config(SpiDmaRxChannel, &config, false);
+    dma_channel_set_write_addr(SpiDmaRxChannel, (rxData != NULL) ? rxData : &SpiDmaRxDummy, false);
+    dma_channel_set_trans_count(SpiDmaRxChannel, size, false);
+
+    // Both channels start together so that the receive FIFO never overflows
+    dma_start_channel_mask((1u << SpiDmaTxChannel) | (1u << SpiDmaRxChannel));
+#else
+    SpiTransfer( obj, txData, rxData, size );
+
+    if( callback != NULL )
+    {
+        callback( context );
+    }
+#endif
+    return true;
+}
+
+bool SpiIsTransferPending( Spi_t *obj )
+{
+#if( SPI_DMA_ENABLED == 1 )
+    return SpiDmaBusy;
+#else
+    return false;
+#endif
+}
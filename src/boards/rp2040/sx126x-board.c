@@ -24,10 +24,15 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <stdlib.h>
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
 #include "utilities.h"
 #include "pico/board-config.h"
 #include "board.h"
 #include "delay.h"
+#include "gpio-board.h"
+#include "rtc-board.h"
 #include "radio.h"
 #include "sx126x-board.h"
 
@@ -47,11 +52,26 @@ static void SX126xDbgPinTxWrite( uint8_t state );
 static void SX126xDbgPinRxWrite( uint8_t state );
 #endif
 
+/*!
+ * Maximum time the radio may keep the BUSY line high, covers a full
+ * calibration including the TCXO start
+ */
+#ifndef SX126X_BUSY_TIMEOUT_US
+#define SX126X_BUSY_TIMEOUT_US                      ( 20000 + ( BOARD_TCXO_WAKEUP_TIME * 1000 ) )
+#endif
+
 /*!
  * \brief Holds the internal operating mode of the radio
  */
 static RadioOperatingModes_t OperatingMode;
 
+/*!
+ * Opcode of the last command sent, the following BUSY time is accounted to it
+ */
+static uint8_t LastOpcode = RADIO_GET_STATUS;
+
+static SX126xBusyStats_t BusyStats;
+
 /*!
  * Antenna switch GPIO pins objects
  */
@@ -66,12 +86,23 @@ Gpio_t DbgPinTx;
 Gpio_t DbgPinRx;
 #endif
 
+/*!
+ * \brief BUSY falling edge interrupt, wakes up SX126xWaitOnBusy
+ */
+static void SX126xOnBusyIrq( void* context )
+{
+    __sev( );
+}
+
 void SX126xIoInit( void )
 {
     GpioInit( &SX126x.Spi.Nss, RADIO_NSS, PIN_OUTPUT, PIN_PUSH_PULL, PIN_NO_PULL, 1 );
     GpioInit( &SX126x.BUSY, RADIO_BUSY, PIN_INPUT, PIN_PUSH_PULL, PIN_NO_PULL, 0 );
     GpioInit( &SX126x.DIO1, RADIO_DIO_1, PIN_INPUT, PIN_PUSH_PULL, PIN_NO_PULL, 0 );
     // GpioInit( &DeviceSel, RADIO_DEVICE_SEL, PIN_INPUT, PIN_PUSH_PULL, PIN_NO_PULL, 0 );
+
+    // The end of a BUSY period is signalled as an event to the waiting core
+    GpioSetInterrupt( &SX126x.BUSY, IRQ_FALLING_EDGE, IRQ_VERY_HIGH_PRIORITY, SX126xOnBusyIrq );
 }
 
 void SX126xIoIrqInit( DioIrqHandler dioIrq )
@@ -79,6 +110,11 @@ void SX126xIoIrqInit( DioIrqHandler dioIrq )
     GpioSetInterrupt( &SX126x.DIO1, IRQ_RISING_EDGE, IRQ_HIGH_PRIORITY, dioIrq );
 }
 
+TimerTick_t SX126xGetDio1IrqTimestamp( void )
+{
+    return GpioMcuGetIrqTimestamp( &SX126x.DIO1 );
+}
+
 void SX126xIoDeInit( void )
 {
     GpioInit( &SX126x.Spi.Nss, RADIO_NSS, PIN_OUTPUT, PIN_PUSH_PULL, PIN_NO_PULL, 1 );
@@ -150,47 +186,154 @@ void SX126xReset( void )
     DelayMs( 10 );
 }
 
+/*!
+ * \brief Checks if the core may sleep until the BUSY interrupt
+ *
+ * \retval canSleep True in thread mode with the interrupts enabled
+ */
+static bool SX126xCanWaitForEvent( void )
+{
+    // Reads PRIMASK, the interrupts are enabled again right away
+    uint32_t primask = save_and_disable_interrupts( );
+
+    restore_interrupts( primask );
+
+    return ( __get_current_exception( ) == 0 ) && ( ( primask & 1 ) == 0 );
+}
+
+static void SX126xBusyStatsUpdate( uint8_t opcode, uint32_t time )
+{
+    SX126xBusyOpcodeStats_t *stats = NULL;
+    uint8_t bin = 0;
+
+    for( uint8_t i = 0; i < BusyStats.NbOpcodes; i++ )
+    {
+        if( BusyStats.Opcodes[i].Opcode == opcode )
+        {
+            stats = &BusyStats.Opcodes[i];
+            break;
+        }
+    }
+    if( stats == NULL )
+    {
+        if( BusyStats.NbOpcodes >= SX126X_BUSY_STATS_OPCODES )
+        {
+            return;
+        }
+        stats = &BusyStats.Opcodes[BusyStats.NbOpcodes++];
+        stats->Opcode = opcode;
+    }
+
+    for( uint32_t t = time >> 4; ( t != 0 ) && ( bin < ( SX126X_BUSY_STATS_BINS - 1 ) ); t >>= 2 )
+    {
+        bin++;
+    }
+    if( stats->Bins[bin] < UINT16_MAX )
+    {
+        stats->Bins[bin]++;
+    }
+    if( time > stats->MaxTime )
+    {
+        stats->MaxTime = time;
+    }
+}
+
+/*!
+ * \brief Accounts a BUSY wait given up on to the last opcode sent
+ */
+static void SX126xBusyTimeout( void )
+{
+    BusyStats.Timeouts++;
+    BusyStats.TimeoutOpcode = LastOpcode;
+}
+
 void SX126xWaitOnBusy( void )
 {
-    while( GpioRead( &SX126x.BUSY ) == 1 );
+    absolute_time_t deadline = make_timeout_time_us( SX126X_BUSY_TIMEOUT_US );
+
+    // A background buffer transfer keeps NSS asserted until it is done
+    while( SpiIsTransferPending( &SX126x.Spi ) == true )
+    {
+        if( absolute_time_diff_us( get_absolute_time( ), deadline ) <= 0 )
+        {
+            // The DMA is stalled, let the caller carry on
+            SX126xBusyTimeout( );
+            return;
+        }
+    }
+
+    if( GpioRead( &SX126x.BUSY ) == 0 )
+    {
+        return;
+    }
+
+    uint32_t start = time_us_32( );
+    bool canSleep = SX126xCanWaitForEvent( );
+
+    while( GpioRead( &SX126x.BUSY ) == 1 )
+    {
+        if( absolute_time_diff_us( get_absolute_time( ), deadline ) <= 0 )
+        {
+            // The radio is stalled, let the caller carry on
+            SX126xBusyTimeout( );
+            break;
+        }
+        if( canSleep == true )
+        {
+            // Woken up by the BUSY falling edge, the deadline is checked
+            // again on any other event
+            __wfe( );
+        }
+    }
+
+    SX126xBusyStatsUpdate( LastOpcode, time_us_32( ) - start );
+}
+
+const SX126xBusyStats_t* SX126xGetBusyStats( void )
+{
+    return &BusyStats;
 }
 
 void SX126xWakeup( void )
 {
+    uint8_t header[2] = { RADIO_GET_STATUS, 0x00 };
+
     CRITICAL_SECTION_BEGIN( );
 
+    LastOpcode = RADIO_GET_STATUS;
+
     GpioWrite( &SX126x.Spi.Nss, 0 );
 
-    SpiInOut( &SX126x.Spi, RADIO_GET_STATUS );
-    SpiInOut( &SX126x.Spi, 0x00 );
+    SpiTransfer( &SX126x.Spi, header, NULL, sizeof( header ) );
 
     GpioWrite( &SX126x.Spi.Nss, 1 );
 
-    // Wait for chip to be ready.
-    SX126xWaitOnBusy( );
-
-    // Update operating mode context variable
+    // Update operating mode context variable before the interrupts are
+    // enabled again, a command issued from an interrupt then only waits
     SX126xSetOperatingMode( MODE_STDBY_RC );
 
     CRITICAL_SECTION_END( );
+
+    // Wait for chip to be ready.
+    SX126xWaitOnBusy( );
 }
 
 void SX126xWriteCommand( RadioCommands_t command, uint8_t *buffer, uint16_t size )
 {
     SX126xCheckDeviceReady( );
 
+    LastOpcode = command;
+
     GpioWrite( &SX126x.Spi.Nss, 0 );
 
     SpiInOut( &SX126x.Spi, ( uint8_t )command );
-
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        SpiInOut( &SX126x.Spi, buffer[i] );
-    }
+    SpiTransfer( &SX126x.Spi, buffer, NULL, size );
 
     GpioWrite( &SX126x.Spi.Nss, 1 );
 
-    if( command != RADIO_SET_SLEEP )
+    // Clearing the IRQs leaves the radio state unchanged, the next command
+    // waits for the end of the BUSY period
+    if( ( command != RADIO_SET_SLEEP ) && ( command != RADIO_CLR_IRQSTATUS ) )
     {
         SX126xWaitOnBusy( );
     }
@@ -198,40 +341,37 @@ void SX126xWriteCommand( RadioCommands_t command, uint8_t *buffer, uint16_t size
 
 uint8_t SX126xReadCommand( RadioCommands_t command, uint8_t *buffer, uint16_t size )
 {
-    uint8_t status = 0;
+    uint8_t header[2] = { ( uint8_t )command, 0x00 };
+    uint8_t status[2];
 
     SX126xCheckDeviceReady( );
 
+    LastOpcode = command;
+
     GpioWrite( &SX126x.Spi.Nss, 0 );
 
-    SpiInOut( &SX126x.Spi, ( uint8_t )command );
-    status = SpiInOut( &SX126x.Spi, 0x00 );
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        buffer[i] = SpiInOut( &SX126x.Spi, 0 );
-    }
+    SpiTransfer( &SX126x.Spi, header, status, sizeof( header ) );
+    SpiTransfer( &SX126x.Spi, NULL, buffer, size );
 
     GpioWrite( &SX126x.Spi.Nss, 1 );
 
-    SX126xWaitOnBusy( );
-
-    return status;
+    // Reads leave the radio state unchanged, the next command waits for the
+    // end of the BUSY period
+    return status[1];
 }
 
 void SX126xWriteRegisters( uint16_t address, uint8_t *buffer, uint16_t size )
 {
+    uint8_t header[3] = { RADIO_WRITE_REGISTER, ( address & 0xFF00 ) >> 8, address & 0x00FF };
+
     SX126xCheckDeviceReady( );
 
+    LastOpcode = header[0];
+
     GpioWrite( &SX126x.Spi.Nss, 0 );
-    
-    SpiInOut( &SX126x.Spi, RADIO_WRITE_REGISTER );
-    SpiInOut( &SX126x.Spi, ( address & 0xFF00 ) >> 8 );
-    SpiInOut( &SX126x.Spi, address & 0x00FF );
-    
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        SpiInOut( &SX126x.Spi, buffer[i] );
-    }
+
+    SpiTransfer( &SX126x.Spi, header, NULL, sizeof( header ) );
+    SpiTransfer( &SX126x.Spi, buffer, NULL, size );
 
     GpioWrite( &SX126x.Spi.Nss, 1 );
 
@@ -245,21 +385,17 @@ void SX126xWriteRegister( uint16_t address, uint8_t value )
 
 void SX126xReadRegisters( uint16_t address, uint8_t *buffer, uint16_t size )
 {
+    uint8_t header[4] = { RADIO_READ_REGISTER, ( address & 0xFF00 ) >> 8, address & 0x00FF, 0x00 };
+
     SX126xCheckDeviceReady( );
 
+    LastOpcode = header[0];
+
     GpioWrite( &SX126x.Spi.Nss, 0 );
 
-    SpiInOut( &SX126x.Spi, RADIO_READ_REGISTER );
-    SpiInOut( &SX126x.Spi, ( address & 0xFF00 ) >> 8 );
-    SpiInOut( &SX126x.Spi, address & 0x00FF );
-    SpiInOut( &SX126x.Spi, 0 );
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        buffer[i] = SpiInOut( &SX126x.Spi, 0 );
-    }
+    SpiTransfer( &SX126x.Spi, header, NULL, sizeof( header ) );
+    SpiTransfer( &SX126x.Spi, NULL, buffer, size );
     GpioWrite( &SX126x.Spi.Nss, 1 );
-
-    SX126xWaitOnBusy( );
 }
 
 uint8_t SX126xReadRegister( uint16_t address )
@@ -271,16 +407,16 @@ uint8_t SX126xReadRegister( uint16_t address )
 
 void SX126xWriteBuffer( uint8_t offset, uint8_t *buffer, uint8_t size )
 {
+    uint8_t header[2] = { RADIO_WRITE_BUFFER, offset };
+
     SX126xCheckDeviceReady( );
 
+    LastOpcode = header[0];
+
     GpioWrite( &SX126x.Spi.Nss, 0 );
 
-    SpiInOut( &SX126x.Spi, RADIO_WRITE_BUFFER );
-    SpiInOut( &SX126x.Spi, offset );
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        SpiInOut( &SX126x.Spi, buffer[i] );
-    }
+    SpiTransfer( &SX126x.Spi, header, NULL, sizeof( header ) );
+    SpiTransfer( &SX126x.Spi, buffer, NULL, size );
     GpioWrite( &SX126x.Spi.Nss, 1 );
 
     SX126xWaitOnBusy( );
@@ -288,20 +424,52 @@ void SX126xWriteBuffer( uint8_t offset, uint8_t *buffer, uint8_t size )
 
 void SX126xReadBuffer( uint8_t offset, uint8_t *buffer, uint8_t size )
 {
+    uint8_t header[3] = { RADIO_READ_BUFFER, offset, 0x00 };
+
     SX126xCheckDeviceReady( );
 
+    LastOpcode = header[0];
+
     GpioWrite( &SX126x.Spi.Nss, 0 );
 
-    SpiInOut( &SX126x.Spi, RADIO_READ_BUFFER );
-    SpiInOut( &SX126x.Spi, offset );
-    SpiInOut( &SX126x.Spi, 0 );
-    for( uint16_t i = 0; i < size; i++ )
+    SpiTransfer( &SX126x.Spi, header, NULL, sizeof( header ) );
+    SpiTransfer( &SX126x.Spi, NULL, buffer, size );
+    GpioWrite( &SX126x.Spi.Nss, 1 );
+}
+
+/*!
+ * Callback of the background buffer read in progress
+ */
+static void ( *SX126xReadBufferCallback )( void );
+
+static void SX126xOnReadBufferDone( void *context )
+{
+    GpioWrite( &SX126x.Spi.Nss, 1 );
+
+    if( SX126xReadBufferCallback != NULL )
     {
-        buffer[i] = SpiInOut( &SX126x.Spi, 0 );
+        SX126xReadBufferCallback( );
     }
-    GpioWrite( &SX126x.Spi.Nss, 1 );
+}
 
-    SX126xWaitOnBusy( );
+void SX126xReadBufferAsync( uint8_t offset, uint8_t *buffer, uint8_t size, void ( *callback )( void ) )
+{
+    uint8_t header[3] = { RADIO_READ_BUFFER, offset, 0x00 };
+
+    SX126xCheckDeviceReady( );
+
+    SX126xReadBufferCallback = callback;
+    LastOpcode = header[0];
+
+    GpioWrite( &SX126x.Spi.Nss, 0 );
+
+    SpiTransfer( &SX126x.Spi, header, NULL, sizeof( header ) );
+    if( SpiTransferAsync( &SX126x.Spi, NULL, buffer, size, SX126xOnReadBufferDone, NULL ) == false )
+    {
+        // The DMA is still in use, read in the foreground
+        SpiTransfer( &SX126x.Spi, NULL, buffer, size );
+        SX126xOnReadBufferDone( NULL );
+    }
 }
 
 void SX126xSetRfTxPower( int8_t power )
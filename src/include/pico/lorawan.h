@@ -41,6 +41,48 @@ struct lorawan_otaa_settings {
     const char* channel_mask;
 };
 
+#define LORAWAN_TX_COALESCE 0x01
+#define LORAWAN_TX_CONFIRMED 0x02
+
+enum lorawan_tx_status {
+    LORAWAN_TX_SUCCESS = 0,
+    LORAWAN_TX_NO_ACK,
+    LORAWAN_TX_ERROR,
+    LORAWAN_TX_DROPPED,
+};
+
+struct lorawan_tx_result {
+    int handle;
+    enum lorawan_tx_status status;
+    LoRaMacEventInfoStatus_t mac_status;
+    bool confirmed;
+    bool ack_received;
+    uint8_t nb_trans;
+    int8_t datarate;
+    int8_t tx_power;
+    uint32_t time_on_air_ms;
+    uint32_t fcnt;
+};
+
+struct lorawan_aggregate_stats {
+    uint32_t frames;
+    uint32_t samples;
+    uint32_t payload_bytes;
+    uint32_t capacity_bytes;
+};
+
+typedef void (*lorawan_tx_callback_t)(const struct lorawan_tx_result* result);
+
+struct lorawan_downlink {
+    const uint8_t* data;
+    uint8_t data_len;
+    uint8_t app_port;
+    int16_t rssi;
+    int8_t snr;
+    int8_t rx_slot;
+    uint32_t fcnt;
+};
+
 const char* lorawan_default_dev_eui(char* dev_eui);
 
 int lorawan_init_abp(const struct lorawan_sx12xx_settings* sx1276_settings, LoRaMacRegion_t region, const struct lorawan_abp_settings* abp_settings);
@@ -53,12 +95,42 @@ int lorawan_is_joined();
 
 int lorawan_process();
 
+uint64_t lorawan_next_wakeup_us();
+
 int lorawan_process_timeout_ms(uint32_t timeout_ms);
 
 int lorawan_send_unconfirmed(const void* data, uint8_t data_len, uint8_t app_port);
 
+int lorawan_send_confirmed(const void* data, uint8_t data_len, uint8_t app_port);
+
+int lorawan_send_unconfirmed_async(const void* data, uint8_t data_len, uint8_t app_port);
+
+int lorawan_send_confirmed_async(const void* data, uint8_t data_len, uint8_t app_port);
+
+void lorawan_set_tx_callback(lorawan_tx_callback_t callback);
+
+int lorawan_send_queued(const void* data, uint8_t data_len, uint8_t app_port, uint8_t priority, uint8_t flags);
+
+int lorawan_send_queue_pending();
+
+void lorawan_send_queue_stats(uint32_t* sent, uint32_t* coalesced, uint32_t* dropped);
+
+int lorawan_aggregate_init(uint8_t app_port, uint32_t max_latency_ms);
+
+int lorawan_aggregate_add(const void* sample, uint8_t sample_len);
+
+int lorawan_aggregate_flush();
+
+void lorawan_aggregate_get_stats(struct lorawan_aggregate_stats* stats);
+
 int lorawan_receive(void* data, uint8_t data_len, uint8_t* app_port);
 
+int lorawan_receive_peek(struct lorawan_downlink* downlink);
+
+void lorawan_receive_release();
+
+void lorawan_receive_stats(uint32_t* received, uint32_t* dropped);
+
 void lorawan_debug(bool debug);
 
 #endif
@@ -27,7 +27,11 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+
 #include "pico/lorawan.h"
+#include "spsc_queue.h"
 
 #include "board.h"
 #include "rtc-board.h"
@@ -48,7 +52,17 @@
 /*!
  * LoRaWAN default end-device class
  */
+#ifndef LORAWAN_DEFAULT_CLASS
 #define LORAWAN_DEFAULT_CLASS                       CLASS_A
+#endif
+
+/*!
+ * Set to 1 for class C to listen with the radio reception duty cycle instead
+ * of a continuous reception
+ */
+#ifndef LORAWAN_CLASS_C_SNIFF
+#define LORAWAN_CLASS_C_SNIFF                       0
+#endif
 
 /*!
  * LoRaWAN Adaptive Data Rate
@@ -74,6 +88,60 @@
  */
 #define LORAWAN_APP_DATA_BUFFER_MAX_SIZE            242
 
+/*!
+ * Highest application port, the ports above are reserved by the LoRaWAN
+ * specification
+ */
+#define LORAWAN_APP_PORT_MAX                        223
+
+/*!
+ * Number of received downlinks that can be held until the application reads
+ * them with lorawan_receive() or lorawan_receive_peek()
+ *
+ * \remark Must be a power of 2
+ */
+#ifndef LORAWAN_RX_QUEUE_SIZE
+#define LORAWAN_RX_QUEUE_SIZE                       4
+#endif
+
+#if( ( LORAWAN_RX_QUEUE_SIZE & ( LORAWAN_RX_QUEUE_SIZE - 1 ) ) != 0 )
+#error "LORAWAN_RX_QUEUE_SIZE must be a power of 2"
+#endif
+
+/*!
+ * Number of uplinks that can wait in the transmit queue for the MAC to become
+ * available
+ */
+#ifndef LORAWAN_TX_QUEUE_SIZE
+#define LORAWAN_TX_QUEUE_SIZE                       4
+#endif
+
+/*!
+ * Set to 1 to run the LoRaMac stack on core1, the application on core0 then
+ * talks to it through lock free command and event queues
+ */
+#ifndef LORAWAN_MULTICORE
+#define LORAWAN_MULTICORE                           0
+#endif
+
+/*!
+ * Number of application requests waiting for core1
+ *
+ * \remark Must be a power of 2
+ */
+#ifndef LORAWAN_COMMAND_QUEUE_SIZE
+#define LORAWAN_COMMAND_QUEUE_SIZE                  4
+#endif
+
+/*!
+ * Number of uplink outcomes waiting for core0
+ *
+ * \remark Must be a power of 2
+ */
+#ifndef LORAWAN_EVENT_QUEUE_SIZE
+#define LORAWAN_EVENT_QUEUE_SIZE                    8
+#endif
+
 /*!
  * LoRaWAN ETSI duty cycle control enable/disable
  *
@@ -101,17 +169,6 @@ static LmHandlerAppData_t AppData =
     .Port = 0,
 };
 
-void showBuffer(const char *buff,uint8_t bufLen)
-{
-    printf( "showBuffer : %02X", buff[0] );
-    for( int i = 1; i < bufLen; i++ )
-    {
-        printf( "-%02X", buff[i] );
-    }
-    printf( "\n" );
-   
-}
-
 static void OnMacProcessNotify( void );
 static void OnNvmDataChange( LmHandlerNvmContextStates_t state, uint16_t size );
 static void OnNetworkParametersChange( CommissioningParams_t* params );
@@ -176,7 +233,13 @@ static LmhpComplianceParams_t LmhpComplianceParams =
  * 
  * \warning If variable is equal to 0 then the MCU can be set in low power mode
  */
-static volatile uint8_t IsMacProcessPending = 0;
+static volatile uint8_t IsMacProcessPending = 1;
+
+/*!
+ * Network activation state, refreshed whenever the LoRaMac events are
+ * processed
+ */
+static volatile bool IsJoined = false;
 
 static volatile uint32_t TxPeriodicity = 0;
 
@@ -184,17 +247,191 @@ static const struct lorawan_abp_settings* AbpSettings = NULL;
 
 static const struct lorawan_otaa_settings* OtaaSettings = NULL;
 
-static uint8_t AppRxDataBuffer[LORAWAN_APP_DATA_BUFFER_MAX_SIZE];
+/*!
+ * Received downlink slot
+ */
+typedef struct AppRxSlot_s
+{
+    uint8_t Buffer[LORAWAN_APP_DATA_BUFFER_MAX_SIZE];
+    uint8_t BufferSize;
+    uint8_t Port;
+    int16_t Rssi;
+    int8_t Snr;
+    int8_t RxSlot;
+    uint32_t DownlinkCounter;
+}AppRxSlot_t;
 
-static LmHandlerAppData_t AppRxData =
+/*!
+ * Single producer (OnRxData) / single consumer (lorawan_receive*) queue of
+ * received downlinks
+ */
+static struct
 {
-    .Buffer = AppRxDataBuffer,
-    .BufferSize = 0,
-    .Port = 0,
-};
+    AppRxSlot_t Slots[LORAWAN_RX_QUEUE_SIZE];
+    struct spsc_queue Queue;
+    volatile uint32_t Received;
+    volatile uint32_t Dropped;
+}AppRxQueue;
+
+/*!
+ * Queued uplink
+ */
+typedef struct AppTxSlot_s
+{
+    uint8_t Buffer[LORAWAN_APP_DATA_BUFFER_MAX_SIZE];
+    uint8_t BufferSize;
+    uint8_t Port;
+    uint8_t Priority;
+    uint8_t Flags;
+    bool InUse;
+    uint32_t Sequence;
+    int Handle;
+}AppTxSlot_t;
+
+/*!
+ * Uplink transmit queue, drained by lorawan_process() once the MAC is idle
+ * and the duty cycle allows a new transmission.
+ */
+static struct
+{
+    AppTxSlot_t Slots[LORAWAN_TX_QUEUE_SIZE];
+    uint8_t Count;
+    uint32_t Sequence;
+    absolute_time_t NextAttempt;
+    uint32_t Sent;
+    uint32_t Coalesced;
+    uint32_t Dropped;
+}AppTxQueue;
+
+/*!
+ * Uplink handed to the MAC by the application whose McpsConfirm is awaited
+ */
+static struct
+{
+    bool Active;
+    bool Confirmed;
+    int Handle;
+}AppTxInFlight;
+
+/*!
+ * Last handle returned by the asynchronous send functions
+ */
+static int AppTxHandle = 0;
+
+/*!
+ * Application uplink completion callback
+ */
+static lorawan_tx_callback_t AppTxCallback = NULL;
+
+/*!
+ * Status of the last request handed to the MAC by LmHandlerSend
+ */
+static LoRaMacStatus_t AppMcpsRequestStatus = LORAMAC_STATUS_OK;
+
+/*!
+ * Pending frame collecting small application samples
+ */
+static struct
+{
+    uint8_t Buffer[LORAWAN_APP_DATA_BUFFER_MAX_SIZE];
+    uint8_t BufferSize;
+    uint8_t Port;
+    uint8_t Samples;
+    uint32_t MaxLatencyMs;
+    absolute_time_t Deadline;
+    struct lorawan_aggregate_stats Stats;
+}AppAggregate;
 
 static bool Debug = false;
 
+#if (LORAWAN_MULTICORE == 1)
+typedef enum eAppCommandType
+{
+    APP_COMMAND_JOIN,
+    APP_COMMAND_SEND,
+    APP_COMMAND_AGGREGATE_INIT,
+    APP_COMMAND_AGGREGATE_ADD,
+    APP_COMMAND_AGGREGATE_FLUSH,
+}AppCommandType_t;
+
+/*!
+ * Application request handed from core0 to core1
+ */
+typedef struct AppCommand_s
+{
+    AppCommandType_t Type;
+    uint8_t Buffer[LORAWAN_APP_DATA_BUFFER_MAX_SIZE];
+    uint8_t BufferSize;
+    uint8_t Port;
+    uint8_t Priority;
+    uint8_t Flags;
+    int Handle;
+    uint32_t MaxLatencyMs;
+}AppCommand_t;
+
+static AppCommand_t AppCommandSlots[LORAWAN_COMMAND_QUEUE_SIZE];
+
+static struct spsc_queue AppCommands;
+
+/*!
+ * Uplink outcomes handed from core1 to core0
+ */
+static struct lorawan_tx_result AppEventSlots[LORAWAN_EVENT_QUEUE_SIZE];
+
+static struct spsc_queue AppEvents;
+
+/*!
+ * Handles are allocated by both cores
+ */
+static spin_lock_t* AppTxHandleLock = NULL;
+
+/*!
+ * Set by core1 once the LoRaMac stack runs on it
+ */
+static volatile bool Core1Running = false;
+
+/*!
+ * Set by core1 once lorawan_init returned Core1Status, the FIFO between the
+ * cores is left to the flash lockout
+ */
+static volatile bool Core1Started = false;
+
+static volatile int Core1Status = 0;
+
+static const struct lorawan_sx12xx_settings* Core1Settings = NULL;
+
+static LoRaMacRegion_t Core1Region;
+
+static void lorawan_core1_entry();
+
+/*!
+ * True when the caller must hand its request over to core1
+ */
+static bool lorawan_is_remote()
+{
+    return Core1Running && (get_core_num() == 0);
+}
+
+static AppCommand_t* lorawan_command_acquire(AppCommandType_t type)
+{
+    AppCommand_t* command = spsc_queue_write_acquire(&AppCommands);
+
+    if (command != NULL) {
+        command->Type = type;
+    }
+
+    return command;
+}
+
+static void lorawan_command_commit()
+{
+    spsc_queue_write_commit(&AppCommands);
+
+    // Wake up core1 if it waits for an event
+    __sev();
+}
+#endif
+
 const char* lorawan_default_dev_eui(char* dev_eui)
 {
     printf("200 lorawan.c default_dev_eui\n");
@@ -273,19 +510,67 @@ static int lorawan_init(const struct lorawan_sx12xx_settings* sx12xx_settings, L
     // Set system maximum tolerated rx error in milliseconds
     LmHandlerSetSystemMaxRxError( 20 );
 
+#if( LORAWAN_CLASS_C_SNIFF == 1 )
+    MibRequestConfirm_t mibReq;
+
+    mibReq.Type = MIB_RXC_SNIFF;
+    mibReq.Param.RxCSniff = true;
+    LoRaMacMibSetRequestConfirm( &mibReq );
+#endif
+
     // The LoRa-Alliance Compliance protocol package should always be
     // initialized and activated.
     LmHandlerPackageRegister( PACKAGE_ID_COMPLIANCE, &LmhpComplianceParams );
 
+    IsJoined = (LmHandlerJoinStatus() == LORAMAC_HANDLER_SET);
+
     return 0;
 }
 
+/*!
+ * Initializes the LoRaMac stack on the calling core, or on core1 when
+ * LORAWAN_MULTICORE is set
+ */
+static int lorawan_start(const struct lorawan_sx12xx_settings* sx12xx_settings, LoRaMacRegion_t region)
+{
+    spsc_queue_init(&AppRxQueue.Queue, AppRxQueue.Slots, sizeof(AppRxSlot_t), LORAWAN_RX_QUEUE_SIZE);
+
+#if (LORAWAN_MULTICORE == 1)
+    spsc_queue_init(&AppCommands, AppCommandSlots, sizeof(AppCommand_t), LORAWAN_COMMAND_QUEUE_SIZE);
+    spsc_queue_init(&AppEvents, AppEventSlots, sizeof(struct lorawan_tx_result), LORAWAN_EVENT_QUEUE_SIZE);
+
+    if (AppTxHandleLock == NULL) {
+        AppTxHandleLock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+
+    Core1Settings = sx12xx_settings;
+    Core1Region = region;
+    Core1Running = false;
+    Core1Started = false;
+
+    // Core1 pauses core0, which runs from the flash, while storing the session
+    multicore_lockout_victim_init();
+
+    // The radio and timer interrupts are served by the core initializing them
+    multicore_reset_core1();
+    multicore_launch_core1(lorawan_core1_entry);
+
+    while (!Core1Started) {
+        __wfe();
+    }
+
+    return Core1Status;
+#else
+    return lorawan_init(sx12xx_settings, region);
+#endif
+}
+
 int lorawan_init_abp(const struct lorawan_sx12xx_settings* sx12xx_settings, LoRaMacRegion_t region, const struct lorawan_abp_settings* abp_settings)
 {
     AbpSettings = abp_settings;
     OtaaSettings = NULL;
 
-    return lorawan_init(sx12xx_settings, region);
+    return lorawan_start(sx12xx_settings, region);
 }
 
 int lorawan_init_otaa(const struct lorawan_sx12xx_settings* sx12xx_settings, LoRaMacRegion_t region, const struct lorawan_otaa_settings* otaa_settings)
@@ -293,102 +578,862 @@ int lorawan_init_otaa(const struct lorawan_sx12xx_settings* sx12xx_settings, LoR
     AbpSettings = NULL;
     OtaaSettings = otaa_settings;
 
-    return lorawan_init(sx12xx_settings, region);
+    return lorawan_start(sx12xx_settings, region);
 }
 
 int lorawan_join()
 {
+#if (LORAWAN_MULTICORE == 1)
+    if (lorawan_is_remote()) {
+        if (lorawan_command_acquire(APP_COMMAND_JOIN) == NULL) {
+            return -1;
+        }
+        lorawan_command_commit();
+
+        return 0;
+    }
+#endif
+
     LmHandlerJoin( );
 
+    // ABP activation completes immediately
+    IsJoined = (LmHandlerJoinStatus() == LORAMAC_HANDLER_SET);
+
     return 0;
 }
 
 int lorawan_is_joined()
 {
-    return (LmHandlerJoinStatus() == LORAMAC_HANDLER_SET);
+    return IsJoined;
+}
+
+/*!
+ * Selects the queued uplink to be sent next: highest priority first, oldest
+ * first within the same priority.
+ */
+static AppTxSlot_t* lorawan_tx_queue_head()
+{
+    AppTxSlot_t* head = NULL;
+
+    for (int i = 0; i < LORAWAN_TX_QUEUE_SIZE; i++) {
+        AppTxSlot_t* slot = &AppTxQueue.Slots[i];
+
+        if (!slot->InUse) {
+            continue;
+        }
+
+        if ((head == NULL) ||
+            (slot->Priority > head->Priority) ||
+            ((slot->Priority == head->Priority) && ((int32_t)(slot->Sequence - head->Sequence) < 0))) {
+            head = slot;
+        }
+    }
+
+    return head;
 }
 
+static void lorawan_tx_queue_remove(AppTxSlot_t* slot)
+{
+    slot->InUse = false;
+    AppTxQueue.Count--;
+}
+
+/*!
+ * Reports the outcome of an application uplink, on core0 when the LoRaMac
+ * stack runs on core1
+ */
+static void lorawan_tx_report(const struct lorawan_tx_result* result)
+{
+#if (LORAWAN_MULTICORE == 1)
+    if (Core1Running) {
+        // Lost if core0 does not keep up, core1 never waits for it
+        spsc_queue_push(&AppEvents, result);
+        return;
+    }
+#endif
+
+    if (AppTxCallback != NULL) {
+        AppTxCallback(result);
+    }
+}
+
+/*!
+ * Reports a queued uplink that will never be sent to the application, either
+ * LORAWAN_TX_DROPPED or LORAWAN_TX_ERROR when the MAC refused it
+ */
+static void lorawan_tx_report_dropped(int handle, uint8_t flags, enum lorawan_tx_status status)
+{
+    struct lorawan_tx_result result = {
+        .handle = handle,
+        .status = status,
+        .mac_status = LORAMAC_EVENT_INFO_STATUS_ERROR,
+        .confirmed = (flags & LORAWAN_TX_CONFIRMED) != 0,
+    };
+
+    lorawan_tx_report(&result);
+}
+
+static void lorawan_tx_queue_drop(AppTxSlot_t* slot, enum lorawan_tx_status status)
+{
+    AppTxQueue.Dropped++;
+    lorawan_tx_queue_remove(slot);
+    lorawan_tx_report_dropped(slot->Handle, slot->Flags, status);
+}
+
+/*!
+ * True when the MAC may accept the same uplink later on
+ */
+static bool lorawan_tx_is_retryable(LoRaMacStatus_t status)
+{
+    switch (status) {
+        case LORAMAC_STATUS_BUSY:
+        case LORAMAC_STATUS_NO_NETWORK_JOINED:
+        case LORAMAC_STATUS_DUTYCYCLE_RESTRICTED:
+        case LORAMAC_STATUS_NO_CHANNEL_FOUND:
+        case LORAMAC_STATUS_NO_FREE_CHANNEL_FOUND:
+        case LORAMAC_STATUS_BUSY_BEACON_RESERVED_TIME:
+        case LORAMAC_STATUS_BUSY_PING_SLOT_WINDOW_TIME:
+        case LORAMAC_STATUS_BUSY_UPLINK_COLLISION:
+        case LORAMAC_STATUS_CONFIRM_QUEUE_ERROR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static int lorawan_tx_next_handle()
+{
+    int handle;
+#if (LORAWAN_MULTICORE == 1)
+    uint32_t save = spin_lock_blocking(AppTxHandleLock);
+#endif
+
+    if (++AppTxHandle <= 0) {
+        AppTxHandle = 1;
+    }
+    handle = AppTxHandle;
+
+#if (LORAWAN_MULTICORE == 1)
+    spin_unlock(AppTxHandleLock, save);
+#endif
+
+    return handle;
+}
+
+/*!
+ * Hands the next queued uplink to the MAC if it is able to accept it
+ */
+static void lorawan_tx_queue_process()
+{
+    if (AppTxQueue.Count == 0) {
+        return;
+    }
+
+    if (absolute_time_diff_us(get_absolute_time(), AppTxQueue.NextAttempt) > 0) {
+        // Still restricted by the duty cycle
+        return;
+    }
+
+    if (LoRaMacIsBusy() || !lorawan_is_joined()) {
+        return;
+    }
+
+    AppTxSlot_t* slot = lorawan_tx_queue_head();
+    bool confirmed = (slot->Flags & LORAWAN_TX_CONFIRMED) != 0;
+    LoRaMacTxInfo_t txInfo;
+    bool fits = (LoRaMacQueryTxPossible(slot->BufferSize, &txInfo) == LORAMAC_STATUS_OK);
+
+    LmHandlerAppData_t appData =
+    {
+        .Buffer = slot->Buffer,
+        .BufferSize = slot->BufferSize,
+        .Port = slot->Port,
+    };
+
+    // LmHandlerSend only reaches the MAC once joined
+    AppMcpsRequestStatus = LORAMAC_STATUS_NO_NETWORK_JOINED;
+
+    // When the payload does not fit alongside the pending MAC commands
+    // LmHandlerSend sends an empty frame to flush them instead.
+    if (LmHandlerSend(&appData, confirmed ? LORAMAC_HANDLER_CONFIRMED_MSG : LORAMAC_HANDLER_UNCONFIRMED_MSG) != LORAMAC_HANDLER_SUCCESS) {
+        TimerTime_t dutyCycleWaitTime = LmHandlerGetDutyCycleWaitTime();
+
+        if (!lorawan_tx_is_retryable(AppMcpsRequestStatus)) {
+            // Would block every uplink queued behind it
+            lorawan_tx_queue_drop(slot, LORAWAN_TX_ERROR);
+        } else if (dutyCycleWaitTime > 0) {
+            AppTxQueue.NextAttempt = make_timeout_time_ms(dutyCycleWaitTime);
+        }
+        return;
+    }
+
+    if (fits) {
+        AppTxInFlight.Active = true;
+        AppTxInFlight.Confirmed = confirmed;
+        AppTxInFlight.Handle = slot->Handle;
+
+        AppTxQueue.Sent++;
+        lorawan_tx_queue_remove(slot);
+    } else if (slot->BufferSize > txInfo.CurrentPossiblePayloadSize) {
+        // Can never be sent at the current datarate
+        lorawan_tx_queue_drop(slot, LORAWAN_TX_DROPPED);
+    }
+}
+
+#if (LORAWAN_MULTICORE == 1)
+/*!
+ * Delivers the uplink outcomes reported by core1
+ */
+static int lorawan_events_process()
+{
+    struct lorawan_tx_result result;
+
+    while (spsc_queue_pop(&AppEvents, &result)) {
+        if (AppTxCallback != NULL) {
+            AppTxCallback(&result);
+        }
+    }
+
+    // The LoRaMac events are processed by core1
+    return 1;
+}
+#endif
+
 int lorawan_process()
 {
     int sleep = 0;
+    uint8_t isMacProcessPending;
 
-    // Processes the LoRaMac events
-    LmHandlerProcess( );
+#if (LORAWAN_MULTICORE == 1)
+    if (lorawan_is_remote()) {
+        return lorawan_events_process();
+    }
+#endif
 
+    // Consume the flag before processing so that events signalled while
+    // processing are handled by the next call
     CRITICAL_SECTION_BEGIN( );
-    if( IsMacProcessPending == 1 )
+    isMacProcessPending = IsMacProcessPending;
+    IsMacProcessPending = 0;
+    CRITICAL_SECTION_END( );
+
+    if( ( isMacProcessPending == 1 ) || LmHandlerIsProcessPending( ) )
     {
-        // Clear flag and prevent MCU to go into low power modes.
-        IsMacProcessPending = 0;
+        // Processes the LoRaMac events
+        LmHandlerProcess( );
+
+        IsJoined = (LmHandlerJoinStatus() == LORAMAC_HANDLER_SET);
     }
-    else
+
+    // Flush samples that have waited for their maximum latency
+    if ((AppAggregate.BufferSize > 0) && (absolute_time_diff_us(get_absolute_time(), AppAggregate.Deadline) <= 0)) {
+        lorawan_aggregate_flush();
+    }
+
+    // Hand queued uplinks to the MAC
+    lorawan_tx_queue_process();
+
+    // Print the logged events outside of the radio timing critical paths
+    if (Debug && !LoRaMacIsBusy()) {
+        DisplayProcess();
+    }
+
+    if( ( IsMacProcessPending == 0 ) && !LmHandlerIsProcessPending( ) )
     {
         // The MCU wakes up through events
         sleep = 1;
     }
-    CRITICAL_SECTION_END( );
 
     return sleep;
 }
 
+uint64_t lorawan_next_wakeup_us()
+{
+    uint64_t now = to_us_since_boot(get_absolute_time());
+    uint64_t wakeup = UINT64_MAX;
+    TimerTick_t ticks;
+
+#if (LORAWAN_MULTICORE == 1)
+    if (lorawan_is_remote()) {
+        return (spsc_queue_count(&AppEvents) > 0) ? now : UINT64_MAX;
+    }
+#endif
+
+    if ((IsMacProcessPending == 1) || LmHandlerIsProcessPending()) {
+        return now;
+    }
+
+    // RTC ticks are microseconds on this platform
+    if (TimerGetNextExpiry(&ticks)) {
+        wakeup = now + ticks;
+    }
+
+    if (AppTxQueue.Count > 0) {
+        uint64_t nextAttempt = to_us_since_boot(AppTxQueue.NextAttempt);
+
+        // Only a duty cycle hold off is a deadline, a busy MAC signals when done
+        if ((nextAttempt > now) && (nextAttempt < wakeup)) {
+            wakeup = nextAttempt;
+        }
+    }
+
+    // The pending samples are queued with the lowest priority, a full queue
+    // only accepts them once an uplink completes, which the MAC signals
+    if ((AppAggregate.BufferSize > 0) && (AppTxQueue.Count < LORAWAN_TX_QUEUE_SIZE)) {
+        uint64_t deadline = to_us_since_boot(AppAggregate.Deadline);
+
+        if (deadline < wakeup) {
+            wakeup = (deadline > now) ? deadline : now;
+        }
+    }
+
+    return wakeup;
+}
+
+static int64_t lorawan_wakeup_alarm(alarm_id_t id, void *user_data)
+{
+    // Only wakes up the core
+    return 0;
+}
+
 int lorawan_process_timeout_ms(uint32_t timeout_ms)
 {
     absolute_time_t timeout_time = make_timeout_time_ms(timeout_ms);
+    absolute_time_t wait_time;
 
     bool joined = lorawan_is_joined();
+
+#if (LORAWAN_MULTICORE == 1)
+    if (lorawan_is_remote()) {
+        do {
+            lorawan_process();
+
+            if (spsc_queue_count(&AppRxQueue.Queue) > 0) {
+                return 0;
+            } else if (joined != lorawan_is_joined()) {
+                return 0;
+            }
+        // Core1 signals new downlinks, uplink outcomes and activations
+        } while (!best_effort_wfe_or_timeout(timeout_time));
+
+        return 1; // timed out
+    }
+#endif
     
     do {
         lorawan_process();
 
-        if (AppRxData.Port) {
+        if (spsc_queue_count(&AppRxQueue.Queue) > 0) {
             return 0;
         } else if (joined != lorawan_is_joined()) {
             return 0;
         }
-    } while (!best_effort_wfe_or_timeout(timeout_time));
+
+        // Sleep until the next deadline, any interrupt wakes up earlier
+        uint64_t wakeup = lorawan_next_wakeup_us();
+
+        if (wakeup < to_us_since_boot(timeout_time)) {
+            update_us_since_boot(&wait_time, wakeup);
+        } else {
+            wait_time = timeout_time;
+        }
+
+        // The low power manager picks the sleep depth from the timer list
+        // and the radio state, no alarm is set if the deadline has passed
+        alarm_id_t alarm = add_alarm_at(wait_time, lorawan_wakeup_alarm, NULL, false);
+
+        if (alarm > 0) {
+            // An interrupt served since the deadline was computed may have
+            // signalled new work, __wfi would then sleep until the alarm.
+            // Checked again with the interrupts disabled, a later interrupt
+            // stays pending and wakes the core up at once.
+            CRITICAL_SECTION_BEGIN( );
+            if (lorawan_next_wakeup_us() > to_us_since_boot(get_absolute_time())) {
+                BoardLowPowerHandler();
+            }
+            CRITICAL_SECTION_END( );
+
+            cancel_alarm(alarm);
+        }
+    } while (absolute_time_diff_us(get_absolute_time(), timeout_time) > 0);
     
     return 1; // timed out
 }
 
-int lorawan_send_unconfirmed(const void* data, uint8_t data_len, uint8_t app_port)
+static int lorawan_send(const void* data, uint8_t data_len, uint8_t app_port, LmHandlerMsgTypes_t msgType)
 {
     LmHandlerAppData_t appData;
+    LoRaMacTxInfo_t txInfo;
+
+#if (LORAWAN_MULTICORE == 1)
+    if (lorawan_is_remote()) {
+        // Queued for core1, the outcome is only reported through the callback
+        uint8_t flags = (msgType == LORAMAC_HANDLER_CONFIRMED_MSG) ? LORAWAN_TX_CONFIRMED : 0;
+
+        return (lorawan_send_queued(data, data_len, app_port, 0, flags) < 0) ? -1 : 0;
+    }
+#endif
+
+    if ((app_port == 0) || (app_port > LORAWAN_APP_PORT_MAX)) {
+        return -1;
+    }
 
     appData.Port = app_port;
     appData.BufferSize = data_len;
     appData.Buffer = (uint8_t*)data;
 
-    if (LmHandlerSend(&appData, LORAMAC_HANDLER_UNCONFIRMED_MSG) != LORAMAC_HANDLER_SUCCESS) {
+    bool fits = (LoRaMacQueryTxPossible(data_len, &txInfo) == LORAMAC_STATUS_OK);
+
+    if (LmHandlerSend(&appData, msgType) != LORAMAC_HANDLER_SUCCESS) {
+        return -1;
+    }
+
+    if (!fits) {
+        // Only an empty frame flushing the pending MAC commands was sent
+        return -1;
+    }
+
+    AppTxInFlight.Active = true;
+    AppTxInFlight.Confirmed = (msgType == LORAMAC_HANDLER_CONFIRMED_MSG);
+    AppTxInFlight.Handle = 0;
+
+    return 0;
+}
+
+int lorawan_send_unconfirmed(const void* data, uint8_t data_len, uint8_t app_port)
+{
+    return lorawan_send(data, data_len, app_port, LORAMAC_HANDLER_UNCONFIRMED_MSG);
+}
+
+int lorawan_send_confirmed(const void* data, uint8_t data_len, uint8_t app_port)
+{
+    return lorawan_send(data, data_len, app_port, LORAMAC_HANDLER_CONFIRMED_MSG);
+}
+
+int lorawan_send_unconfirmed_async(const void* data, uint8_t data_len, uint8_t app_port)
+{
+    return lorawan_send_queued(data, data_len, app_port, 0, 0);
+}
+
+int lorawan_send_confirmed_async(const void* data, uint8_t data_len, uint8_t app_port)
+{
+    return lorawan_send_queued(data, data_len, app_port, 0, LORAWAN_TX_CONFIRMED);
+}
+
+void lorawan_set_tx_callback(lorawan_tx_callback_t callback)
+{
+    AppTxCallback = callback;
+}
+
+/*!
+ * Adds an uplink to the transmit queue, a handle is allocated when handle is 0
+ */
+static int lorawan_tx_queue_add(const void* data, uint8_t data_len, uint8_t app_port, uint8_t priority, uint8_t flags, int handle)
+{
+    AppTxSlot_t* slot = NULL;
+    AppTxSlot_t* lowest = NULL;
+    uint32_t sequence = AppTxQueue.Sequence;
+    int droppedHandle = 0;
+    uint8_t droppedFlags = 0;
+
+    for (int i = 0; i < LORAWAN_TX_QUEUE_SIZE; i++) {
+        AppTxSlot_t* candidate = &AppTxQueue.Slots[i];
+
+        if (!candidate->InUse) {
+            if (slot == NULL) {
+                slot = candidate;
+            }
+            continue;
+        }
+
+        if ((flags & LORAWAN_TX_COALESCE) && (candidate->Flags & LORAWAN_TX_COALESCE) && (candidate->Port == app_port)) {
+            // Latest value wins, the superseded message keeps its place in the queue
+            if (priority < candidate->Priority) {
+                priority = candidate->Priority;
+            }
+            sequence = candidate->Sequence;
+
+            AppTxQueue.Coalesced++;
+            droppedHandle = candidate->Handle;
+            droppedFlags = candidate->Flags;
+            lorawan_tx_queue_remove(candidate);
+
+            slot = candidate;
+            break;
+        }
+
+        // Newest of the lowest priority messages is the eviction candidate
+        if ((lowest == NULL) ||
+            (candidate->Priority < lowest->Priority) ||
+            ((candidate->Priority == lowest->Priority) && ((int32_t)(candidate->Sequence - lowest->Sequence) > 0))) {
+            lowest = candidate;
+        }
+    }
+
+    if (slot == NULL) {
+        if (priority <= lowest->Priority) {
+            AppTxQueue.Dropped++;
+            return -1;
+        }
+
+        // Make room by dropping a lower priority message
+        AppTxQueue.Dropped++;
+        droppedHandle = lowest->Handle;
+        droppedFlags = lowest->Flags;
+        lorawan_tx_queue_remove(lowest);
+        slot = lowest;
+    }
+
+    if (sequence == AppTxQueue.Sequence) {
+        AppTxQueue.Sequence++;
+    }
+
+    if (handle == 0) {
+        handle = lorawan_tx_next_handle();
+    }
+
+    memcpy(slot->Buffer, data, data_len);
+    slot->BufferSize = data_len;
+    slot->Port = app_port;
+    slot->Priority = priority;
+    slot->Flags = flags;
+    slot->Handle = handle;
+    slot->Sequence = sequence;
+    slot->InUse = true;
+    AppTxQueue.Count++;
+
+    if (droppedHandle != 0) {
+        lorawan_tx_report_dropped(droppedHandle, droppedFlags, LORAWAN_TX_DROPPED);
+    }
+
+    // Try to send straight away
+    lorawan_tx_queue_process();
+
+    return handle;
+}
+
+int lorawan_send_queued(const void* data, uint8_t data_len, uint8_t app_port, uint8_t priority, uint8_t flags)
+{
+    if ((data_len > LORAWAN_APP_DATA_BUFFER_MAX_SIZE) || (app_port == 0) || (app_port > LORAWAN_APP_PORT_MAX)) {
         return -1;
     }
 
+#if (LORAWAN_MULTICORE == 1)
+    if (lorawan_is_remote()) {
+        AppCommand_t* command = lorawan_command_acquire(APP_COMMAND_SEND);
+
+        if (command == NULL) {
+            return -1;
+        }
+
+        int handle = lorawan_tx_next_handle();
+
+        memcpy(command->Buffer, data, data_len);
+        command->BufferSize = data_len;
+        command->Port = app_port;
+        command->Priority = priority;
+        command->Flags = flags;
+        command->Handle = handle;
+        lorawan_command_commit();
+
+        return handle;
+    }
+#endif
+
+    return lorawan_tx_queue_add(data, data_len, app_port, priority, flags, 0);
+}
+
+/*!
+ * Largest application payload the current datarate allows
+ */
+static uint8_t lorawan_aggregate_max_payload()
+{
+    LoRaMacTxInfo_t txInfo;
+
+    LoRaMacQueryTxPossible(0, &txInfo);
+
+    if (txInfo.CurrentPossiblePayloadSize > LORAWAN_APP_DATA_BUFFER_MAX_SIZE) {
+        return LORAWAN_APP_DATA_BUFFER_MAX_SIZE;
+    }
+
+    return txInfo.CurrentPossiblePayloadSize;
+}
+
+int lorawan_aggregate_init(uint8_t app_port, uint32_t max_latency_ms)
+{
+    if ((app_port == 0) || (app_port > LORAWAN_APP_PORT_MAX)) {
+        return -1;
+    }
+
+#if (LORAWAN_MULTICORE == 1)
+    if (lorawan_is_remote()) {
+        AppCommand_t* command = lorawan_command_acquire(APP_COMMAND_AGGREGATE_INIT);
+
+        if (command == NULL) {
+            return -1;
+        }
+
+        command->Port = app_port;
+        command->MaxLatencyMs = max_latency_ms;
+        lorawan_command_commit();
+
+        return 0;
+    }
+#endif
+
+    if (AppAggregate.BufferSize > 0) {
+        lorawan_aggregate_flush();
+    }
+
+    AppAggregate.Port = app_port;
+    AppAggregate.MaxLatencyMs = max_latency_ms;
+
     return 0;
 }
 
+int lorawan_aggregate_add(const void* sample, uint8_t sample_len)
+{
+#if (LORAWAN_MULTICORE == 1)
+    if (lorawan_is_remote()) {
+        if ((sample_len == 0) || (sample_len > LORAWAN_APP_DATA_BUFFER_MAX_SIZE)) {
+            return -1;
+        }
+
+        AppCommand_t* command = lorawan_command_acquire(APP_COMMAND_AGGREGATE_ADD);
+
+        if (command == NULL) {
+            return -1;
+        }
+
+        memcpy(command->Buffer, sample, sample_len);
+        command->BufferSize = sample_len;
+        lorawan_command_commit();
+
+        return 0;
+    }
+#endif
+
+    uint8_t maxPayload = lorawan_aggregate_max_payload();
+
+    if ((AppAggregate.Port == 0) || (sample_len == 0) || (sample_len > maxPayload)) {
+        return -1;
+    }
+
+    // Datarate may have dropped since the previous sample
+    if ((AppAggregate.BufferSize + sample_len) > maxPayload) {
+        if (lorawan_aggregate_flush() < 0) {
+            return -1;
+        }
+    }
+
+    if (AppAggregate.BufferSize == 0) {
+        AppAggregate.Deadline = make_timeout_time_ms(AppAggregate.MaxLatencyMs);
+    }
+
+    memcpy(AppAggregate.Buffer + AppAggregate.BufferSize, sample, sample_len);
+    AppAggregate.BufferSize += sample_len;
+    AppAggregate.Samples++;
+
+    // Flush as soon as another sample of the same size no longer fits
+    if ((AppAggregate.BufferSize + sample_len) > maxPayload) {
+        lorawan_aggregate_flush();
+    }
+
+    return 0;
+}
+
+int lorawan_aggregate_flush()
+{
+#if (LORAWAN_MULTICORE == 1)
+    if (lorawan_is_remote()) {
+        if (lorawan_command_acquire(APP_COMMAND_AGGREGATE_FLUSH) == NULL) {
+            return -1;
+        }
+        lorawan_command_commit();
+
+        return 0;
+    }
+#endif
+
+    if (AppAggregate.BufferSize == 0) {
+        return 0;
+    }
+
+    uint8_t maxPayload = lorawan_aggregate_max_payload();
+
+    if (lorawan_send_queued(AppAggregate.Buffer, AppAggregate.BufferSize, AppAggregate.Port, 0, 0) < 0) {
+        return -1;
+    }
+
+    AppAggregate.Stats.frames++;
+    AppAggregate.Stats.samples += AppAggregate.Samples;
+    AppAggregate.Stats.payload_bytes += AppAggregate.BufferSize;
+    AppAggregate.Stats.capacity_bytes += (maxPayload > AppAggregate.BufferSize) ? maxPayload : AppAggregate.BufferSize;
+
+    AppAggregate.BufferSize = 0;
+    AppAggregate.Samples = 0;
+
+    return 0;
+}
+
+void lorawan_aggregate_get_stats(struct lorawan_aggregate_stats* stats)
+{
+    *stats = AppAggregate.Stats;
+}
+
+int lorawan_send_queue_pending()
+{
+    return AppTxQueue.Count;
+}
+
+void lorawan_send_queue_stats(uint32_t* sent, uint32_t* coalesced, uint32_t* dropped)
+{
+    if (sent != NULL) {
+        *sent = AppTxQueue.Sent;
+    }
+    if (coalesced != NULL) {
+        *coalesced = AppTxQueue.Coalesced;
+    }
+    if (dropped != NULL) {
+        *dropped = AppTxQueue.Dropped;
+    }
+}
+
 int lorawan_receive(void* data, uint8_t data_len, uint8_t* app_port)
 {
-    *app_port = AppRxData.Port;
-    if (*app_port == 0) {
+    struct lorawan_downlink downlink;
+
+    if (lorawan_receive_peek(&downlink) < 0) {
+        *app_port = 0;
         return -1;
     }
 
-    int receive_length = AppRxData.BufferSize;
+    int receive_length = downlink.data_len;
 
     if (data_len < receive_length) {
         receive_length = data_len;
     }
 
-    memcpy(data, AppRxData.Buffer, receive_length);
-    AppRxData.Port = 0;
+    memcpy(data, downlink.data, receive_length);
+    *app_port = downlink.app_port;
+
+    lorawan_receive_release();
 
     return receive_length;
 }
 
+int lorawan_receive_peek(struct lorawan_downlink* downlink)
+{
+    const AppRxSlot_t* slot = spsc_queue_read_acquire(&AppRxQueue.Queue);
+
+    if (slot == NULL) {
+        return -1;
+    }
+
+    downlink->data = slot->Buffer;
+    downlink->data_len = slot->BufferSize;
+    downlink->app_port = slot->Port;
+    downlink->rssi = slot->Rssi;
+    downlink->snr = slot->Snr;
+    downlink->rx_slot = slot->RxSlot;
+    downlink->fcnt = slot->DownlinkCounter;
+
+    return 0;
+}
+
+void lorawan_receive_release()
+{
+    spsc_queue_read_release(&AppRxQueue.Queue);
+}
+
+void lorawan_receive_stats(uint32_t* received, uint32_t* dropped)
+{
+    if (received != NULL) {
+        *received = AppRxQueue.Received;
+    }
+    if (dropped != NULL) {
+        *dropped = AppRxQueue.Dropped;
+    }
+}
+
 void lorawan_debug(bool debug)
 {
     Debug = debug;
 }
 
+#if (LORAWAN_MULTICORE == 1)
+/*!
+ * Runs an application request on core1
+ */
+static void lorawan_command_process(const AppCommand_t* command)
+{
+    switch (command->Type) {
+        case APP_COMMAND_JOIN:
+            lorawan_join();
+            break;
+        case APP_COMMAND_SEND:
+            if (lorawan_tx_queue_add(command->Buffer, command->BufferSize, command->Port, command->Priority, command->Flags, command->Handle) < 0) {
+                // Core0 already returned the handle to the application
+                lorawan_tx_report_dropped(command->Handle, command->Flags, LORAWAN_TX_DROPPED);
+            }
+            break;
+        case APP_COMMAND_AGGREGATE_INIT:
+            lorawan_aggregate_init(command->Port, command->MaxLatencyMs);
+            break;
+        case APP_COMMAND_AGGREGATE_ADD:
+            lorawan_aggregate_add(command->Buffer, command->BufferSize);
+            break;
+        case APP_COMMAND_AGGREGATE_FLUSH:
+            lorawan_aggregate_flush();
+            break;
+        default:
+            break;
+    }
+}
+
+/*!
+ * Core1 main loop, runs the LoRaMac stack and sleeps between its events
+ */
+static void lorawan_core1_entry()
+{
+    Core1Status = lorawan_init(Core1Settings, Core1Region);
+    Core1Running = (Core1Status == 0);
+    Core1Started = true;
+    __sev();
+
+    while (Core1Running) {
+        const AppCommand_t* command;
+        uint32_t received = AppRxQueue.Received;
+        uint32_t events = spsc_queue_count(&AppEvents);
+        bool joined = IsJoined;
+
+        while ((command = spsc_queue_read_acquire(&AppCommands)) != NULL) {
+            lorawan_command_process(command);
+            spsc_queue_read_release(&AppCommands);
+        }
+
+        lorawan_process();
+
+        // Only wake up core0 when there is something new for it, the event
+        // also wakes up core1 once
+        if ((AppRxQueue.Received != received) || (spsc_queue_count(&AppEvents) != events) || (IsJoined != joined)) {
+            __sev();
+        }
+
+        uint64_t wakeup = lorawan_next_wakeup_us();
+        absolute_time_t wait_time = at_the_end_of_time;
+
+        if (wakeup != UINT64_MAX) {
+            update_us_since_boot(&wait_time, wakeup);
+        }
+
+        if (spsc_queue_count(&AppCommands) == 0) {
+            best_effort_wfe_or_timeout(wait_time);
+        }
+    }
+}
+#endif
+
 static void OnMacProcessNotify( void )
 {
     IsMacProcessPending = 1;
@@ -430,11 +1475,7 @@ static void OnNetworkParametersChange( CommissioningParams_t* params )
     if (OtaaSettings != NULL) {
         params->IsOtaaActivation = 1;
 
-        printf("\n419 lorawan.c OnNetworkParametersChange()");
-        printf("device_eui :");
-       
         device_eui = OtaaSettings->device_eui;
-        showBuffer(device_eui,8);
         app_eui = OtaaSettings->app_eui;
         app_key = OtaaSettings->app_key;
         channel_mask = OtaaSettings->channel_mask;
@@ -486,17 +1527,11 @@ static void OnNetworkParametersChange( CommissioningParams_t* params )
             //sscanf(device_eui + (i * 2), "%2hhx", deviceEui[i]);
             deviceEui[i]=makeHexByte(device_eui[i*2],device_eui[i*2+1]);
         }
- 
-        printf("475 lorawan.c after parsing\n");
-        showBuffer(deviceEui,8);
 
         mibReq.Type = MIB_DEV_EUI;
         mibReq.Param.DevEui = deviceEui;
         LoRaMacMibSetRequestConfirm( &mibReq );
         memcpy1( params->DevEui, mibReq.Param.DevEui, 8 );
-
-        printf("480 lorawan.c after memcpy\n");
-        showBuffer(params->DevEui,8);
     }
 
     if (app_eui != NULL) {
@@ -594,6 +1629,8 @@ static void OnNetworkParametersChange( CommissioningParams_t* params )
 
 static void OnMacMcpsRequest( LoRaMacStatus_t status, McpsReq_t *mcpsReq, TimerTime_t nextTxIn )
 {
+    AppMcpsRequestStatus = status;
+
     if (Debug) {
         DisplayMacMcpsRequestUpdate( status, mcpsReq, nextTxIn );
     }
@@ -627,6 +1664,48 @@ static void OnTxData( LmHandlerTxParams_t* params )
     if (Debug) {
         DisplayTxUpdate( params );
     }
+
+    // Only report the outcome of uplinks requested by the application
+    if ((params->IsMcpsConfirm == 0) || !AppTxInFlight.Active) {
+        return;
+    }
+
+    AppTxInFlight.Active = false;
+
+    if (AppTxCallback == NULL) {
+        return;
+    }
+
+    struct lorawan_tx_result result = {
+        .handle = AppTxInFlight.Handle,
+        .mac_status = params->Status,
+        .confirmed = AppTxInFlight.Confirmed,
+        .ack_received = params->AckReceived,
+        .nb_trans = params->NbTrans,
+        .datarate = params->Datarate,
+        .tx_power = params->TxPower,
+        .time_on_air_ms = params->TxTimeOnAir,
+        .fcnt = params->UplinkCounter,
+    };
+
+    switch (params->Status) {
+        case LORAMAC_EVENT_INFO_STATUS_OK:
+        case LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT:
+        case LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT:
+        case LORAMAC_EVENT_INFO_STATUS_RX1_ERROR:
+        case LORAMAC_EVENT_INFO_STATUS_RX2_ERROR:
+        case LORAMAC_EVENT_INFO_STATUS_ADDRESS_FAIL:
+        case LORAMAC_EVENT_INFO_STATUS_MIC_FAIL:
+        case LORAMAC_EVENT_INFO_STATUS_DOWNLINK_REPEATED:
+            // Sent, a confirmed uplink reports the receive window outcome
+            result.status = (AppTxInFlight.Confirmed && !params->AckReceived) ? LORAWAN_TX_NO_ACK : LORAWAN_TX_SUCCESS;
+            break;
+        default:
+            result.status = LORAWAN_TX_ERROR;
+            break;
+    }
+
+    lorawan_tx_report(&result);
 }
 
 static void OnRxData( LmHandlerAppData_t* appData, LmHandlerRxParams_t* params )
@@ -635,9 +1714,30 @@ static void OnRxData( LmHandlerAppData_t* appData, LmHandlerRxParams_t* params )
         DisplayRxUpdate( appData, params );
     }
 
-    memcpy(AppRxData.Buffer, appData->Buffer, appData->BufferSize);
-    AppRxData.BufferSize = appData->BufferSize;
-    AppRxData.Port = appData->Port;
+    // MLME indications and MAC command only frames carry no application data
+    if ((appData == NULL) || (appData->Port == 0)) {
+        return;
+    }
+
+    AppRxSlot_t* slot = spsc_queue_write_acquire(&AppRxQueue.Queue);
+
+    AppRxQueue.Received++;
+
+    if (slot == NULL) {
+        // Queue full, keep the older frames and drop this one
+        AppRxQueue.Dropped++;
+        return;
+    }
+
+    memcpy(slot->Buffer, appData->Buffer, appData->BufferSize);
+    slot->BufferSize = appData->BufferSize;
+    slot->Port = appData->Port;
+    slot->Rssi = params->Rssi;
+    slot->Snr = params->Snr;
+    slot->RxSlot = params->RxSlot;
+    slot->DownlinkCounter = params->DownlinkCounter;
+
+    spsc_queue_write_commit(&AppRxQueue.Queue);
 }
 
 static void OnClassChange( DeviceClass_t deviceClass )
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2021 Arm Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <string.h>
+
+#include "spsc_queue.h"
+
+bool spsc_queue_init(struct spsc_queue* queue, void* buffer, uint32_t item_size, uint32_t size)
+{
+    if ((size == 0) || ((size & (size - 1)) != 0)) {
+        return false;
+    }
+
+    queue->buffer = buffer;
+    queue->item_size = item_size;
+    queue->size = size;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+
+    return true;
+}
+
+void* spsc_queue_write_acquire(struct spsc_queue* queue)
+{
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    // The consumer must be done with the slot before it is reused
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    if ((head - tail) >= queue->size) {
+        return NULL;
+    }
+
+    return queue->buffer + ((head & (queue->size - 1)) * queue->item_size);
+}
+
+void spsc_queue_write_commit(struct spsc_queue* queue)
+{
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    // Publish the slot only once its contents are written
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+}
+
+bool spsc_queue_push(struct spsc_queue* queue, const void* item)
+{
+    void* slot = spsc_queue_write_acquire(queue);
+
+    if (slot == NULL) {
+        return false;
+    }
+
+    memcpy(slot, item, queue->item_size);
+    spsc_queue_write_commit(queue);
+
+    return true;
+}
+
+void* spsc_queue_read_acquire(struct spsc_queue* queue)
+{
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    // Make sure the slot contents are read after the producer published them
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if (head == tail) {
+        return NULL;
+    }
+
+    return queue->buffer + ((tail & (queue->size - 1)) * queue->item_size);
+}
+
+void spsc_queue_read_release(struct spsc_queue* queue)
+{
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    if (atomic_load_explicit(&queue->head, memory_order_relaxed) == tail) {
+        return;
+    }
+
+    // Slot must be fully consumed before it is handed back to the producer
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+}
+
+bool spsc_queue_pop(struct spsc_queue* queue, void* item)
+{
+    void* slot = spsc_queue_read_acquire(queue);
+
+    if (slot == NULL) {
+        return false;
+    }
+
+    memcpy(item, slot, queue->item_size);
+    spsc_queue_read_release(queue);
+
+    return true;
+}
+
+uint32_t spsc_queue_count(struct spsc_queue* queue)
+{
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    return head - tail;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2021 Arm Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * Lock free single producer / single consumer queue of fixed size items.
+ *
+ * The producer and the consumer may run on different cores or threads, it
+ * only relies on C11 atomics.
+ *
+ * \remark head is only written by the producer and tail only by the consumer,
+ *         both are free running and wrap using size as mask.
+ */
+struct spsc_queue {
+    uint8_t* buffer;
+    uint32_t item_size;
+    uint32_t size;
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+};
+
+/*!
+ * Initializes an empty queue over a buffer of size items of item_size bytes,
+ * size must be a power of 2.
+ */
+bool spsc_queue_init(struct spsc_queue* queue, void* buffer, uint32_t item_size, uint32_t size);
+
+/*!
+ * Producer: returns the slot to be written next, NULL if the queue is full
+ */
+void* spsc_queue_write_acquire(struct spsc_queue* queue);
+
+/*!
+ * Producer: publishes the slot returned by spsc_queue_write_acquire()
+ */
+void spsc_queue_write_commit(struct spsc_queue* queue);
+
+/*!
+ * Producer: copies an item into the queue, false if the queue is full
+ */
+bool spsc_queue_push(struct spsc_queue* queue, const void* item);
+
+/*!
+ * Consumer: returns the oldest slot, NULL if the queue is empty
+ */
+void* spsc_queue_read_acquire(struct spsc_queue* queue);
+
+/*!
+ * Consumer: hands the slot returned by spsc_queue_read_acquire() back to the
+ * producer
+ */
+void spsc_queue_read_release(struct spsc_queue* queue);
+
+/*!
+ * Consumer: copies the oldest item out of the queue, false if the queue is
+ * empty
+ */
+bool spsc_queue_pop(struct spsc_queue* queue, void* item);
+
+/*!
+ * Number of items in the queue, exact for the producer and the consumer,
+ * a snapshot for anyone else
+ */
+uint32_t spsc_queue_count(struct spsc_queue* queue);
+
+#endif
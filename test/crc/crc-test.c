@@ -0,0 +1,121 @@
+/*!
+ * \file      crc-test.c
+ *
+ * \brief     Cross-checks the CRC kernel selected by CRC_IMPLEMENTATION
+ *            against the bitwise reference
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "utilities.h"
+
+/*
+ * BeaconCrc is static, the unused parts of the module are discarded by the
+ * linker
+ */
+#include "LoRaMacClassB.c"
+
+#define TEST_BUFFERS                                20000
+#define TEST_BUFFER_MAX_SIZE                        600
+
+static uint32_t ReferenceCrc32( const uint8_t *buffer, uint16_t length )
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for( uint16_t i = 0; i < length; i++ )
+    {
+        crc ^= buffer[i];
+        for( uint8_t j = 0; j < 8; j++ )
+        {
+            crc = ( crc >> 1 ) ^ ( ( crc & 0x01 ) ? 0xEDB88320 : 0 );
+        }
+    }
+    return ~crc;
+}
+
+static uint16_t ReferenceBeaconCrc( const uint8_t *buffer, uint16_t length )
+{
+    uint16_t crc = 0x0000;
+
+    for( uint16_t i = 0; i < length; i++ )
+    {
+        crc ^= ( uint16_t )buffer[i] << 8;
+        for( uint8_t j = 0; j < 8; j++ )
+        {
+            crc = ( crc & 0x8000 ) ? ( crc << 1 ) ^ 0x1021 : ( crc << 1 );
+        }
+    }
+    return crc;
+}
+
+int main( void )
+{
+    // One spare byte to check unaligned buffers
+    static uint8_t buffer[TEST_BUFFER_MAX_SIZE + 1];
+    int failures = 0;
+
+    srand( 1 );
+
+    // Known value of the standard check string
+    if( Crc32( ( uint8_t* )"123456789", 9 ) != 0xCBF43926 )
+    {
+        printf( "Crc32 check value mismatch\n" );
+        failures++;
+    }
+    if( ( Crc32( NULL, 10 ) != 0 ) || ( Crc32Update( Crc32Init( ), NULL, 10 ) != 0 ) )
+    {
+        printf( "NULL buffer not rejected\n" );
+        failures++;
+    }
+
+    for( uint32_t n = 0; n < TEST_BUFFERS; n++ )
+    {
+        uint8_t offset = rand( ) & 0x01;
+        uint16_t length = rand( ) % ( TEST_BUFFER_MAX_SIZE + 1 );
+        uint8_t *data = buffer + offset;
+
+        for( uint16_t i = 0; i < length; i++ )
+        {
+            data[i] = rand( );
+        }
+
+        uint32_t expected = ReferenceCrc32( data, length );
+
+        if( Crc32( data, length ) != expected )
+        {
+            printf( "Crc32 mismatch, length %u offset %u\n", length, offset );
+            failures++;
+        }
+
+        // Same CRC computed in random chunks
+        uint32_t crc = Crc32Init( );
+        uint16_t done = 0;
+
+        while( done < length )
+        {
+            uint16_t chunk = 1 + rand( ) % ( length - done );
+
+            crc = Crc32Update( crc, data + done, chunk );
+            done += chunk;
+        }
+        if( Crc32Finalize( crc ) != expected )
+        {
+            printf( "Crc32Update mismatch, length %u offset %u\n", length, offset );
+            failures++;
+        }
+
+        // Beacons are at most 17 bytes long, check longer ones all the same
+        uint16_t beaconLength = length % 32;
+
+        if( BeaconCrc( data, beaconLength ) != ReferenceBeaconCrc( data, beaconLength ) )
+        {
+            printf( "BeaconCrc mismatch, length %u\n", beaconLength );
+            failures++;
+        }
+    }
+
+    printf( "CRC_IMPLEMENTATION %d: %d failures\n", CRC_IMPLEMENTATION, failures );
+    return ( failures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+/*!
+ * \file      eeprom-test.c
+ *
+ * \brief     Runs the flash backed EEPROM emulation against a simulated NOR
+ *            flash: random writes checked across power cycles, compactions
+ *            wrapping around the sectors and the sequence numbers, and power
+ *            losses at every byte of a write
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "mock-flash.h"
+
+// The log state is reset to its power up value by including the driver
+#include "eeprom-board.c"
+
+/*!
+ * Random writes, the EEPROM is remounted and checked every
+ * TEST_REMOUNT_PERIOD writes
+ */
+#define TEST_RANDOM_WRITES                          20000
+#define TEST_REMOUNT_PERIOD                         500
+
+/*!
+ * Longest random write [bytes]
+ */
+#define TEST_WRITE_SIZE_MAX                         64
+
+/*!
+ * Index of the first EEPROM log sector in the flash
+ */
+#define TEST_FIRST_SECTOR                           ( EEPROM_FLASH_OFFSET / FLASH_SECTOR_SIZE )
+
+static int Failures;
+
+static uint32_t Seed = 0x2545F491;
+
+/*!
+ * Expected EEPROM content
+ */
+static uint8_t Reference[EEPROM_SIZE];
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "  %s\n", message );
+        Failures++;
+    }
+}
+
+uint32_t save_and_disable_interrupts( void )
+{
+    return 0;
+}
+
+void restore_interrupts( uint32_t status )
+{
+}
+
+static uint32_t Random( void )
+{
+    Seed ^= Seed << 13;
+    Seed ^= Seed >> 17;
+    Seed ^= Seed << 5;
+    return Seed;
+}
+
+/*!
+ * \brief Power cycles the board, the log is mounted again from the flash
+ */
+static void Remount( void )
+{
+    EepromMounted = false;
+    EepromSector = EEPROM_FLASH_SECTORS - 1;
+    EepromSequence = 0;
+    EepromWriteOffset = FLASH_SECTOR_SIZE;
+
+    EepromMount( );
+}
+
+static bool EepromMatches( const uint8_t *image )
+{
+    static uint8_t buffer[EEPROM_SIZE];
+
+    EepromMcuReadBuffer( 0, buffer, EEPROM_SIZE );
+    return memcmp( buffer, image, EEPROM_SIZE ) == 0;
+}
+
+/*!
+ * \brief Changes a few bytes of a random range, as the LoRaMac NVM updates do
+ *
+ * \param [IN] image Image updated with the write
+ */
+static void RandomWrite( uint8_t *image )
+{
+    uint8_t data[TEST_WRITE_SIZE_MAX];
+    uint16_t size = 1 + ( Random( ) % TEST_WRITE_SIZE_MAX );
+    uint16_t addr = Random( ) % ( EEPROM_SIZE - size + 1 );
+
+    memcpy( data, image + addr, size );
+    for( uint8_t n = 1 + ( Random( ) % 4 ); n > 0; n-- )
+    {
+        data[Random( ) % size] = Random( );
+    }
+
+    EepromMcuWriteBuffer( addr, data, size );
+    memcpy( image + addr, data, size );
+}
+
+static void RandomWritesCheck( void )
+{
+    uint32_t erasesMin = UINT32_MAX;
+    uint32_t erasesMax = 0;
+    uint32_t errors = 0;
+
+    MockFlashReset( );
+    Remount( );
+    memset( Reference, 0xFF, EEPROM_SIZE );
+
+    // The sector sequence numbers wrap during the test
+    EepromSequence = UINT32_MAX - 1;
+
+    for( uint32_t n = 1; n <= TEST_RANDOM_WRITES; n++ )
+    {
+        RandomWrite( Reference );
+        if( ( n % TEST_REMOUNT_PERIOD ) == 0 )
+        {
+            Remount( );
+            if( EepromMatches( Reference ) == false )
+            {
+                errors++;
+            }
+        }
+    }
+
+    printf( "%u random writes, %u bytes programmed, sequence %u\n", TEST_RANDOM_WRITES, MockFlashState.Programmed, EepromSequence );
+    for( uint8_t sector = 0; sector < EEPROM_FLASH_SECTORS; sector++ )
+    {
+        uint32_t erases = MockFlashState.Erases[TEST_FIRST_SECTOR + sector];
+
+        printf( "  sector %u: %u erases\n", sector, erases );
+        erasesMin = MIN( erasesMin, erases );
+        erasesMax = MAX( erasesMax, erases );
+    }
+    Check( errors == 0, "Content lost across a power cycle" );
+    Check( erasesMin >= 2, "Compaction did not wrap around the sectors" );
+    Check( ( erasesMax - erasesMin ) <= 1, "Erase cycles not spread over the sectors" );
+    Check( EepromSequence < ( UINT32_MAX - 1 ), "Sequence number did not wrap" );
+}
+
+/*!
+ * \brief Counts the erase cycles of the EEPROM sectors
+ */
+static uint32_t Erases( void )
+{
+    uint32_t erases = 0;
+
+    for( uint8_t sector = 0; sector < EEPROM_FLASH_SECTORS; sector++ )
+    {
+        erases += MockFlashState.Erases[TEST_FIRST_SECTOR + sector];
+    }
+    return erases;
+}
+
+/*!
+ * \brief Loses the power at every byte of a write, the remounted EEPROM must
+ *        hold either the old or the new content and accept further writes
+ *
+ * \param [IN] name    Case name
+ * \param [IN] compact Whether the write compacts the log into the next sector
+ */
+static void TornWriteCheck( const char *name, bool compact )
+{
+    static uint8_t snapshot[EEPROM_FLASH_SECTORS * FLASH_SECTOR_SIZE];
+    static uint8_t written[EEPROM_SIZE];
+    static uint8_t image[EEPROM_SIZE];
+    uint8_t *flash = MockFlash + EEPROM_FLASH_OFFSET;
+    uint8_t data[TEST_WRITE_SIZE_MAX];
+    uint16_t addr = 100;
+    uint32_t oldCount = 0;
+    uint32_t newCount = 0;
+    uint32_t errors = 0;
+    bool committed = false;
+
+    // Brings the log to the state to be checked
+    while( ( ( EepromWriteOffset + EEPROM_RECORD_SIZE( TEST_WRITE_SIZE_MAX ) ) > FLASH_SECTOR_SIZE ) != compact )
+    {
+        RandomWrite( Reference );
+    }
+    for( uint8_t i = 0; i < TEST_WRITE_SIZE_MAX; i++ )
+    {
+        data[i] = ~Reference[addr + i];
+    }
+    memcpy( written, Reference, EEPROM_SIZE );
+    memcpy( written + addr, data, TEST_WRITE_SIZE_MAX );
+    memcpy( snapshot, flash, sizeof( snapshot ) );
+
+    // Length of the write, an erase counting as a byte
+    uint32_t programmed = MockFlashState.Programmed;
+    uint32_t erases = Erases( );
+
+    EepromMcuWriteBuffer( addr, data, TEST_WRITE_SIZE_MAX );
+    erases = Erases( ) - erases;
+    uint32_t length = ( MockFlashState.Programmed - programmed ) + erases;
+    Check( ( erases != 0 ) == compact, "Log not compacted as expected" );
+
+    for( uint32_t budget = 0; budget < length; budget++ )
+    {
+        memcpy( flash, snapshot, sizeof( snapshot ) );
+        Remount( );
+
+        MockFlashState.PowerBudget = budget;
+        if( setjmp( MockFlashState.PowerLoss ) == 0 )
+        {
+            EepromMcuWriteBuffer( addr, data, TEST_WRITE_SIZE_MAX );
+            Check( false, "Power not lost during the write" );
+        }
+        MockFlashState.PowerBudget = -1;
+        Remount( );
+
+        if( EepromMatches( written ) == true )
+        {
+            memcpy( image, written, EEPROM_SIZE );
+            committed = true;
+            newCount++;
+        }
+        else if( ( EepromMatches( Reference ) == true ) && ( committed == false ) )
+        {
+            memcpy( image, Reference, EEPROM_SIZE );
+            oldCount++;
+        }
+        else
+        {
+            errors++;
+            continue;
+        }
+
+        // A damaged log is compacted by the next write
+        RandomWrite( image );
+        Remount( );
+        if( EepromMatches( image ) == false )
+        {
+            errors++;
+        }
+    }
+
+    printf( "%-10s power lost at %5u bytes: %5u old, %5u new, %u errors\n", name, length, oldCount, newCount, errors );
+    Check( errors == 0, "Torn write left an inconsistent EEPROM" );
+    Check( oldCount > 0, "Write committed before it started" );
+
+    // Carries on from the completed write
+    memcpy( flash, snapshot, sizeof( snapshot ) );
+    Remount( );
+    EepromMcuWriteBuffer( addr, data, TEST_WRITE_SIZE_MAX );
+    memcpy( Reference, written, EEPROM_SIZE );
+}
+
+int main( void )
+{
+    printf( "EEPROM %u bytes over %u sectors\n", ( uint32_t )EEPROM_SIZE, EEPROM_FLASH_SECTORS );
+
+    RandomWritesCheck( );
+    TornWriteCheck( "append", false );
+    TornWriteCheck( "compaction", true );
+
+    printf( "eeprom: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
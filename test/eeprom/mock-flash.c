@@ -0,0 +1,75 @@
+/*!
+ * \file      mock-flash.c
+ *
+ * \brief     Host stand-in for the RP2040 QSPI flash
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <string.h>
+#include "mock-flash.h"
+
+uint8_t MockFlash[PICO_FLASH_SIZE_BYTES];
+
+MockFlashState_t MockFlashState = { .PowerBudget = -1 };
+
+/*!
+ * State of the generator choosing the bits of a partly programmed byte
+ */
+static uint32_t MockFlashSeed = 1;
+
+void MockFlashReset( void )
+{
+    memset( MockFlash, 0xFF, sizeof( MockFlash ) );
+    memset( MockFlashState.Erases, 0, sizeof( MockFlashState.Erases ) );
+    MockFlashState.Programmed = 0;
+    MockFlashState.PowerBudget = -1;
+}
+
+/*!
+ * \brief Spends a byte of the power budget
+ *
+ * \retval lost True when the power is lost during this byte
+ */
+static bool MockFlashPowerSpend( void )
+{
+    if( MockFlashState.PowerBudget < 0 )
+    {
+        return false;
+    }
+    if( MockFlashState.PowerBudget == 0 )
+    {
+        return true;
+    }
+    MockFlashState.PowerBudget--;
+    return false;
+}
+
+void flash_range_erase( uint32_t flash_offs, size_t count )
+{
+    for( uint32_t sector = flash_offs / FLASH_SECTOR_SIZE; sector < ( ( flash_offs + count ) / FLASH_SECTOR_SIZE ); sector++ )
+    {
+        if( MockFlashPowerSpend( ) == true )
+        {
+            memset( MockFlash + ( sector * FLASH_SECTOR_SIZE ) + ( FLASH_SECTOR_SIZE / 2 ), 0xFF, FLASH_SECTOR_SIZE / 2 );
+            longjmp( MockFlashState.PowerLoss, 1 );
+        }
+        memset( MockFlash + ( sector * FLASH_SECTOR_SIZE ), 0xFF, FLASH_SECTOR_SIZE );
+        MockFlashState.Erases[sector]++;
+    }
+}
+
+void flash_range_program( uint32_t flash_offs, const uint8_t *data, size_t count )
+{
+    for( size_t i = 0; i < count; i++ )
+    {
+        // Programming only clears bits, a bit set again needs an erase
+        if( MockFlashPowerSpend( ) == true )
+        {
+            MockFlashSeed = ( MockFlashSeed * 1103515245 ) + 12345;
+            MockFlash[flash_offs + i] &= data[i] | ( uint8_t )( MockFlashSeed >> 16 );
+            longjmp( MockFlashState.PowerLoss, 1 );
+        }
+        MockFlash[flash_offs + i] &= data[i];
+        MockFlashState.Programmed++;
+    }
+}
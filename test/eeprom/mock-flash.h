@@ -0,0 +1,43 @@
+/*!
+ * \file      mock-flash.h
+ *
+ * \brief     Host stand-in for the RP2040 QSPI flash, with the NOR flash
+ *            semantics and power losses in the middle of an operation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#ifndef __MOCK_FLASH_H__
+#define __MOCK_FLASH_H__
+
+#include <setjmp.h>
+#include <stdint.h>
+#include "pico.h"
+#include "hardware/flash.h"
+
+#define MOCK_FLASH_SECTORS                          ( PICO_FLASH_SIZE_BYTES / FLASH_SECTOR_SIZE )
+
+/*!
+ * Flash operations and power loss injection
+ */
+typedef struct MockFlashState_s
+{
+    uint32_t Erases[MOCK_FLASH_SECTORS];    //!< Erase cycles per sector
+    uint32_t Programmed;                    //!< Bytes programmed
+    /*!
+     * Bytes which may still be programmed, an erase counting as one byte,
+     * before the power is lost. The byte exhausting the budget is only
+     * partly programmed, an erase exhausting it only erases the second half
+     * of the sector. Negative when the power is never lost.
+     */
+    int32_t PowerBudget;
+    jmp_buf PowerLoss;                      //!< Jumped to once the power is lost
+}MockFlashState_t;
+
+extern MockFlashState_t MockFlashState;
+
+/*!
+ * \brief Erases the whole flash and clears the counters
+ */
+void MockFlashReset( void );
+
+#endif // __MOCK_FLASH_H__
@@ -0,0 +1,12 @@
+/*!
+ * \file      gpio.h
+ *
+ * \brief     Host stand-in for the Pico SDK GPIO header, the board files
+ *            built into the host checks go through the gpio.h driver
+ */
+#ifndef __TEST_HARDWARE_GPIO_H__
+#define __TEST_HARDWARE_GPIO_H__
+
+#include "pico/stdlib.h"
+
+#endif // __TEST_HARDWARE_GPIO_H__
@@ -0,0 +1,17 @@
+/*!
+ * \file      spi.h
+ *
+ * \brief     Host stand-in for the Pico SDK SPI header, the board files
+ *            built into the host checks go through the spi.h driver
+ */
+#ifndef __TEST_HARDWARE_SPI_H__
+#define __TEST_HARDWARE_SPI_H__
+
+#include "pico/stdlib.h"
+
+typedef struct spi_inst spi_inst_t;
+
+#define spi0                                        ( ( spi_inst_t* )0 )
+#define spi1                                        ( ( spi_inst_t* )1 )
+
+#endif // __TEST_HARDWARE_SPI_H__
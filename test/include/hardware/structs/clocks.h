@@ -0,0 +1,35 @@
+/*!
+ * \file      clocks.h
+ *
+ * \brief     Host stand-in for the clock gating registers of the sleep mode
+ */
+#ifndef __TEST_HARDWARE_STRUCTS_CLOCKS_H__
+#define __TEST_HARDWARE_STRUCTS_CLOCKS_H__
+
+#include "pico/stdlib.h"
+
+#define CLOCKS_SLEEP_EN0_RESET                      0xffffffff
+#define CLOCKS_SLEEP_EN1_RESET                      0x00007fff
+
+#define CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS            0x00000100
+#define CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS          0x00000800
+#define CLOCKS_SLEEP_EN1_CLK_SYS_TIMER_BITS         0x00000020
+#define CLOCKS_SLEEP_EN1_CLK_SYS_WATCHDOG_BITS      0x00001000
+#define CLOCKS_SLEEP_EN1_CLK_SYS_USBCTRL_BITS       0x00000400
+#define CLOCKS_SLEEP_EN1_CLK_USB_USBCTRL_BITS       0x00000800
+#define CLOCKS_SLEEP_EN1_CLK_SYS_UART0_BITS         0x00000080
+#define CLOCKS_SLEEP_EN1_CLK_PERI_UART0_BITS        0x00000040
+#define CLOCKS_SLEEP_EN1_CLK_SYS_UART1_BITS         0x00000200
+#define CLOCKS_SLEEP_EN1_CLK_PERI_UART1_BITS        0x00000100
+
+typedef struct
+{
+    uint32_t sleep_en0;
+    uint32_t sleep_en1;
+}clocks_hw_t;
+
+extern clocks_hw_t MockClocksHw;
+
+#define clocks_hw                                   ( &MockClocksHw )
+
+#endif // __TEST_HARDWARE_STRUCTS_CLOCKS_H__
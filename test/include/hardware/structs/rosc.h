@@ -0,0 +1,21 @@
+/*!
+ * \file      rosc.h
+ *
+ * \brief     Host stand-in for the ring oscillator registers, each access
+ *            draws a new random bit
+ */
+#ifndef __TEST_HARDWARE_STRUCTS_ROSC_H__
+#define __TEST_HARDWARE_STRUCTS_ROSC_H__
+
+#include "pico/stdlib.h"
+
+typedef struct
+{
+    uint32_t randombit;
+}rosc_hw_t;
+
+rosc_hw_t *MockRoscHw( void );
+
+#define rosc_hw                                     MockRoscHw( )
+
+#endif // __TEST_HARDWARE_STRUCTS_ROSC_H__
@@ -0,0 +1,22 @@
+/*!
+ * \file      scb.h
+ *
+ * \brief     Host stand-in for the system control register of the core
+ */
+#ifndef __TEST_HARDWARE_STRUCTS_SCB_H__
+#define __TEST_HARDWARE_STRUCTS_SCB_H__
+
+#include "pico/stdlib.h"
+
+#define M0PLUS_SCR_SLEEPDEEP_BITS                   0x00000004
+
+typedef struct
+{
+    uint32_t scr;
+}armv6m_scb_t;
+
+extern armv6m_scb_t MockScbHw;
+
+#define scb_hw                                      ( &MockScbHw )
+
+#endif // __TEST_HARDWARE_STRUCTS_SCB_H__
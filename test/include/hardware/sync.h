@@ -0,0 +1,17 @@
+/*!
+ * \file      sync.h
+ *
+ * \brief     Host stand-in for the Pico SDK synchronization primitives
+ */
+#ifndef __TEST_HARDWARE_SYNC_H__
+#define __TEST_HARDWARE_SYNC_H__
+
+#include "pico/stdlib.h"
+
+void __sev( void );
+void __wfe( void );
+void __wfi( void );
+uint32_t save_and_disable_interrupts( void );
+void restore_interrupts( uint32_t status );
+
+#endif // __TEST_HARDWARE_SYNC_H__
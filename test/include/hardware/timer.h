@@ -0,0 +1,13 @@
+/*!
+ * \file      timer.h
+ *
+ * \brief     Host stand-in for the Pico SDK timer header
+ */
+#ifndef __TEST_HARDWARE_TIMER_H__
+#define __TEST_HARDWARE_TIMER_H__
+
+#include "pico/time.h"
+
+void busy_wait_us_32( uint32_t delay_us );
+
+#endif // __TEST_HARDWARE_TIMER_H__
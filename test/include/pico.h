@@ -0,0 +1,19 @@
+/*!
+ * \file      pico.h
+ *
+ * \brief     Host stand-in for the Pico SDK base header, maps the flash to
+ *            the simulated flash of mock-flash.c
+ */
+#ifndef __TEST_PICO_H__
+#define __TEST_PICO_H__
+
+#include <stddef.h>
+#include "pico/stdlib.h"
+
+#define PICO_FLASH_SIZE_BYTES                       ( 2 * 1024 * 1024 )
+
+extern uint8_t MockFlash[PICO_FLASH_SIZE_BYTES];
+
+#define XIP_BASE                                    ( ( uintptr_t )MockFlash )
+
+#endif // __TEST_PICO_H__
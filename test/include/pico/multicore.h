@@ -0,0 +1,12 @@
+/*!
+ * \file      multicore.h
+ *
+ * \brief     Host stand-in for the Pico SDK multicore header, the host
+ *            checks run the LoRaMac stack on a single core
+ */
+#ifndef __TEST_PICO_MULTICORE_H__
+#define __TEST_PICO_MULTICORE_H__
+
+#include "pico/stdlib.h"
+
+#endif // __TEST_PICO_MULTICORE_H__
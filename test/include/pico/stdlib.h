@@ -0,0 +1,18 @@
+/*!
+ * \file      stdlib.h
+ *
+ * \brief     Host stand-in for the few Pico SDK definitions used by the
+ *            board files built into the host checks
+ */
+#ifndef __TEST_PICO_STDLIB_H__
+#define __TEST_PICO_STDLIB_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/time.h"
+
+uint __get_current_exception( void );
+uint get_core_num( void );
+
+#endif // __TEST_PICO_STDLIB_H__
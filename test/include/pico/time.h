@@ -0,0 +1,88 @@
+/*!
+ * \file      time.h
+ *
+ * \brief     Host stand-in for the Pico SDK time and alarm API, implemented
+ *            by the simulated clock of mock-pico.c
+ */
+#ifndef __TEST_PICO_TIME_H__
+#define __TEST_PICO_TIME_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+
+typedef struct
+{
+    uint64_t _private_us_since_boot;
+}absolute_time_t;
+
+typedef int32_t alarm_id_t;
+
+typedef int64_t ( *alarm_callback_t )( alarm_id_t id, void *user_data );
+
+typedef struct alarm_pool alarm_pool_t;
+
+static const absolute_time_t at_the_end_of_time = { INT64_MAX };
+static const absolute_time_t nil_time = { 0 };
+
+static inline uint64_t to_us_since_boot( absolute_time_t t )
+{
+    return t._private_us_since_boot;
+}
+
+static inline void update_us_since_boot( absolute_time_t *t, uint64_t us_since_boot )
+{
+    t->_private_us_since_boot = us_since_boot;
+}
+
+static inline uint32_t us_to_ms( uint64_t us )
+{
+    return ( uint32_t )( us / 1000u );
+}
+
+static inline uint32_t to_ms_since_boot( absolute_time_t t )
+{
+    return us_to_ms( to_us_since_boot( t ) );
+}
+
+static inline absolute_time_t delayed_by_us( const absolute_time_t t, uint64_t us )
+{
+    absolute_time_t delayed;
+    uint64_t base = to_us_since_boot( t );
+    uint64_t delayed_us = base + us;
+
+    // Saturates at the end of time, as the SDK does
+    if( ( delayed_us < base ) || ( delayed_us > INT64_MAX ) )
+    {
+        delayed_us = INT64_MAX;
+    }
+    update_us_since_boot( &delayed, delayed_us );
+    return delayed;
+}
+
+static inline absolute_time_t delayed_by_ms( const absolute_time_t t, uint32_t ms )
+{
+    return delayed_by_us( t, ( uint64_t )ms * 1000 );
+}
+
+static inline int64_t absolute_time_diff_us( absolute_time_t from, absolute_time_t to )
+{
+    return ( int64_t )( to_us_since_boot( to ) - to_us_since_boot( from ) );
+}
+
+uint32_t time_us_32( void );
+uint64_t time_us_64( void );
+absolute_time_t get_absolute_time( void );
+absolute_time_t make_timeout_time_us( uint64_t us );
+absolute_time_t make_timeout_time_ms( uint32_t ms );
+bool best_effort_wfe_or_timeout( absolute_time_t timeout );
+
+alarm_pool_t *alarm_pool_create( uint hardware_alarm_num, uint max_timers );
+alarm_id_t alarm_pool_add_alarm_at( alarm_pool_t *pool, absolute_time_t time, alarm_callback_t callback,
+                                    void *user_data, bool fire_if_past );
+bool alarm_pool_cancel_alarm( alarm_pool_t *pool, alarm_id_t alarm_id );
+alarm_id_t add_alarm_at( absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past );
+bool cancel_alarm( alarm_id_t alarm_id );
+
+#endif // __TEST_PICO_TIME_H__
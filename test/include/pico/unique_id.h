@@ -0,0 +1,18 @@
+/*!
+ * \file      unique_id.h
+ *
+ * \brief     Host stand-in for the Pico SDK unique board identifier
+ */
+#ifndef __TEST_PICO_UNIQUE_ID_H__
+#define __TEST_PICO_UNIQUE_ID_H__
+
+#include "pico/stdlib.h"
+
+typedef struct
+{
+    uint8_t id[8];
+}pico_unique_board_id_t;
+
+void pico_get_unique_board_id( pico_unique_board_id_t *id_out );
+
+#endif // __TEST_PICO_UNIQUE_ID_H__
@@ -0,0 +1,381 @@
+/*!
+ * \file      contexts-test.c
+ *
+ * \brief     Runs LORAMAC_CONTEXTS end-devices in one process on the mock
+ *            radio, LoRaMac driven directly. Each device joins, then sends
+ *            periodic uplinks in its own time slot, the radio being shared.
+ *            The timer list of each device is dispatched with its context
+ *            selected. Reports the MAC CPU time per device.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "hardware/sync.h"
+#include "pico/board-config.h"
+#include "LoRaMac.h"
+#include "radio.h"
+#include "rtc-board.h"
+#include "sx126x-board.h"
+#include "timer.h"
+#include "mock-pico.h"
+#include "mock-board.h"
+#include "mock-network.h"
+
+#if( LORAMAC_CONTEXTS < 2 )
+#error "LORAMAC_CONTEXTS must be greater than 1"
+#endif
+
+#define TEST_DEVICES                                LORAMAC_CONTEXTS
+
+/*!
+ * Time slot of a device: its frame and reception windows [us]
+ */
+#define TEST_SLOT_US                                10000000ULL
+
+/*!
+ * Period of the frames of a device [us]
+ */
+#define TEST_PERIOD_US                              ( TEST_DEVICES * TEST_SLOT_US )
+
+/*!
+ * Frames sent by each device: the join request then the uplinks
+ */
+#define TEST_ROUNDS                                 4
+
+/*!
+ * Latest a device timer may fire [us]
+ */
+#define TEST_LATENESS_MAX_US                        1000
+
+#define TEST_DEV_ADDR                               0x26011B00
+
+/*!
+ * End-device simulated in its own LoRaMac context
+ */
+typedef struct Device_s
+{
+    uint8_t DevEui[8];
+    uint8_t AppKey[16];
+    TimerEvent_t TxTimer;   //!< Application timer of the next frame
+    uint64_t TxTimeUs;      //!< Time the next frame is due
+    uint64_t LatenessUs;    //!< Latest the TX timer fired
+    MockNetwork_t Session;  //!< Network server side, saved while off air
+    bool Joined;
+    uint32_t Refused;       //!< Requests refused by the MAC
+    uint32_t Confirms;      //!< Uplinks confirmed by the MAC
+    double CpuUs;           //!< Host CPU time of the MAC calls
+}Device_t;
+
+static Device_t Devices[TEST_DEVICES];
+
+/*!
+ * Device of the selected context
+ */
+static uint16_t Selected;
+
+/*!
+ * Device using the radio, its radio events are processed first
+ */
+static uint16_t OnAir;
+
+static int Failures;
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "  %s\n", message );
+        Failures++;
+    }
+}
+
+static double CpuTimeUs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+    return ( ts.tv_sec * 1e6 ) + ( ts.tv_nsec / 1e3 );
+}
+
+void __real_TimerIrqHandler( void );
+
+/*!
+ * The RTC alarm follows the list selected when it was set, it only wakes the
+ * core up. The lists are dispatched by the loop, each with its context.
+ */
+void __wrap_TimerIrqHandler( void )
+{
+}
+
+static void DeviceSelect( uint16_t id )
+{
+    Check( LoRaMacContextSelect( id ) == LORAMAC_STATUS_OK, "Context not selected" );
+    Selected = id;
+}
+
+static void OnMcpsConfirm( McpsConfirm_t *mcpsConfirm )
+{
+    if( mcpsConfirm->Status == LORAMAC_EVENT_INFO_STATUS_OK )
+    {
+        Devices[Selected].Confirms++;
+    }
+}
+
+static void OnMcpsIndication( McpsIndication_t *mcpsIndication )
+{
+}
+
+static void OnMlmeConfirm( MlmeConfirm_t *mlmeConfirm )
+{
+    if( ( mlmeConfirm->MlmeRequest == MLME_JOIN ) && ( mlmeConfirm->Status == LORAMAC_EVENT_INFO_STATUS_OK ) )
+    {
+        Devices[Selected].Joined = true;
+    }
+}
+
+static void OnMlmeIndication( MlmeIndication_t *mlmeIndication )
+{
+}
+
+static LoRaMacPrimitives_t Primitives =
+{
+    .MacMcpsConfirm = OnMcpsConfirm,
+    .MacMcpsIndication = OnMcpsIndication,
+    .MacMlmeConfirm = OnMlmeConfirm,
+    .MacMlmeIndication = OnMlmeIndication
+};
+
+static LoRaMacCallback_t Callbacks =
+{
+    .GetBatteryLevel = NULL,
+    .GetTemperatureLevel = NULL,
+    .NvmDataChange = NULL,
+    .MacProcessNotify = NULL
+};
+
+/*!
+ * \brief Sends the join request of the selected device, then its uplinks
+ */
+static void OnTxTimerEvent( void *context )
+{
+    Device_t *device = context;
+    uint16_t id = device - Devices;
+    uint64_t lateness = MockPico.TimeUs - device->TxTimeUs;
+    LoRaMacStatus_t status;
+
+    Check( id == Selected, "Timer dispatched with another context" );
+    if( lateness > device->LatenessUs )
+    {
+        device->LatenessUs = lateness;
+    }
+
+    // The network server follows the device taking the radio
+    Devices[OnAir].Session = MockNetwork;
+    MockNetwork = device->Session;
+    OnAir = id;
+
+    if( device->Joined == false )
+    {
+        MlmeReq_t mlmeReq;
+
+        mlmeReq.Type = MLME_JOIN;
+        mlmeReq.Req.Join.NetworkActivation = ACTIVATION_TYPE_OTAA;
+        mlmeReq.Req.Join.Datarate = DR_5;
+        status = LoRaMacMlmeRequest( &mlmeReq );
+    }
+    else
+    {
+        static uint8_t data[] = { 0x01, 0x67, 0x00, 0xE1 };
+        McpsReq_t mcpsReq;
+
+        mcpsReq.Type = MCPS_UNCONFIRMED;
+        mcpsReq.Req.Unconfirmed.fPort = 2;
+        mcpsReq.Req.Unconfirmed.fBuffer = data;
+        mcpsReq.Req.Unconfirmed.fBufferSize = sizeof( data );
+        mcpsReq.Req.Unconfirmed.Datarate = DR_5;
+        status = LoRaMacMcpsRequest( &mcpsReq );
+    }
+    if( status != LORAMAC_STATUS_OK )
+    {
+        device->Refused++;
+    }
+
+    device->TxTimeUs += TEST_PERIOD_US;
+    TimerSetValue( &device->TxTimer, ( device->TxTimeUs - MockPico.TimeUs + 999 ) / 1000 );
+    TimerStart( &device->TxTimer );
+}
+
+/*!
+ * \brief Fires the expired timers of a device, then processes its MAC
+ */
+static void DeviceProcess( uint16_t id )
+{
+    double start = CpuTimeUs( );
+    TimerTick_t ticks;
+
+    DeviceSelect( id );
+    while( ( TimerGetNextExpiry( &ticks ) == true ) && ( ticks == 0 ) )
+    {
+        __real_TimerIrqHandler( );
+    }
+    Radio.IrqProcess( );
+    LoRaMacProcess( );
+    Devices[id].CpuUs += CpuTimeUs( ) - start;
+}
+
+static void OnWakeup( void *context )
+{
+}
+
+/*!
+ * \brief Runs the devices until the given time, sleeping until the next
+ *        timer of any list or the next radio interrupt
+ */
+static void ProcessUntil( uint64_t endUs )
+{
+    while( ( MockPico.TimeUs < endUs ) && ( MockPico.Stalls == 0 ) )
+    {
+        uint64_t next = endUs;
+        TimerTick_t ticks;
+
+        // The radio events are processed by the selected context, the device
+        // on air comes first
+        for( uint16_t i = 0; i < TEST_DEVICES; i++ )
+        {
+            DeviceProcess( ( OnAir + i ) % TEST_DEVICES );
+        }
+
+        for( uint16_t id = 0; id < TEST_DEVICES; id++ )
+        {
+            DeviceSelect( id );
+            if( ( TimerGetNextExpiry( &ticks ) == true ) && ( ( MockPico.TimeUs + ticks ) < next ) )
+            {
+                next = MockPico.TimeUs + ticks;
+            }
+        }
+        if( next > MockPico.TimeUs )
+        {
+            int32_t wakeup = MockIrqSchedule( next, OnWakeup, NULL );
+
+            __wfi( );
+            MockIrqCancel( wakeup );
+        }
+    }
+}
+
+static void RadioInit( void )
+{
+    RtcInit( );
+    SpiInit( &SX126x.Spi, SPI_2, RADIO_MOSI, RADIO_MISO, RADIO_SCLK, NC );
+    SX126x.Spi.Nss.pin = RADIO_NSS;
+    SX126x.BUSY.pin = RADIO_BUSY;
+    SX126x.Reset.pin = RADIO_RESET;
+    SX126x.DIO1.pin = RADIO_DIO_1;
+    SX126xIoInit( );
+}
+
+static void DeviceInit( uint16_t id )
+{
+    Device_t *device = &Devices[id];
+    MibRequestConfirm_t mibReq;
+    uint8_t joinEui[8] = { 0x70, 0xB3, 0xD5, 0x7E, 0xD0, 0x00, 0x00, 0x01 };
+    uint8_t devEui[8] = { 0x70, 0xB3, 0xD5, 0x7E, 0xD0, 0x01, 0x00, id };
+    uint8_t appKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                           0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, id };
+
+    memcpy( device->DevEui, devEui, sizeof( devEui ) );
+    memcpy( device->AppKey, appKey, sizeof( appKey ) );
+    MockNetworkJoinInit( devEui, appKey, TEST_DEV_ADDR + id );
+    device->Session = MockNetwork;
+
+    DeviceSelect( id );
+    Check( LoRaMacInitialization( &Primitives, &Callbacks, LORAMAC_REGION_EU868 ) == LORAMAC_STATUS_OK,
+           "MAC not initialized" );
+
+    mibReq.Type = MIB_DEV_EUI;
+    mibReq.Param.DevEui = device->DevEui;
+    LoRaMacMibSetRequestConfirm( &mibReq );
+    mibReq.Type = MIB_JOIN_EUI;
+    mibReq.Param.JoinEui = joinEui;
+    LoRaMacMibSetRequestConfirm( &mibReq );
+    // LoRaWAN 1.0.x derives the session keys from the NwkKey
+    mibReq.Type = MIB_APP_KEY;
+    mibReq.Param.AppKey = device->AppKey;
+    LoRaMacMibSetRequestConfirm( &mibReq );
+    mibReq.Type = MIB_NWK_KEY;
+    mibReq.Param.NwkKey = device->AppKey;
+    LoRaMacMibSetRequestConfirm( &mibReq );
+    mibReq.Type = MIB_ADR;
+    mibReq.Param.AdrEnable = false;
+    LoRaMacMibSetRequestConfirm( &mibReq );
+    mibReq.Type = MIB_PUBLIC_NETWORK;
+    mibReq.Param.EnablePublicNetwork = true;
+    LoRaMacMibSetRequestConfirm( &mibReq );
+    mibReq.Type = MIB_SYSTEM_MAX_RX_ERROR;
+    mibReq.Param.SystemMaxRxError = 20;
+    LoRaMacMibSetRequestConfirm( &mibReq );
+    Check( LoRaMacStart( ) == LORAMAC_STATUS_OK, "MAC not started" );
+
+    // Started in the timer list of the device
+    device->TxTimeUs = MockPico.TimeUs + ( ( id + 1 ) * TEST_SLOT_US );
+    TimerInit( &device->TxTimer, OnTxTimerEvent );
+    TimerSetContext( &device->TxTimer, device );
+    TimerSetValue( &device->TxTimer, ( device->TxTimeUs - MockPico.TimeUs + 999 ) / 1000 );
+    TimerStart( &device->TxTimer );
+    device->CpuUs = 0;
+}
+
+int main( void )
+{
+    MibRequestConfirm_t mibReq;
+    double cpuMin = 1e12;
+    double cpuMax = 0;
+    double cpuSum = 0;
+
+    MockPicoReset( 0 );
+    MockRadio.Air = true;
+    MockRadio.OnTx = MockNetworkOnTx;
+
+    RadioInit( );
+    for( uint16_t id = 0; id < TEST_DEVICES; id++ )
+    {
+        DeviceInit( id );
+    }
+    MockNetwork = Devices[OnAir].Session;
+
+    // The slot of the last frame of the last device ends the run
+    ProcessUntil( Devices[0].TxTimeUs + ( TEST_ROUNDS * TEST_PERIOD_US ) );
+    Devices[OnAir].Session = MockNetwork;
+
+    for( uint16_t id = 0; id < TEST_DEVICES; id++ )
+    {
+        Device_t *device = &Devices[id];
+
+        DeviceSelect( id );
+        mibReq.Type = MIB_DEV_ADDR;
+        LoRaMacMibGetRequestConfirm( &mibReq );
+
+        Check( device->Joined == true, "Device not joined" );
+        Check( device->Session.Joins == 1, "Join not accepted by the network" );
+        Check( mibReq.Param.DevAddr == ( TEST_DEV_ADDR + id ), "Device address of another device" );
+        Check( device->Refused == 0, "Request refused by the MAC" );
+        Check( device->Confirms == ( TEST_ROUNDS - 1 ), "Uplinks not confirmed" );
+        Check( device->Session.Uplinks == ( TEST_ROUNDS - 1 ), "Uplinks not received by the network" );
+        Check( device->Session.Errors == 0, "Frames rejected by the network" );
+        Check( device->LatenessUs <= TEST_LATENESS_MAX_US, "Device timer fired late" );
+
+        cpuSum += device->CpuUs;
+        cpuMin = ( device->CpuUs < cpuMin ) ? device->CpuUs : cpuMin;
+        cpuMax = ( device->CpuUs > cpuMax ) ? device->CpuUs : cpuMax;
+    }
+    Check( MockPico.Stalls == 0, "Slept without a wake up source" );
+
+    printf( "%u devices, a join and %u uplinks each: %.0f us MAC CPU per device (min %.0f, max %.0f)\n",
+            TEST_DEVICES, TEST_ROUNDS - 1, cpuSum / TEST_DEVICES, cpuMin, cpuMax );
+
+    printf( "lorawan contexts: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
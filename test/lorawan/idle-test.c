@@ -0,0 +1,182 @@
+/*!
+ * \file      idle-test.c
+ *
+ * \brief     Runs the pico_lorawan loop for a simulated hour on the mock
+ *            radio, first idle, then with a periodic uplink, and reports the
+ *            loop iterations and the host CPU time. An idle iteration must
+ *            not enter LmHandlerProcess.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "pico/lorawan.h"
+#include "mock-pico.h"
+#include "mock-board.h"
+#include "mock-flash.h"
+
+/*!
+ * Simulated time of each run [us]
+ */
+#define TEST_RUN_US                                 3600000000ULL
+
+/*!
+ * Timeout given to lorawan_process_timeout_ms [ms]
+ */
+#define TEST_TIMEOUT_MS                             60000
+
+/*!
+ * Period of the uplinks of the second run [ms]
+ */
+#define TEST_UPLINK_PERIOD_MS                       300000
+
+/*!
+ * Most LmHandlerProcess calls expected for an uplink: the TX done, the
+ * reception windows and the MCPS confirm
+ */
+#define TEST_PROCESS_PER_UPLINK_MAX                 8
+
+static int Failures;
+
+/*!
+ * LmHandlerProcess calls, counted through the linker wrap
+ */
+static uint32_t HandlerProcessCalls;
+
+static const struct lorawan_sx12xx_settings Sx12xxSettings =
+{
+    .spi = { .inst = spi1, .mosi = 11, .miso = 12, .sck = 10, .nss = 3 },
+    .reset = 15,
+    .busy = 2,
+    .dio1 = 20
+};
+
+static const struct lorawan_abp_settings AbpSettings =
+{
+    .device_address = "26011BDA",
+    .network_session_key = "2B7E151628AED2A6ABF7158809CF4F3C",
+    .app_session_key = "3C4FCF098815F7ABA6D2AE2816157E2B",
+    .channel_mask = NULL
+};
+
+void __real_LmHandlerProcess( void );
+
+void __wrap_LmHandlerProcess( void )
+{
+    HandlerProcessCalls++;
+    __real_LmHandlerProcess( );
+}
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "  %s\n", message );
+        Failures++;
+    }
+}
+
+static double CpuTimeUs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+    return ( ts.tv_sec * 1e6 ) + ( ts.tv_nsec / 1e3 );
+}
+
+/*!
+ * \brief Loop statistics of a run
+ */
+typedef struct Run_s
+{
+    uint32_t Iterations;    //!< Sleeps of the loop, each followed by a lorawan_process
+    uint32_t Process;       //!< LmHandlerProcess calls
+    double CpuUs;           //!< Host CPU time
+}Run_t;
+
+static void RunStart( Run_t *run )
+{
+    run->Iterations = MockPico.Wakeups;
+    run->Process = HandlerProcessCalls;
+    run->CpuUs = CpuTimeUs( );
+}
+
+static void RunEnd( Run_t *run, const char *name )
+{
+    run->Iterations = MockPico.Wakeups - run->Iterations;
+    run->Process = HandlerProcessCalls - run->Process;
+    run->CpuUs = CpuTimeUs( ) - run->CpuUs;
+
+    printf( "%-8s %6u loop iterations, %5u LmHandlerProcess calls, %8.0f us host CPU per simulated hour\n", name,
+            run->Iterations, run->Process, run->CpuUs * 3600e6 / TEST_RUN_US );
+}
+
+/*!
+ * \brief Runs the loop as the applications do until the given time
+ */
+static void ProcessUntil( uint64_t endUs )
+{
+    while( MockPico.TimeUs < endUs )
+    {
+        uint64_t left = ( endUs - MockPico.TimeUs + 999 ) / 1000;
+
+        lorawan_process_timeout_ms( ( left < TEST_TIMEOUT_MS ) ? left : TEST_TIMEOUT_MS );
+    }
+}
+
+int main( void )
+{
+    Run_t run;
+    uint8_t data[] = { 0x01, 0x67, 0x00, 0xE1 };
+    uint32_t uplinks = 0;
+
+    MockPicoReset( 0 );
+    MockFlashReset( );
+    MockRadio.Air = true;
+
+    Check( lorawan_init_abp( &Sx12xxSettings, LORAMAC_REGION_EU868, &AbpSettings ) == 0, "Stack not initialized" );
+    lorawan_join( );
+    Check( lorawan_is_joined( ) == 1, "ABP activation failed" );
+
+    // Lets the activation settle
+    ProcessUntil( MockPico.TimeUs + 10000000 );
+
+    // An idle call does not process the MAC
+    uint32_t process = HandlerProcessCalls;
+    Check( lorawan_process( ) == 1, "Idle loop does not sleep" );
+    Check( HandlerProcessCalls == process, "Idle call entered LmHandlerProcess" );
+    Check( lorawan_next_wakeup_us( ) == UINT64_MAX, "Idle stack reports a deadline" );
+
+    RunStart( &run );
+    ProcessUntil( MockPico.TimeUs + TEST_RUN_US );
+    RunEnd( &run, "idle" );
+    Check( run.Process == 0, "Idle loop entered LmHandlerProcess" );
+    Check( run.Iterations <= ( ( TEST_RUN_US / 1000 ) / TEST_TIMEOUT_MS ) + 1, "Idle loop woke up without a deadline" );
+    Check( MockPico.Stalls == 0, "Slept without a wake up source" );
+
+    // The random number generator also starts receptions
+    MockRadio.TxCount = 0;
+    MockRadio.RxCount = 0;
+    RunStart( &run );
+    uint64_t end = MockPico.TimeUs + TEST_RUN_US;
+    for( uint64_t next = MockPico.TimeUs; next < end; next += TEST_UPLINK_PERIOD_MS * 1000ULL )
+    {
+        ProcessUntil( next );
+        if( lorawan_send_unconfirmed( data, sizeof( data ), 2 ) == 0 )
+        {
+            uplinks++;
+        }
+    }
+    ProcessUntil( end );
+    RunEnd( &run, "uplinks" );
+    printf( "%u uplinks sent, %u frames on air, %u receive windows\n", uplinks, MockRadio.TxCount, MockRadio.RxCount );
+    Check( uplinks == ( TEST_RUN_US / ( TEST_UPLINK_PERIOD_MS * 1000ULL ) ), "Uplinks refused" );
+    Check( MockRadio.TxCount == uplinks, "Uplinks not sent on air" );
+    Check( MockRadio.RxCount == ( 2 * uplinks ), "Receive windows not opened" );
+    Check( run.Process <= ( uplinks * TEST_PROCESS_PER_UPLINK_MAX ), "LmHandlerProcess entered without MAC events" );
+    Check( MockPico.Stalls == 0, "Slept without a wake up source" );
+
+    printf( "lorawan idle: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
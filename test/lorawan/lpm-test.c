@@ -0,0 +1,344 @@
+/*!
+ * \file      lpm-test.c
+ *
+ * \brief     Runs the low power manager of the RP2040 board on the simulated
+ *            clock: wake up accuracy and sleep depth against the timer list,
+ *            average current of a reference uplink schedule, and a radio
+ *            interrupt raised before every interrupt disable of the loop,
+ *            which must not leave the core asleep with work pending
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+
+#include "pico/lorawan.h"
+#include "board.h"
+#include "lpm-board.h"
+#include "timer.h"
+#include "utilities.h"
+#include "mock-pico.h"
+#include "mock-board.h"
+#include "mock-flash.h"
+
+/*!
+ * Reference schedule: a 4 byte uplink every 5 minutes for an hour
+ */
+#define TEST_RUN_US                                 3600000000ULL
+#define TEST_UPLINK_PERIOD_US                       300000000ULL
+
+/*!
+ * Rough datasheet currents [uA]: RP2040 running at 125 MHz, sleeping with
+ * the clocks running, sleeping with the clocks gated; SX1262 sleeping with
+ * a warm start, in standby, receiving and transmitting at 14 dBm with the
+ * DC-DC converter
+ */
+#define TEST_MCU_RUN_UA                             20000.0
+#define TEST_MCU_SLEEP_UA                           10000.0
+#define TEST_MCU_STOP_UA                            1300.0
+#define TEST_RADIO_SLEEP_UA                         0.6
+#define TEST_RADIO_STANDBY_UA                       600.0
+#define TEST_RADIO_RX_UA                            4600.0
+#define TEST_RADIO_TX_UA                            45000.0
+
+/*!
+ * Budget of the reference schedule, the clock gated sleep dominates
+ */
+#define TEST_AVERAGE_UA_MAX                         2000.0
+
+/*!
+ * Longest time from a radio interrupt to the MAC processing it [us]
+ */
+#define TEST_IRQ_LATENCY_MAX_US                     1000
+
+static int Failures;
+
+static const struct lorawan_sx12xx_settings Sx12xxSettings =
+{
+    .spi = { .inst = spi1, .mosi = 11, .miso = 12, .sck = 10, .nss = 3 },
+    .reset = 15,
+    .busy = 2,
+    .dio1 = 20
+};
+
+static const struct lorawan_abp_settings AbpSettings =
+{
+    .device_address = "26011BDA",
+    .network_session_key = "2B7E151628AED2A6ABF7158809CF4F3C",
+    .app_session_key = "3C4FCF098815F7ABA6D2AE2816157E2B",
+    .channel_mask = NULL
+};
+
+static const uint8_t Data[] = { 0x01, 0x67, 0x00, 0xE1 };
+
+/*!
+ * Lost wake up sweep: the transmission ends before the Target-th interrupt
+ * disable following the start of the transmission
+ */
+static struct
+{
+    uint32_t Target;
+    uint32_t Disables;
+    uint64_t IrqUs;         //!< Time the interrupt was raised at, 0 when not yet
+    uint64_t ProcessUs;     //!< First MAC processing after the interrupt
+}Sweep;
+
+static bool TimerFired;
+static uint64_t TimerFiredUs;
+
+void __real_LmHandlerProcess( void );
+
+void __wrap_LmHandlerProcess( void )
+{
+    if( ( Sweep.IrqUs != 0 ) && ( Sweep.ProcessUs == 0 ) )
+    {
+        Sweep.ProcessUs = MockPico.TimeUs;
+    }
+    __real_LmHandlerProcess( );
+}
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "  %s\n", message );
+        Failures++;
+    }
+}
+
+static void OnTimer( void *context )
+{
+    TimerFired = true;
+    TimerFiredUs = MockPico.TimeUs;
+}
+
+static void OnIrq( void *context )
+{
+    TimerFired = true;
+    TimerFiredUs = MockPico.TimeUs;
+}
+
+/*!
+ * \brief Sleeps as the applications do until the flag is set
+ */
+static void SleepUntilFired( void )
+{
+    while( ( TimerFired == false ) && ( MockPico.Stalls == 0 ) )
+    {
+        CRITICAL_SECTION_BEGIN( );
+        if( TimerFired == false )
+        {
+            BoardLowPowerHandler( );
+        }
+        CRITICAL_SECTION_END( );
+    }
+}
+
+/*!
+ * \brief Sleeps until a timer expires, checks the wake up time and the
+ *        sleep depth picked for it
+ *
+ * \param [IN] durationMs Timer duration
+ * \param [IN] stop       Whether the clock gated sleep is expected
+ */
+static void WakeupCheck( uint32_t durationMs, bool stop )
+{
+    TimerEvent_t timer;
+    LpmStats_t before = *LpmGetStats( );
+    uint64_t expectedUs = MockPico.TimeUs + ( durationMs * 1000 );
+
+    TimerFired = false;
+    TimerInit( &timer, OnTimer );
+    TimerSetValue( &timer, durationMs );
+    TimerStart( &timer );
+    SleepUntilFired( );
+
+    const LpmStats_t *after = LpmGetStats( );
+    uint32_t stops = after->StopCount - before.StopCount;
+    uint32_t sleeps = after->SleepCount - before.SleepCount;
+
+    printf( "%5u ms timer: woke up at %+lld us, %u clock gated and %u plain sleeps\n", durationMs,
+            ( long long )( TimerFiredUs - expectedUs ), stops, sleeps );
+    Check( TimerFired == true, "Timer did not wake the core up" );
+    Check( TimerFiredUs == expectedUs, "Core woke up late" );
+    Check( ( stop == true ) ? ( ( stops > 0 ) && ( sleeps == 0 ) ) : ( ( stops == 0 ) && ( sleeps > 0 ) ),
+           "Sleep depth wrong for the timer" );
+}
+
+/*!
+ * \brief Sleeps with a long timer running, a DIO1 like interrupt wakes the
+ *        core up first
+ */
+static void IrqWakeupCheck( void )
+{
+    TimerEvent_t timer;
+    uint64_t expectedUs = MockPico.TimeUs + 5123;
+
+    TimerFired = false;
+    TimerInit( &timer, NULL );
+    TimerSetValue( &timer, 1000 );
+    TimerStart( &timer );
+    MockIrqSchedule( expectedUs, OnIrq, NULL );
+    SleepUntilFired( );
+    TimerStop( &timer );
+
+    printf( "interrupt: woke up at %+lld us\n", ( long long )( TimerFiredUs - expectedUs ) );
+    Check( TimerFiredUs == expectedUs, "Interrupt did not wake the core up on time" );
+}
+
+/*!
+ * \brief Runs the loop as the applications do until the given time
+ */
+static void ProcessUntil( uint64_t endUs )
+{
+    while( ( MockPico.TimeUs < endUs ) && ( MockPico.Stalls == 0 ) )
+    {
+        lorawan_process_timeout_ms( ( endUs - MockPico.TimeUs + 999 ) / 1000 );
+    }
+}
+
+/*!
+ * \brief Estimates the average current of the reference uplink schedule from
+ *        the time spent by the core and the radio in each state
+ */
+static void CurrentCheck( void )
+{
+    LpmStats_t before = *LpmGetStats( );
+    uint64_t deepSleepUs = MockPico.DeepSleepUs;
+    uint64_t radioUs[MOCK_RADIO_STATES];
+    uint32_t uplinks = 0;
+
+    MockRadioStateUpdate( );
+    for( uint8_t i = 0; i < MOCK_RADIO_STATES; i++ )
+    {
+        radioUs[i] = MockRadio.StateUs[i];
+    }
+
+    uint64_t end = MockPico.TimeUs + TEST_RUN_US;
+    for( uint64_t next = MockPico.TimeUs; next < end; next += TEST_UPLINK_PERIOD_US )
+    {
+        ProcessUntil( next );
+        if( lorawan_send_unconfirmed( Data, sizeof( Data ), 2 ) == 0 )
+        {
+            uplinks++;
+        }
+    }
+    ProcessUntil( end );
+
+    const LpmStats_t *after = LpmGetStats( );
+    double runUs = after->RunTime - before.RunTime;
+    double sleepUs = after->SleepTime - before.SleepTime;
+    double stopUs = after->StopTime - before.StopTime;
+
+    MockRadioStateUpdate( );
+    for( uint8_t i = 0; i < MOCK_RADIO_STATES; i++ )
+    {
+        radioUs[i] = MockRadio.StateUs[i] - radioUs[i];
+    }
+
+    double mcuUa = ( ( runUs * TEST_MCU_RUN_UA ) + ( sleepUs * TEST_MCU_SLEEP_UA ) + ( stopUs * TEST_MCU_STOP_UA ) ) / TEST_RUN_US;
+    double radioUa = ( ( radioUs[MOCK_RADIO_SLEEP] * TEST_RADIO_SLEEP_UA ) + ( radioUs[MOCK_RADIO_STANDBY] * TEST_RADIO_STANDBY_UA ) +
+                       ( radioUs[MOCK_RADIO_RX] * TEST_RADIO_RX_UA ) + ( radioUs[MOCK_RADIO_TX] * TEST_RADIO_TX_UA ) ) / TEST_RUN_US;
+
+    printf( "%u uplinks in an hour\n", uplinks );
+    printf( "  MCU   run %9.0f us, sleep %9.0f us, clock gated %10.0f us: %7.1f uA\n", runUs, sleepUs, stopUs, mcuUa );
+    printf( "  radio tx %9llu us, rx %9llu us, standby %9llu us, sleep %10llu us: %7.1f uA\n",
+            ( unsigned long long )radioUs[MOCK_RADIO_TX], ( unsigned long long )radioUs[MOCK_RADIO_RX],
+            ( unsigned long long )radioUs[MOCK_RADIO_STANDBY], ( unsigned long long )radioUs[MOCK_RADIO_SLEEP], radioUa );
+    printf( "  average %.1f uA\n", mcuUa + radioUa );
+
+    Check( uplinks == ( TEST_RUN_US / TEST_UPLINK_PERIOD_US ), "Uplinks refused" );
+    Check( ( MockPico.DeepSleepUs - deepSleepUs ) == ( after->StopTime - before.StopTime ), "Clock gated sleep time misreported" );
+    Check( stopUs > ( 0.99 * TEST_RUN_US ), "Clock gated sleep not used between the uplinks" );
+    Check( radioUs[MOCK_RADIO_SLEEP] > ( 0.99 * TEST_RUN_US ), "Radio not sleeping between the uplinks" );
+    Check( ( mcuUa + radioUa ) < TEST_AVERAGE_UA_MAX, "Average current over budget" );
+}
+
+/*!
+ * \brief Ends the transmission before the target interrupt disable
+ */
+static void BeforeDisable( void )
+{
+    if( ( Sweep.IrqUs != 0 ) || ( MockRadio.State != MOCK_RADIO_TX ) )
+    {
+        return;
+    }
+    if( ++Sweep.Disables == Sweep.Target )
+    {
+        Sweep.IrqUs = MockPico.TimeUs;
+        MockAirNow( );
+    }
+}
+
+/*!
+ * \brief Raises the transmission done interrupt before every interrupt
+ *        disable of the loop in turn, until the transmission ends on its own
+ */
+static void LostWakeupCheck( void )
+{
+    uint32_t targets = 0;
+    uint64_t latencyMax = 0;
+    uint32_t late = 0;
+
+    MockPico.BeforeDisable = BeforeDisable;
+    for( Sweep.Target = 1; ; Sweep.Target++ )
+    {
+        Sweep.Disables = 0;
+        Sweep.IrqUs = 0;
+        Sweep.ProcessUs = 0;
+
+        // The duty cycle hold off is left to expire
+        ProcessUntil( MockPico.TimeUs + TEST_UPLINK_PERIOD_US );
+        if( lorawan_send_unconfirmed( Data, sizeof( Data ), 2 ) != 0 )
+        {
+            Check( false, "Uplink refused" );
+            break;
+        }
+        ProcessUntil( MockPico.TimeUs + 10000000 );
+
+        if( Sweep.IrqUs == 0 )
+        {
+            // The transmission ended while the core slept
+            break;
+        }
+        targets++;
+
+        uint64_t latency = ( Sweep.ProcessUs != 0 ) ? ( Sweep.ProcessUs - Sweep.IrqUs ) : UINT64_MAX;
+
+        if( latency > TEST_IRQ_LATENCY_MAX_US )
+        {
+            printf( "  interrupt before disable #%u processed after %lld us\n", Sweep.Target, ( long long )latency );
+            late++;
+        }
+        latencyMax = MAX( latencyMax, latency );
+    }
+    MockPico.BeforeDisable = NULL;
+
+    printf( "transmission done before %u interrupt disables in turn: %u processed late, latency up to %llu us\n",
+            targets, late, ( unsigned long long )latencyMax );
+    Check( targets > 0, "Interrupt never raised before a disable" );
+    Check( late == 0, "Core slept with a radio interrupt to process" );
+    Check( MockPico.Stalls == 0, "Slept without a wake up source" );
+}
+
+int main( void )
+{
+    MockPicoReset( 0 );
+    MockFlashReset( );
+    MockRadio.Air = true;
+
+    Check( lorawan_init_abp( &Sx12xxSettings, LORAMAC_REGION_EU868, &AbpSettings ) == 0, "Stack not initialized" );
+    lorawan_join( );
+    ProcessUntil( MockPico.TimeUs + 10000000 );
+
+    WakeupCheck( 1, false );
+    WakeupCheck( 2, true );
+    WakeupCheck( 10, true );
+    WakeupCheck( 1000, true );
+    IrqWakeupCheck( );
+
+    CurrentCheck( );
+    LostWakeupCheck( );
+
+    printf( "lpm: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+/*!
+ * \file      mock-aes.c
+ *
+ * \brief     AES block cipher of the network server, built from the soft-se
+ *            implementation with its decryption enabled. Its functions are
+ *            renamed, the soft-se ones are linked as well.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#define AES_DEC_PREKEYED
+#define aes_set_key                                 MockAesSetKey
+#define aes_encrypt                                 MockAesEncryptBlock
+#define aes_cbc_encrypt                             MockAesCbcEncrypt
+#define aes_decrypt                                 MockAesDecryptBlock
+#define aes_cbc_decrypt                             MockAesCbcDecrypt
+
+#include "aes.c"
+
+#include "mock-aes.h"
+
+void MockAesEncrypt( const uint8_t key[16], const uint8_t in[16], uint8_t out[16] )
+{
+    aes_context ctx;
+
+    aes_set_key( key, 16, &ctx );
+    aes_encrypt( in, out, &ctx );
+}
+
+void MockAesDecrypt( const uint8_t key[16], const uint8_t in[16], uint8_t out[16] )
+{
+    aes_context ctx;
+
+    aes_set_key( key, 16, &ctx );
+    aes_decrypt( in, out, &ctx );
+}
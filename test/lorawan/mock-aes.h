@@ -0,0 +1,32 @@
+/*!
+ * \file      mock-aes.h
+ *
+ * \brief     AES block cipher of the network server. The end-device only
+ *            encrypts, the network server decrypts to encrypt a join accept.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#ifndef __MOCK_AES_H__
+#define __MOCK_AES_H__
+
+#include <stdint.h>
+
+/*!
+ * \brief Encrypts a block with AES-128
+ *
+ * \param [IN]  key Key
+ * \param [IN]  in  Block to encrypt
+ * \param [OUT] out Encrypted block
+ */
+void MockAesEncrypt( const uint8_t key[16], const uint8_t in[16], uint8_t out[16] );
+
+/*!
+ * \brief Decrypts a block with AES-128
+ *
+ * \param [IN]  key Key
+ * \param [IN]  in  Block to decrypt
+ * \param [OUT] out Decrypted block
+ */
+void MockAesDecrypt( const uint8_t key[16], const uint8_t in[16], uint8_t out[16] );
+
+#endif // __MOCK_AES_H__
@@ -0,0 +1,271 @@
+/*!
+ * \file      mock-network.c
+ *
+ * \brief     Network server side of the simulated air
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "cmac.h"
+#include "mock-aes.h"
+#include "mock-board.h"
+#include "mock-network.h"
+
+#define MOCK_MHDR_JOIN_REQUEST                      0x00
+#define MOCK_MHDR_JOIN_ACCEPT                       0x20
+#define MOCK_MHDR_UNCONFIRMED_DATA_UP               0x40
+#define MOCK_MHDR_UNCONFIRMED_DATA_DOWN             0x60
+#define MOCK_MHDR_CONFIRMED_DATA_UP                 0x80
+
+/*!
+ * FOptsLen field of the FCtrl
+ */
+#define MOCK_FCTRL_FOPTS_LEN_MASK                   0x0F
+
+/*!
+ * MHDR, DevAddr, FCtrl and FCnt
+ */
+#define MOCK_FHDR_SIZE                              8
+#define MOCK_MIC_SIZE                               4
+
+/*!
+ * MHDR, JoinEUI, DevEUI, DevNonce and MIC
+ */
+#define MOCK_JOIN_REQUEST_SIZE                      23
+#define MOCK_JOIN_REQUEST_DEV_EUI                   9
+#define MOCK_JOIN_REQUEST_DEV_NONCE                 17
+
+/*!
+ * MHDR, JoinNonce, NetID, DevAddr, DLSettings, RxDelay and MIC, without
+ * CFList
+ */
+#define MOCK_JOIN_ACCEPT_SIZE                       17
+
+#define MOCK_NET_ID                                 0x000013
+
+/*!
+ * RX1 delay given by the join accept [s]
+ */
+#define MOCK_RX_DELAY                               1
+
+MockNetwork_t MockNetwork;
+
+void MockNetworkInit( uint32_t devAddr, const char *nwkSKey )
+{
+    memset( &MockNetwork, 0, sizeof( MockNetwork ) );
+    MockNetwork.DevAddr = devAddr;
+    for( uint8_t i = 0; i < 16; i++ )
+    {
+        sscanf( nwkSKey + ( i * 2 ), "%2hhx", &MockNetwork.NwkSKey[i] );
+    }
+}
+
+void MockNetworkJoinInit( const uint8_t *devEui, const uint8_t *appKey, uint32_t devAddr )
+{
+    memset( &MockNetwork, 0, sizeof( MockNetwork ) );
+    memcpy( MockNetwork.DevEui, devEui, sizeof( MockNetwork.DevEui ) );
+    memcpy( MockNetwork.AppKey, appKey, sizeof( MockNetwork.AppKey ) );
+    MockNetwork.DevAddr = devAddr;
+}
+
+static uint32_t MockGet32( const uint8_t *buffer )
+{
+    return buffer[0] | ( buffer[1] << 8 ) | ( buffer[2] << 16 ) | ( ( uint32_t )buffer[3] << 24 );
+}
+
+static void MockPut24( uint8_t *buffer, uint32_t value )
+{
+    buffer[0] = value;
+    buffer[1] = value >> 8;
+    buffer[2] = value >> 16;
+}
+
+static void MockPut32( uint8_t *buffer, uint32_t value )
+{
+    MockPut24( buffer, value );
+    buffer[3] = value >> 24;
+}
+
+/*!
+ * \brief Computes the MIC of a join frame
+ *
+ * \param [IN] buffer Frame without its MIC
+ * \param [IN] size   Frame size without the MIC
+ * \retval mic Frame MIC
+ */
+static uint32_t MockJoinMic( const uint8_t *buffer, uint8_t size )
+{
+    AES_CMAC_CTX ctx;
+    uint8_t digest[AES_CMAC_DIGEST_LENGTH];
+
+    AES_CMAC_Init( &ctx );
+    AES_CMAC_SetKey( &ctx, MockNetwork.AppKey );
+    AES_CMAC_Update( &ctx, buffer, size );
+    AES_CMAC_Final( digest, &ctx );
+    return MockGet32( digest );
+}
+
+/*!
+ * \brief Computes the MIC of a data frame
+ *
+ * \param [IN] buffer Frame without its MIC
+ * \param [IN] size   Frame size without the MIC
+ * \param [IN] downlink Frame direction
+ * \param [IN] fCnt   Full frame counter
+ * \retval mic Frame MIC
+ */
+static uint32_t MockDataMic( const uint8_t *buffer, uint8_t size, bool downlink, uint32_t fCnt )
+{
+    AES_CMAC_CTX ctx;
+    uint8_t b0[16] = { 0x49 };
+    uint8_t digest[AES_CMAC_DIGEST_LENGTH];
+
+    b0[5] = ( downlink == true ) ? 1 : 0;
+    MockPut32( &b0[6], MockNetwork.DevAddr );
+    MockPut32( &b0[10], fCnt );
+    b0[15] = size;
+
+    AES_CMAC_Init( &ctx );
+    AES_CMAC_SetKey( &ctx, MockNetwork.NwkSKey );
+    AES_CMAC_Update( &ctx, b0, sizeof( b0 ) );
+    AES_CMAC_Update( &ctx, buffer, size );
+    AES_CMAC_Final( digest, &ctx );
+    return MockGet32( digest );
+}
+
+/*!
+ * \brief Queues a downlink carrying the pending MAC commands, if any
+ */
+static void MockDownlinkSend( void )
+{
+    uint8_t *buffer = MockRadio.Downlink.Buffer;
+    uint8_t size = 0;
+
+    buffer[size++] = MOCK_MHDR_UNCONFIRMED_DATA_DOWN;
+    MockPut32( &buffer[size], MockNetwork.DevAddr );
+    size += 4;
+    buffer[size++] = MockNetwork.FOptsSize;
+    buffer[size++] = MockNetwork.FCntDown;
+    buffer[size++] = MockNetwork.FCntDown >> 8;
+    memcpy( &buffer[size], MockNetwork.FOpts, MockNetwork.FOptsSize );
+    size += MockNetwork.FOptsSize;
+
+    MockPut32( &buffer[size], MockDataMic( buffer, size, true, MockNetwork.FCntDown ) );
+    size += MOCK_MIC_SIZE;
+
+    MockRadio.Downlink.Size = size;
+    MockNetwork.FCntDown++;
+    MockNetwork.FOptsSize = 0;
+}
+
+/*!
+ * \brief Accepts a join request, queues the join accept and derives the
+ *        network session key
+ *
+ * \param [IN] buffer Join request
+ */
+static void MockJoinAccept( const uint8_t *buffer )
+{
+    uint8_t accept[MOCK_JOIN_ACCEPT_SIZE];
+    uint8_t keyBase[16] = { 0x01 };
+    uint8_t size = 0;
+
+    MockNetwork.JoinNonce++;
+    accept[size++] = MOCK_MHDR_JOIN_ACCEPT;
+    MockPut24( &accept[size], MockNetwork.JoinNonce );
+    size += 3;
+    MockPut24( &accept[size], MOCK_NET_ID );
+    size += 3;
+    MockPut32( &accept[size], MockNetwork.DevAddr );
+    size += 4;
+    // RX1 DR offset 0, RX2 DR0
+    accept[size++] = 0x00;
+    accept[size++] = MOCK_RX_DELAY;
+    MockPut32( &accept[size], MockJoinMic( accept, size ) );
+
+    // Encrypted with an AES decryption, the end-device only encrypts
+    MockRadio.Downlink.Buffer[0] = accept[0];
+    MockAesDecrypt( MockNetwork.AppKey, &accept[1], &MockRadio.Downlink.Buffer[1] );
+    MockRadio.Downlink.Size = MOCK_JOIN_ACCEPT_SIZE;
+
+    // NwkSKey = aes128_encrypt( AppKey, 0x01 | JoinNonce | NetID | DevNonce | pad16 )
+    MockPut24( &keyBase[1], MockNetwork.JoinNonce );
+    MockPut24( &keyBase[4], MOCK_NET_ID );
+    keyBase[7] = buffer[MOCK_JOIN_REQUEST_DEV_NONCE];
+    keyBase[8] = buffer[MOCK_JOIN_REQUEST_DEV_NONCE + 1];
+    MockAesEncrypt( MockNetwork.AppKey, keyBase, MockNetwork.NwkSKey );
+
+    MockNetwork.FCntDown = 0;
+    MockNetwork.Joins++;
+}
+
+/*!
+ * \brief Checks a join request, it is accepted when it is valid
+ *
+ * \param [IN] buffer Frame
+ * \param [IN] size   Frame size
+ */
+static void MockJoinRequest( const uint8_t *buffer, uint8_t size )
+{
+    if( size != MOCK_JOIN_REQUEST_SIZE )
+    {
+        MockNetwork.Errors++;
+        return;
+    }
+    // The DevEUI is sent little endian
+    for( uint8_t i = 0; i < sizeof( MockNetwork.DevEui ); i++ )
+    {
+        if( buffer[MOCK_JOIN_REQUEST_DEV_EUI + i] != MockNetwork.DevEui[sizeof( MockNetwork.DevEui ) - 1 - i] )
+        {
+            MockNetwork.Errors++;
+            return;
+        }
+    }
+    if( MockJoinMic( buffer, size - MOCK_MIC_SIZE ) != MockGet32( &buffer[size - MOCK_MIC_SIZE] ) )
+    {
+        MockNetwork.Errors++;
+        return;
+    }
+    MockJoinAccept( buffer );
+}
+
+void MockNetworkOnTx( const uint8_t *buffer, uint8_t size )
+{
+    if( ( size > 0 ) && ( buffer[0] == MOCK_MHDR_JOIN_REQUEST ) )
+    {
+        MockJoinRequest( buffer, size );
+        return;
+    }
+    if( ( size < ( MOCK_FHDR_SIZE + MOCK_MIC_SIZE ) ) ||
+        ( ( buffer[0] != MOCK_MHDR_UNCONFIRMED_DATA_UP ) && ( buffer[0] != MOCK_MHDR_CONFIRMED_DATA_UP ) ) ||
+        ( MockGet32( &buffer[1] ) != MockNetwork.DevAddr ) )
+    {
+        MockNetwork.Errors++;
+        return;
+    }
+
+    // The sessions of the tests are short, the 16 upper bits are 0
+    uint32_t fCnt = buffer[6] | ( buffer[7] << 8 );
+
+    if( MockDataMic( buffer, size - MOCK_MIC_SIZE, false, fCnt ) != MockGet32( &buffer[size - MOCK_MIC_SIZE] ) )
+    {
+        MockNetwork.Errors++;
+        return;
+    }
+    MockNetwork.Uplinks++;
+
+    // The MAC answers are sent in the FOpts, or on the port 0 when there is
+    // no application payload
+    uint8_t fOptsLen = buffer[5] & MOCK_FCTRL_FOPTS_LEN_MASK;
+    bool macAnswers = ( fOptsLen > 0 ) ||
+                      ( ( size > ( MOCK_FHDR_SIZE + fOptsLen + MOCK_MIC_SIZE ) ) && ( buffer[MOCK_FHDR_SIZE + fOptsLen] == 0 ) );
+
+    // Any downlink acknowledges the sticky MAC answers, which the end-device
+    // repeats until then
+    if( ( MockNetwork.FOptsSize > 0 ) || ( macAnswers == true ) )
+    {
+        MockDownlinkSend( );
+    }
+}
@@ -0,0 +1,68 @@
+/*!
+ * \file      mock-network.h
+ *
+ * \brief     Network server side of the simulated air: accepts the join of an
+ *            end-device or starts an ABP session, checks the uplinks of the
+ *            session and answers them with MAC commands. Uplinks carrying
+ *            MAC answers are answered with a downlink.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#ifndef __MOCK_NETWORK_H__
+#define __MOCK_NETWORK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * Session of the end-device, LoRaWAN 1.0.x
+ */
+typedef struct MockNetwork_s
+{
+    uint8_t DevEui[8];      //!< Big endian, as set through the MIB
+    uint8_t AppKey[16];
+    uint32_t JoinNonce;     //!< Nonce of the last join accept
+    uint32_t Joins;         //!< Join requests accepted
+    uint32_t DevAddr;
+    uint8_t NwkSKey[16];
+    uint32_t FCntDown;      //!< Frame counter of the next downlink
+    uint32_t Uplinks;       //!< Uplinks of the session with a valid MIC
+    uint32_t Errors;        //!< Uplinks with an unknown address or a wrong MIC
+    /*!
+     * MAC commands sent in the FOpts of the downlink answering the next
+     * uplink, cleared once sent
+     */
+    uint8_t FOpts[15];
+    uint8_t FOptsSize;
+}MockNetwork_t;
+
+extern MockNetwork_t MockNetwork;
+
+/*!
+ * \brief Starts an ABP session
+ *
+ * \param [IN] devAddr Device address
+ * \param [IN] nwkSKey Network session key, as an hexadecimal string
+ */
+void MockNetworkInit( uint32_t devAddr, const char *nwkSKey );
+
+/*!
+ * \brief Expects the join request of an end-device, its session starts once
+ *        the join is accepted
+ *
+ * \param [IN] devEui  Device EUI, big endian
+ * \param [IN] appKey  Root key
+ * \param [IN] devAddr Device address given by the join accept
+ */
+void MockNetworkJoinInit( const uint8_t *devEui, const uint8_t *appKey, uint32_t devAddr );
+
+/*!
+ * \brief Receives a frame sent by the mock radio, to be set as its OnTx
+ *        hook. The answer is queued as the downlink of the next reception.
+ *
+ * \param [IN] buffer Frame
+ * \param [IN] size   Frame size
+ */
+void MockNetworkOnTx( const uint8_t *buffer, uint8_t size );
+
+#endif // __MOCK_NETWORK_H__
@@ -0,0 +1,452 @@
+/*!
+ * \file      nvm-test.c
+ *
+ * \brief     Changes each NVM group through the MAC: uplinks, downlinks
+ *            carrying MAC commands, MIB sets and channel changes. After each
+ *            step the groups are hashed in full and every group found changed
+ *            must have been reported by the MAC, which only hashes the groups
+ *            marked dirty. Also times LoRaMacProcess and counts the bytes it
+ *            hashes, against a full recompute of every group.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/lorawan.h"
+#include "LoRaMac.h"
+#include "utilities.h"
+#include "mock-pico.h"
+#include "mock-board.h"
+#include "mock-flash.h"
+#include "mock-network.h"
+
+/*!
+ * LoRaMacProcess calls of the idle microbenchmark
+ */
+#define TEST_IDLE_CALLS                             100000
+
+/*!
+ * Time given to an uplink and its reception windows [us]
+ */
+#define TEST_UPLINK_US                              10000000ULL
+
+/*!
+ * Longest duty cycle hold off waited for before an uplink: the EU868 bands
+ * allow 1% at SF12 [us]
+ */
+#define TEST_HOLD_OFF_US                            600000000ULL
+
+/*!
+ * Most frames sent for an uplink: the uplink and the empty uplinks carrying
+ * the MAC answers
+ */
+#define TEST_UPLINKS_MAX                            3
+
+#define TEST_DEV_ADDR                               0x26011BDA
+#define TEST_NWK_S_KEY                              "2B7E151628AED2A6ABF7158809CF4F3C"
+
+/*!
+ * NVM group, hashed up to its Crc32 field: the host pads some groups after it
+ */
+typedef struct NvmGroup_s
+{
+    const char *Name;
+    size_t Offset;
+    size_t Size;
+    uint16_t Flag;
+    uint32_t Crc;           //!< Full recompute at the last check
+    bool Changed;           //!< Changed by at least one step
+}NvmGroup_t;
+
+#define NVM_GROUP( field, flag )                    { #field, offsetof( LoRaMacNvmData_t, field ), \
+                                                      offsetof( LoRaMacNvmData_t, field.Crc32 ) - offsetof( LoRaMacNvmData_t, field ), \
+                                                      flag, 0, false }
+
+static NvmGroup_t Groups[] =
+{
+    NVM_GROUP( Crypto, LORAMAC_NVM_NOTIFY_FLAG_CRYPTO ),
+    NVM_GROUP( MacGroup1, LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 ),
+    NVM_GROUP( MacGroup2, LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 ),
+    NVM_GROUP( SecureElement, LORAMAC_NVM_NOTIFY_FLAG_SECURE_ELEMENT ),
+    NVM_GROUP( RegionGroup1, LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 ),
+    NVM_GROUP( RegionGroup2, LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 ),
+    NVM_GROUP( ClassB, LORAMAC_NVM_NOTIFY_FLAG_CLASS_B ),
+};
+
+#define NVM_GROUPS                                  ( sizeof( Groups ) / sizeof( Groups[0] ) )
+
+static int Failures;
+
+static const struct lorawan_sx12xx_settings Sx12xxSettings =
+{
+    .spi = { .inst = spi1, .mosi = 11, .miso = 12, .sck = 10, .nss = 3 },
+    .reset = 15,
+    .busy = 2,
+    .dio1 = 20
+};
+
+static const struct lorawan_abp_settings AbpSettings =
+{
+    .device_address = "26011BDA",
+    .network_session_key = TEST_NWK_S_KEY,
+    .app_session_key = "3C4FCF098815F7ABA6D2AE2816157E2B",
+    .channel_mask = NULL
+};
+
+static LoRaMacNvmData_t *Nvm;
+
+/*!
+ * Groups reported by the MAC since the last check
+ */
+static uint16_t Notified;
+
+/*!
+ * LoRaMacProcess calls, their host CPU time and the bytes they hashed
+ */
+static struct
+{
+    bool Inside;
+    uint32_t Calls;
+    uint64_t CrcBytes;
+    double CpuUs;
+}MacProcess;
+
+void __real_NvmDataMgmtEvent( uint16_t notifyFlags );
+
+void __wrap_NvmDataMgmtEvent( uint16_t notifyFlags )
+{
+    Notified |= notifyFlags;
+    __real_NvmDataMgmtEvent( notifyFlags );
+}
+
+uint32_t __real_Crc32( uint8_t *buffer, uint16_t length );
+
+uint32_t __wrap_Crc32( uint8_t *buffer, uint16_t length )
+{
+    if( MacProcess.Inside == true )
+    {
+        MacProcess.CrcBytes += length;
+    }
+    return __real_Crc32( buffer, length );
+}
+
+static double CpuTimeUs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+    return ( ts.tv_sec * 1e6 ) + ( ts.tv_nsec / 1e3 );
+}
+
+void __real_LoRaMacProcess( void );
+
+void __wrap_LoRaMacProcess( void )
+{
+    double start = CpuTimeUs( );
+
+    MacProcess.Inside = true;
+    __real_LoRaMacProcess( );
+    MacProcess.Inside = false;
+    MacProcess.Calls++;
+    MacProcess.CpuUs += CpuTimeUs( ) - start;
+}
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "  %s\n", message );
+        Failures++;
+    }
+}
+
+static uint32_t GroupCrc( const NvmGroup_t *group )
+{
+    return __real_Crc32( ( uint8_t* )Nvm + group->Offset, group->Size );
+}
+
+/*!
+ * \brief Checks that every group changed since the last check has been
+ *        reported by the MAC
+ *
+ * \param [IN] step Step which changed the groups
+ * \retval changed Groups changed by the step
+ */
+static uint16_t NvmCheck( const char *step )
+{
+    uint16_t changed = 0;
+
+    for( uint8_t i = 0; i < NVM_GROUPS; i++ )
+    {
+        uint32_t crc = GroupCrc( &Groups[i] );
+
+        if( crc == Groups[i].Crc )
+        {
+            continue;
+        }
+        changed |= Groups[i].Flag;
+        Groups[i].Crc = crc;
+        Groups[i].Changed = true;
+        if( ( Notified & Groups[i].Flag ) == 0 )
+        {
+            printf( "  %s changed %s without marking it dirty\n", step, Groups[i].Name );
+            Failures++;
+        }
+    }
+    Notified = 0;
+    return changed;
+}
+
+static void NvmCheckStart( void )
+{
+    for( uint8_t i = 0; i < NVM_GROUPS; i++ )
+    {
+        Groups[i].Crc = GroupCrc( &Groups[i] );
+    }
+    Notified = 0;
+}
+
+/*!
+ * \brief Runs the loop as the applications do until the given time
+ */
+static void ProcessUntil( uint64_t endUs )
+{
+    while( ( MockPico.TimeUs < endUs ) && ( MockPico.Stalls == 0 ) )
+    {
+        lorawan_process_timeout_ms( ( endUs - MockPico.TimeUs + 999 ) / 1000 );
+    }
+}
+
+/*!
+ * \brief Sends an uplink, the network answers with the given MAC commands
+ *
+ * \param [IN] fOpts     MAC commands, NULL for no answer
+ * \param [IN] fOptsSize MAC commands size
+ */
+static void Uplink( const uint8_t *fOpts, uint8_t fOptsSize )
+{
+    static const uint8_t data[] = { 0x01, 0x67, 0x00, 0xE1 };
+    uint32_t uplinks = MockNetwork.Uplinks;
+
+    memcpy( MockNetwork.FOpts, fOpts, fOptsSize );
+    MockNetwork.FOptsSize = fOptsSize;
+
+    // The duty cycle hold off of the previous uplinks is left to expire
+    uint64_t end = MockPico.TimeUs + TEST_HOLD_OFF_US;
+    bool sent = false;
+    while( ( sent == false ) && ( MockPico.TimeUs < end ) )
+    {
+        ProcessUntil( MockPico.TimeUs + TEST_UPLINK_US );
+        sent = ( lorawan_send_unconfirmed( data, sizeof( data ), 2 ) == 0 );
+    }
+    Check( sent == true, "Uplink refused" );
+    ProcessUntil( MockPico.TimeUs + TEST_UPLINK_US );
+    // The MAC may send empty uplinks carrying its answers
+    while( LoRaMacIsBusy( ) == true )
+    {
+        ProcessUntil( MockPico.TimeUs + TEST_UPLINK_US );
+    }
+    Check( MockNetwork.Uplinks > uplinks, "Uplink not received by the network" );
+    Check( MockNetwork.Uplinks <= ( uplinks + TEST_UPLINKS_MAX ), "MAC answers repeated" );
+    Check( MockNetwork.FOptsSize == 0, "Downlink not sent" );
+}
+
+/*!
+ * \brief Sets a MIB parameter, the MAC handles the NVM once the next uplink
+ *        is done
+ *
+ * \param [IN] step   Step name
+ * \param [IN] mibReq MIB parameter
+ * \retval changed Groups changed by the MIB set and the uplink
+ */
+static uint16_t MibStep( const char *step, MibRequestConfirm_t *mibReq )
+{
+    Check( LoRaMacMibSetRequestConfirm( mibReq ) == LORAMAC_STATUS_OK, "MIB set refused" );
+    Uplink( NULL, 0 );
+    return NvmCheck( step );
+}
+
+/*!
+ * \brief Changes the groups through the MAC, step by step
+ */
+static void StepsCheck( void )
+{
+    MibRequestConfirm_t mibReq;
+    uint16_t changed;
+
+    NvmCheckStart( );
+
+    Uplink( NULL, 0 );
+    changed = NvmCheck( "uplink" );
+    Check( ( changed & LORAMAC_NVM_NOTIFY_FLAG_CRYPTO ) != 0, "Uplink did not change the frame counter" );
+
+    // LinkADRReq: DR5, TX power 1, channels 0 to 2. RXParamSetupReq: RX1
+    // offset 1, RX2 DR3 at 869.525 MHz. RXTimingSetupReq: 2 s.
+    static const uint8_t adr[] = { 0x03, 0x51, 0x07, 0x00, 0x01,
+                                   0x05, 0x13, 0xD2, 0xAD, 0x84,
+                                   0x08, 0x02 };
+    Uplink( adr, sizeof( adr ) );
+    changed = NvmCheck( "MAC commands" );
+    Check( ( changed & LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 ) != 0, "MAC commands did not change the MAC parameters" );
+
+    // DutyCycleReq: 1/4. NewChannelReq: channel 3 at 867.1 MHz, DR0 to DR5.
+    static const uint8_t channel[] = { 0x04, 0x02,
+                                       0x07, 0x03, 0x18, 0x4E, 0x84, 0x50 };
+    Uplink( channel, sizeof( channel ) );
+    changed = NvmCheck( "new channel" );
+    Check( ( changed & LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 ) != 0, "NewChannelReq did not change the channels" );
+
+    // The answers are sent by the next uplink
+    Uplink( NULL, 0 );
+    NvmCheck( "MAC answers" );
+
+    mibReq.Type = MIB_ADR;
+    mibReq.Param.AdrEnable = false;
+    MibStep( "MIB_ADR", &mibReq );
+
+    mibReq.Type = MIB_CHANNELS_DATARATE;
+    mibReq.Param.ChannelsDatarate = DR_4;
+    MibStep( "MIB_CHANNELS_DATARATE", &mibReq );
+
+    mibReq.Type = MIB_CHANNELS_TX_POWER;
+    mibReq.Param.ChannelsTxPower = TX_POWER_3;
+    MibStep( "MIB_CHANNELS_TX_POWER", &mibReq );
+
+    mibReq.Type = MIB_RX2_CHANNEL;
+    mibReq.Param.Rx2Channel = ( RxChannelParams_t ){ 869525000, DR_0 };
+    MibStep( "MIB_RX2_CHANNEL", &mibReq );
+
+    mibReq.Type = MIB_SYSTEM_MAX_RX_ERROR;
+    mibReq.Param.SystemMaxRxError = 50;
+    MibStep( "MIB_SYSTEM_MAX_RX_ERROR", &mibReq );
+
+    mibReq.Type = MIB_NET_ID;
+    mibReq.Param.NetID = 0x000013;
+    MibStep( "MIB_NET_ID", &mibReq );
+
+    uint8_t devEui[8] = { 0x70, 0xB3, 0xD5, 0x7E, 0xD0, 0x00, 0x12, 0x34 };
+    mibReq.Type = MIB_DEV_EUI;
+    mibReq.Param.DevEui = devEui;
+    changed = MibStep( "MIB_DEV_EUI", &mibReq );
+    Check( ( changed & LORAMAC_NVM_NOTIFY_FLAG_SECURE_ELEMENT ) != 0, "MIB_DEV_EUI did not change the secure element" );
+
+    uint8_t joinEui[8] = { 0x70, 0xB3, 0xD5, 0x7E, 0xD0, 0x00, 0x56, 0x78 };
+    mibReq.Type = MIB_JOIN_EUI;
+    mibReq.Param.JoinEui = joinEui;
+    MibStep( "MIB_JOIN_EUI", &mibReq );
+
+    uint16_t mask[6] = { 0x0005 };
+    mibReq.Type = MIB_CHANNELS_MASK;
+    mibReq.Param.ChannelsMask = mask;
+    changed = MibStep( "MIB_CHANNELS_MASK", &mibReq );
+    Check( ( changed & LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 ) != 0, "MIB_CHANNELS_MASK did not change the channels" );
+
+    ChannelParams_t params = { .Frequency = 867300000, .DrRange.Value = 0x50 };
+    Check( LoRaMacChannelAdd( 4, params ) == LORAMAC_STATUS_OK, "Channel not added" );
+    Uplink( NULL, 0 );
+    NvmCheck( "LoRaMacChannelAdd" );
+
+    Check( LoRaMacChannelRemove( 3 ) == LORAMAC_STATUS_OK, "Channel not removed" );
+    Uplink( NULL, 0 );
+    NvmCheck( "LoRaMacChannelRemove" );
+
+    mibReq.Type = MIB_DEVICE_CLASS;
+    mibReq.Param.Class = CLASS_C;
+    Check( LoRaMacMibSetRequestConfirm( &mibReq ) == LORAMAC_STATUS_OK, "Class C refused" );
+    ProcessUntil( MockPico.TimeUs + TEST_UPLINK_US );
+    mibReq.Param.Class = CLASS_A;
+    MibStep( "class C and back", &mibReq );
+
+    // Uplinks with the new settings
+    Uplink( NULL, 0 );
+    NvmCheck( "uplink on the new channels" );
+
+    for( uint8_t i = 0; i < NVM_GROUPS; i++ )
+    {
+        printf( "%-14s %4u bytes, %s\n", Groups[i].Name, ( uint32_t )Groups[i].Size,
+                ( Groups[i].Changed == true ) ? "changed" : "unchanged" );
+        if( ( Groups[i].Changed == false ) && ( Groups[i].Flag != LORAMAC_NVM_NOTIFY_FLAG_CLASS_B ) )
+        {
+            printf( "  %s never changed by the steps\n", Groups[i].Name );
+            Failures++;
+        }
+    }
+    Check( MockNetwork.Errors == 0, "Uplinks rejected by the network" );
+}
+
+/*!
+ * \brief Times LoRaMacProcess and counts the bytes it hashes, idle then
+ *        along uplinks, against a full recompute of every group
+ */
+static void BenchmarkCheck( void )
+{
+    size_t fullBytes = 0;
+
+    for( uint8_t i = 0; i < NVM_GROUPS; i++ )
+    {
+        fullBytes += Groups[i].Size;
+    }
+
+    double start = CpuTimeUs( );
+    for( uint32_t n = 0; n < TEST_IDLE_CALLS; n++ )
+    {
+        for( uint8_t i = 0; i < NVM_GROUPS; i++ )
+        {
+            Groups[i].Crc = GroupCrc( &Groups[i] );
+        }
+    }
+    double fullNs = ( CpuTimeUs( ) - start ) * 1000 / TEST_IDLE_CALLS;
+
+    MacProcess.Calls = 0;
+    MacProcess.CrcBytes = 0;
+    start = CpuTimeUs( );
+    for( uint32_t n = 0; n < TEST_IDLE_CALLS; n++ )
+    {
+        LoRaMacProcess( );
+    }
+    double idleNs = ( CpuTimeUs( ) - start ) * 1000 / TEST_IDLE_CALLS;
+
+    printf( "full recompute: %u bytes hashed in %.0f ns\n", ( uint32_t )fullBytes, fullNs );
+    printf( "idle LoRaMacProcess: %.0f ns per call, %.1f bytes hashed per call\n", idleNs,
+            ( double )MacProcess.CrcBytes / MacProcess.Calls );
+    Check( MacProcess.CrcBytes == 0, "Idle LoRaMacProcess hashed NVM groups" );
+
+    MacProcess.Calls = 0;
+    MacProcess.CrcBytes = 0;
+    MacProcess.CpuUs = 0;
+    for( uint8_t n = 0; n < 10; n++ )
+    {
+        Uplink( NULL, 0 );
+    }
+    printf( "uplink LoRaMacProcess: %u calls, %.0f ns per call, %.1f bytes hashed per call\n", MacProcess.Calls,
+            MacProcess.CpuUs * 1000 / MacProcess.Calls, ( double )MacProcess.CrcBytes / MacProcess.Calls );
+    Check( ( MacProcess.CrcBytes / MacProcess.Calls ) < fullBytes, "Uplinks hashed every group" );
+}
+
+int main( void )
+{
+    MibRequestConfirm_t mibReq;
+
+    MockPicoReset( 0 );
+    MockFlashReset( );
+    MockNetworkInit( TEST_DEV_ADDR, TEST_NWK_S_KEY );
+    MockRadio.Air = true;
+    MockRadio.OnTx = MockNetworkOnTx;
+
+    Check( lorawan_init_abp( &Sx12xxSettings, LORAMAC_REGION_EU868, &AbpSettings ) == 0, "Stack not initialized" );
+    lorawan_join( );
+    ProcessUntil( MockPico.TimeUs + TEST_UPLINK_US );
+
+    mibReq.Type = MIB_NVM_CTXS;
+    LoRaMacMibGetRequestConfirm( &mibReq );
+    Nvm = mibReq.Param.Contexts;
+
+    StepsCheck( );
+    BenchmarkCheck( );
+
+    printf( "lorawan nvm: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+/*!
+ * \file      fcnt-test.c
+ *
+ * \brief     Runs uplinks through NvmDataMgmtStore on a counting NVM and
+ *            checks that the frame counter reservation saves the crypto
+ *            context stores, and that the frame counter resumes above the
+ *            last used value after a reset
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+#include <string.h>
+
+// The notification state is cleared on reset by including the module
+#include "NvmDataMgmt.c"
+
+#define TEST_UPLINKS                                1000
+
+#define TEST_ALL_GROUPS                             ( LORAMAC_NVM_NOTIFY_FLAG_CRYPTO | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_SECURE_ELEMENT | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP2 | \
+                                                      LORAMAC_NVM_NOTIFY_FLAG_CLASS_B )
+
+static int Failures;
+
+/*!
+ * MAC contexts and their NVM copy
+ */
+static LoRaMacNvmData_t Nvm;
+static uint8_t NvmImage[sizeof( LoRaMacNvmData_t )];
+
+/*!
+ * NvmmWrite calls, in total and for the crypto context
+ */
+static uint32_t Writes;
+static uint32_t CryptoWrites;
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "  %s\n", message );
+        Failures++;
+    }
+}
+
+LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
+{
+    mibGet->Param.Contexts = &Nvm;
+    return LORAMAC_STATUS_OK;
+}
+
+LoRaMacStatus_t LoRaMacStop( void )
+{
+    return LORAMAC_STATUS_OK;
+}
+
+LoRaMacStatus_t LoRaMacStart( void )
+{
+    return LORAMAC_STATUS_OK;
+}
+
+uint16_t NvmmWrite( uint8_t* src, uint16_t size, uint16_t offset )
+{
+    Writes++;
+    if( offset == 0 )
+    {
+        CryptoWrites++;
+    }
+    memcpy( NvmImage + offset, src, size );
+    return size;
+}
+
+uint16_t NvmmRead( uint8_t* dest, uint16_t size, uint16_t offset )
+{
+    memcpy( dest, NvmImage + offset, size );
+    return size;
+}
+
+bool NvmmCrc32Check( uint16_t size, uint16_t offset )
+{
+    uint32_t crc;
+
+    memcpy( &crc, NvmImage + offset + size - sizeof( crc ), sizeof( crc ) );
+    return Crc32( NvmImage + offset, size - sizeof( crc ) ) == crc;
+}
+
+bool NvmmReset( uint16_t size, uint16_t offset )
+{
+    memset( NvmImage + offset, 0xFF, size );
+    return true;
+}
+
+/*!
+ * \brief Updates the CRC held by the last 4 bytes of an NVM group
+ *
+ * \remark The host pointers pad some groups after their Crc32 field, the CRC
+ *         is placed where NvmmCrc32Check looks for it
+ */
+static void GroupCrcUpdate( void *group, uint16_t size )
+{
+    uint32_t crc = Crc32( group, size - sizeof( crc ) );
+
+    memcpy( ( uint8_t* )group + size - sizeof( crc ), &crc, sizeof( crc ) );
+}
+
+/*!
+ * \brief Updates the group CRCs and notifies the groups, as LoRaMacProcess
+ *        does once an uplink is done
+ *
+ * \param [IN] flags Groups changed
+ */
+static void MacNotify( uint16_t flags )
+{
+    GroupCrcUpdate( &Nvm.Crypto, sizeof( Nvm.Crypto ) );
+    GroupCrcUpdate( &Nvm.MacGroup1, sizeof( Nvm.MacGroup1 ) );
+    GroupCrcUpdate( &Nvm.MacGroup2, sizeof( Nvm.MacGroup2 ) );
+    GroupCrcUpdate( &Nvm.SecureElement, sizeof( Nvm.SecureElement ) );
+    GroupCrcUpdate( &Nvm.RegionGroup1, sizeof( Nvm.RegionGroup1 ) );
+    GroupCrcUpdate( &Nvm.RegionGroup2, sizeof( Nvm.RegionGroup2 ) );
+    GroupCrcUpdate( &Nvm.ClassB, sizeof( Nvm.ClassB ) );
+
+    NvmDataMgmtEvent( flags );
+    NvmDataMgmtStore( );
+}
+
+/*!
+ * \brief Sends an uplink: the frame counter, the ADR counter and the duty
+ *        cycle state change
+ */
+static void Uplink( void )
+{
+    Nvm.Crypto.FCntList.FCntUp++;
+    Nvm.MacGroup1.AdrAckCounter++;
+    Nvm.MacGroup1.LastTxDoneTime += 10000;
+
+    MacNotify( LORAMAC_NVM_NOTIFY_FLAG_CRYPTO | LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP1 | LORAMAC_NVM_NOTIFY_FLAG_REGION_GROUP1 );
+}
+
+/*!
+ * \brief Resets the board, the MAC contexts are restored from the NVM
+ *
+ * \retval fCntUp Restored uplink frame counter
+ */
+static uint32_t Reset( void )
+{
+    memset( &Nvm, 0, sizeof( Nvm ) );
+    NvmNotifyFlags = LORAMAC_NVM_NOTIFY_FLAG_NONE;
+    NvmDeferredFlags = LORAMAC_NVM_NOTIFY_FLAG_NONE;
+    NvmCryptoStoredValid = false;
+
+    Check( NvmDataMgmtRestore( ) == sizeof( LoRaMacNvmData_t ), "Contexts not restored" );
+    return Nvm.Crypto.FCntList.FCntUp;
+}
+
+int main( void )
+{
+    NvmDataMgmtFactoryReset( );
+
+    // Activation stores every group
+    MacNotify( TEST_ALL_GROUPS );
+    Check( Writes == 7, "Activation did not store every group" );
+
+    Writes = 0;
+    CryptoWrites = 0;
+    for( uint32_t n = 0; n < TEST_UPLINKS; n++ )
+    {
+        Uplink( );
+    }
+    printf( "%u uplinks: %u crypto context stores, %u NVM writes, reservation %u\n", TEST_UPLINKS, CryptoWrites, Writes,
+            NVM_FCNT_UP_RESERVATION );
+    Check( ( CryptoWrites >= ( TEST_UPLINKS / NVM_FCNT_UP_RESERVATION ) ) &&
+           ( CryptoWrites <= ( ( TEST_UPLINKS / NVM_FCNT_UP_RESERVATION ) + 1 ) ), "Crypto context stores not saved by the reservation" );
+
+    // Another group flushes the deferred ones
+    uint32_t adrAckCounter = Nvm.MacGroup1.AdrAckCounter;
+    Uplink( );
+    Nvm.MacGroup2.ChannelsDatarateDefault = DR_3;
+    MacNotify( LORAMAC_NVM_NOTIFY_FLAG_MAC_GROUP2 );
+    Check( ( ( LoRaMacNvmData_t* )NvmImage )->MacGroup1.AdrAckCounter == ( adrAckCounter + 1 ), "Deferred group not stored along" );
+
+    // The frame counter resumes above the last used value
+    uint32_t used = Nvm.Crypto.FCntList.FCntUp;
+    uint32_t resumed = Reset( );
+    printf( "FCntUp %u resumes from %u after a reset\n", used, resumed );
+    Check( ( resumed > used ) && ( resumed <= ( used + NVM_FCNT_UP_RESERVATION ) ), "Frame counter not resumed above the last used value" );
+
+    // Uplinks after the reset
+    for( uint32_t n = 0; n < ( 2 * NVM_FCNT_UP_RESERVATION ); n++ )
+    {
+        Uplink( );
+    }
+    used = Nvm.Crypto.FCntList.FCntUp;
+    resumed = Reset( );
+    Check( resumed > used, "Frame counter reused after a second reset" );
+
+    // The reservation is clamped to the highest frame counter
+    Nvm.Crypto.FCntList.FCntUp = UINT32_MAX - ( NVM_FCNT_UP_RESERVATION / 2 );
+    MacNotify( LORAMAC_NVM_NOTIFY_FLAG_CRYPTO );
+    Check( ( ( LoRaMacNvmData_t* )NvmImage )->Crypto.FCntList.FCntUp == UINT32_MAX, "Reservation wrapped the frame counter" );
+    for( uint32_t n = 0; n < ( ( NVM_FCNT_UP_RESERVATION / 2 ) - 1 ); n++ )
+    {
+        Uplink( );
+    }
+    used = Nvm.Crypto.FCntList.FCntUp;
+    resumed = Reset( );
+    printf( "FCntUp %u resumes from %u after a reset\n", used, resumed );
+    Check( resumed == UINT32_MAX, "Frame counter not clamped to UINT32_MAX" );
+
+    printf( "nvm fcnt: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
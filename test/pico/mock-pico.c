@@ -0,0 +1,366 @@
+/*!
+ * \file      mock-pico.c
+ *
+ * \brief     Simulated RP2040 clock, alarms and interrupts
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "hardware/structs/clocks.h"
+#include "hardware/structs/rosc.h"
+#include "hardware/structs/scb.h"
+#include "pico/unique_id.h"
+#include "mock-pico.h"
+
+#define MOCK_IRQS_MAX                               32
+
+/*!
+ * Scheduled interrupt, either a plain handler or a Pico SDK alarm
+ */
+typedef struct MockIrq_s
+{
+    int32_t Id;                 //!< 0 when the slot is free
+    uint64_t TimeUs;
+    MockIrqHandler_t *Handler;
+    alarm_callback_t Alarm;
+    void *Context;
+}MockIrq_t;
+
+/*!
+ * The alarms of every pool share the interrupt list
+ */
+struct alarm_pool
+{
+    uint HardwareAlarm;
+};
+
+MockPico_t MockPico;
+
+clocks_hw_t MockClocksHw = { CLOCKS_SLEEP_EN0_RESET, CLOCKS_SLEEP_EN1_RESET };
+
+armv6m_scb_t MockScbHw;
+
+static rosc_hw_t MockRosc;
+static uint32_t MockRoscSeed = 0x9E3779B9;
+
+static MockIrq_t Irqs[MOCK_IRQS_MAX];
+static int32_t IrqNextId = 1;
+
+static alarm_pool_t AlarmPool;
+
+void MockPicoReset( uint64_t timeUs )
+{
+    memset( &MockPico, 0, sizeof( MockPico ) );
+    memset( Irqs, 0, sizeof( Irqs ) );
+    MockPico.TimeUs = timeUs;
+    IrqNextId = 1;
+}
+
+static int32_t MockIrqAdd( int32_t id, uint64_t timeUs, MockIrqHandler_t *handler, alarm_callback_t alarm, void *context )
+{
+    for( uint8_t i = 0; i < MOCK_IRQS_MAX; i++ )
+    {
+        if( Irqs[i].Id != 0 )
+        {
+            continue;
+        }
+        if( id == 0 )
+        {
+            id = IrqNextId++;
+            if( IrqNextId <= 0 )
+            {
+                IrqNextId = 1;
+            }
+        }
+        Irqs[i].Id = id;
+        Irqs[i].TimeUs = ( timeUs > MockPico.TimeUs ) ? timeUs : MockPico.TimeUs;
+        Irqs[i].Handler = handler;
+        Irqs[i].Alarm = alarm;
+        Irqs[i].Context = context;
+        return id;
+    }
+    return 0;
+}
+
+/*!
+ * \brief Finds the next interrupt to be raised, the first scheduled wins a tie
+ */
+static MockIrq_t* MockIrqNext( void )
+{
+    MockIrq_t *next = NULL;
+
+    for( uint8_t i = 0; i < MOCK_IRQS_MAX; i++ )
+    {
+        if( ( Irqs[i].Id != 0 ) &&
+            ( ( next == NULL ) || ( Irqs[i].TimeUs < next->TimeUs ) ||
+              ( ( Irqs[i].TimeUs == next->TimeUs ) && ( Irqs[i].Id < next->Id ) ) ) )
+        {
+            next = &Irqs[i];
+        }
+    }
+    return next;
+}
+
+int32_t MockIrqSchedule( uint64_t timeUs, MockIrqHandler_t *handler, void *context )
+{
+    return MockIrqAdd( 0, timeUs, handler, NULL, context );
+}
+
+bool MockIrqCancel( int32_t id )
+{
+    for( uint8_t i = 0; ( id > 0 ) && ( i < MOCK_IRQS_MAX ); i++ )
+    {
+        if( Irqs[i].Id == id )
+        {
+            Irqs[i].Id = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MockIrqRun( void )
+{
+    MockIrq_t *next;
+
+    if( ( MockPico.Disabled == true ) || ( MockPico.InException == true ) )
+    {
+        return;
+    }
+
+    while( ( ( next = MockIrqNext( ) ) != NULL ) && ( next->TimeUs <= MockPico.TimeUs ) )
+    {
+        MockIrq_t irq = *next;
+
+        next->Id = 0;
+        MockPico.Irqs++;
+        MockPico.InException = true;
+        if( irq.Alarm != NULL )
+        {
+            int64_t reschedule = irq.Alarm( irq.Id, irq.Context );
+
+            // Same meaning as the return value of the SDK alarm callbacks
+            if( reschedule > 0 )
+            {
+                MockIrqAdd( irq.Id, irq.TimeUs + reschedule, NULL, irq.Alarm, irq.Context );
+            }
+            else if( reschedule < 0 )
+            {
+                MockIrqAdd( irq.Id, MockPico.TimeUs - reschedule, NULL, irq.Alarm, irq.Context );
+            }
+        }
+        else
+        {
+            irq.Handler( irq.Context );
+        }
+        MockPico.InException = false;
+
+        // The exception entry is a wake up event of __wfe
+        MockPico.Event = true;
+    }
+}
+
+void MockPicoRun( uint64_t us )
+{
+    uint64_t end = MockPico.TimeUs + us;
+    MockIrq_t *next;
+
+    while( ( MockPico.Disabled == false ) && ( ( next = MockIrqNext( ) ) != NULL ) && ( next->TimeUs <= end ) )
+    {
+        if( next->TimeUs > MockPico.TimeUs )
+        {
+            MockPico.TimeUs = next->TimeUs;
+        }
+        MockIrqRun( );
+    }
+    MockPico.TimeUs = end;
+    MockIrqRun( );
+}
+
+/*!
+ * \brief Sleeps until the next interrupt or the given time, the interrupt
+ *        is served once they are enabled
+ *
+ * \param [IN] timeUs Latest wake up time
+ */
+static void MockSleep( uint64_t timeUs )
+{
+    MockIrq_t *next = MockIrqNext( );
+
+    if( ( next != NULL ) && ( next->TimeUs < timeUs ) )
+    {
+        timeUs = next->TimeUs;
+    }
+    if( timeUs > MockPico.TimeUs )
+    {
+        MockPico.SleepUs += timeUs - MockPico.TimeUs;
+        if( ( MockScbHw.scr & M0PLUS_SCR_SLEEPDEEP_BITS ) != 0 )
+        {
+            MockPico.DeepSleepUs += timeUs - MockPico.TimeUs;
+        }
+        MockPico.TimeUs = timeUs;
+    }
+    MockIrqRun( );
+}
+
+static void MockWakeup( void *context )
+{
+}
+
+uint32_t time_us_32( void )
+{
+    return ( uint32_t )MockPico.TimeUs;
+}
+
+uint64_t time_us_64( void )
+{
+    return MockPico.TimeUs;
+}
+
+absolute_time_t get_absolute_time( void )
+{
+    absolute_time_t t;
+
+    update_us_since_boot( &t, MockPico.TimeUs );
+    return t;
+}
+
+absolute_time_t make_timeout_time_us( uint64_t us )
+{
+    return delayed_by_us( get_absolute_time( ), us );
+}
+
+absolute_time_t make_timeout_time_ms( uint32_t ms )
+{
+    return delayed_by_ms( get_absolute_time( ), ms );
+}
+
+bool best_effort_wfe_or_timeout( absolute_time_t timeout )
+{
+    if( absolute_time_diff_us( get_absolute_time( ), timeout ) <= 0 )
+    {
+        return true;
+    }
+
+    // The SDK sets an alarm at the timeout to wake __wfe up
+    int32_t id = MockIrqSchedule( to_us_since_boot( timeout ), MockWakeup, NULL );
+
+    __wfe( );
+    MockIrqCancel( id );
+    return absolute_time_diff_us( get_absolute_time( ), timeout ) <= 0;
+}
+
+void busy_wait_us_32( uint32_t delay_us )
+{
+    MockPicoRun( delay_us );
+}
+
+alarm_pool_t *alarm_pool_create( uint hardware_alarm_num, uint max_timers )
+{
+    AlarmPool.HardwareAlarm = hardware_alarm_num;
+    return &AlarmPool;
+}
+
+alarm_id_t alarm_pool_add_alarm_at( alarm_pool_t *pool, absolute_time_t time, alarm_callback_t callback,
+                                    void *user_data, bool fire_if_past )
+{
+    if( ( fire_if_past == false ) && ( to_us_since_boot( time ) <= MockPico.TimeUs ) )
+    {
+        return 0;
+    }
+    // A past alarm is raised at once
+    return MockIrqAdd( 0, to_us_since_boot( time ), NULL, callback, user_data );
+}
+
+bool alarm_pool_cancel_alarm( alarm_pool_t *pool, alarm_id_t alarm_id )
+{
+    return MockIrqCancel( alarm_id );
+}
+
+alarm_id_t add_alarm_at( absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past )
+{
+    return alarm_pool_add_alarm_at( &AlarmPool, time, callback, user_data, fire_if_past );
+}
+
+bool cancel_alarm( alarm_id_t alarm_id )
+{
+    return MockIrqCancel( alarm_id );
+}
+
+rosc_hw_t *MockRoscHw( void )
+{
+    MockRoscSeed ^= MockRoscSeed << 13;
+    MockRoscSeed ^= MockRoscSeed >> 17;
+    MockRoscSeed ^= MockRoscSeed << 5;
+    MockRosc.randombit = MockRoscSeed >> 31;
+    return &MockRosc;
+}
+
+void pico_get_unique_board_id( pico_unique_board_id_t *id_out )
+{
+    static const uint8_t id[8] = { 0xE6, 0x60, 0x58, 0x38, 0x83, 0x2B, 0x4C, 0x2A };
+
+    memcpy( id_out->id, id, sizeof( id ) );
+}
+
+uint __get_current_exception( void )
+{
+    return ( MockPico.InException == true ) ? 16 : 0;
+}
+
+uint get_core_num( void )
+{
+    return 0;
+}
+
+void __sev( void )
+{
+    MockPico.Event = true;
+}
+
+void __wfe( void )
+{
+    MockPico.Wakeups++;
+    if( MockPico.Event == true )
+    {
+        MockPico.Event = false;
+        return;
+    }
+    MockSleep( MockPico.TimeUs + MOCK_PICO_EVENT_PERIOD_US );
+    MockPico.Event = false;
+}
+
+void __wfi( void )
+{
+    MockPico.Wakeups++;
+    if( MockIrqNext( ) == NULL )
+    {
+        // Would never wake up
+        MockPico.Stalls++;
+        return;
+    }
+    MockSleep( UINT64_MAX );
+}
+
+uint32_t save_and_disable_interrupts( void )
+{
+    uint32_t status = ( MockPico.Disabled == true ) ? 1 : 0;
+
+    MockPico.Disables++;
+    if( MockPico.BeforeDisable != NULL )
+    {
+        MockPico.BeforeDisable( );
+        MockIrqRun( );
+    }
+    MockPico.Disabled = true;
+    return status;
+}
+
+void restore_interrupts( uint32_t status )
+{
+    MockPico.Disabled = ( status != 0 );
+    MockIrqRun( );
+}
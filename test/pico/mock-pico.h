@@ -0,0 +1,87 @@
+/*!
+ * \file      mock-pico.h
+ *
+ * \brief     Simulated RP2040 clock, alarms and interrupts: the time only
+ *            moves when the code under test sleeps, waits or talks to a
+ *            mocked peripheral, the interrupts fire at their exact time
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#ifndef __MOCK_PICO_H__
+#define __MOCK_PICO_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * Period of the interrupts which are not simulated (USB, other core), they
+ * wake __wfe up
+ */
+#define MOCK_PICO_EVENT_PERIOD_US                   1000
+
+typedef void ( MockIrqHandler_t )( void *context );
+
+/*!
+ * State of the simulated core
+ */
+typedef struct MockPico_s
+{
+    uint64_t TimeUs;        //!< Time since boot
+    bool InException;       //!< An interrupt handler is running
+    bool Disabled;          //!< Interrupts masked by save_and_disable_interrupts
+    bool Event;             //!< Event register set by __sev
+    uint32_t Wakeups;       //!< __wfe and __wfi calls
+    uint32_t Stalls;        //!< __wfi calls without any interrupt to wake up from
+    uint64_t SleepUs;       //!< Time spent in __wfe and __wfi
+    uint64_t DeepSleepUs;   //!< Part of SleepUs spent with SLEEPDEEP set
+    uint32_t Irqs;          //!< Interrupts served
+    uint32_t Disables;      //!< save_and_disable_interrupts calls
+    /*!
+     * Hook run by save_and_disable_interrupts before the interrupts are
+     * disabled, raises an interrupt at the worst time
+     */
+    void ( *BeforeDisable )( void );
+}MockPico_t;
+
+extern MockPico_t MockPico;
+
+/*!
+ * \brief Resets the core state, the interrupts and the alarms
+ *
+ * \param [IN] timeUs Time since boot to start from
+ */
+void MockPicoReset( uint64_t timeUs );
+
+/*!
+ * \brief Schedules an interrupt
+ *
+ * \param [IN] timeUs  Time the interrupt is raised at, a past time raises it
+ *                     at once
+ * \param [IN] handler Interrupt handler
+ * \param [IN] context Handler context
+ * \retval id Interrupt identifier, 0 when none is free
+ */
+int32_t MockIrqSchedule( uint64_t timeUs, MockIrqHandler_t *handler, void *context );
+
+/*!
+ * \brief Cancels a scheduled interrupt
+ *
+ * \param [IN] id Interrupt identifier
+ * \retval cancelled False when the interrupt is not scheduled any more
+ */
+bool MockIrqCancel( int32_t id );
+
+/*!
+ * \brief Serves the raised interrupts if they are enabled
+ */
+void MockIrqRun( void );
+
+/*!
+ * \brief Lets the time run, the interrupts raised meanwhile are served at
+ *        their time
+ *
+ * \param [IN] us Duration [us]
+ */
+void MockPicoRun( uint64_t us );
+
+#endif // __MOCK_PICO_H__
@@ -0,0 +1,237 @@
+/*!
+ * \file      spsc-test.c
+ *
+ * \brief     Checks the full and empty edges of the single producer / single
+ *            consumer queue, then streams millions of items between two
+ *            threads and checks that none is lost, duplicated, reordered or
+ *            torn
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "spsc_queue.h"
+
+/*!
+ * Items streamed through each queue size
+ */
+#define SPSC_STRESS_ITEMS                           4000000
+
+/*!
+ * Item spanning several words, a torn read breaks the relation between them
+ */
+typedef struct Item_s
+{
+    uint32_t Sequence;
+    uint32_t Inverse;
+    uint32_t Hash;
+    uint32_t Padding[5];
+}Item_t;
+
+typedef struct Stress_s
+{
+    struct spsc_queue Queue;
+    uint32_t Items;
+    uint32_t Received;
+    uint32_t Errors;
+    uint32_t FullRetries;
+    uint32_t EmptyRetries;
+}Stress_t;
+
+static int Failures;
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "  %s\n", message );
+        Failures++;
+    }
+}
+
+static void ItemFill( Item_t *item, uint32_t sequence )
+{
+    item->Sequence = sequence;
+    item->Inverse = ~sequence;
+    item->Hash = sequence * 2654435761u;
+    for( uint8_t i = 0; i < 5; i++ )
+    {
+        item->Padding[i] = sequence + i;
+    }
+}
+
+static bool ItemIsValid( const Item_t *item, uint32_t sequence )
+{
+    Item_t expected;
+
+    ItemFill( &expected, sequence );
+    return memcmp( item, &expected, sizeof( Item_t ) ) == 0;
+}
+
+/*!
+ * \brief Producer thread, pushes every other item in place through the
+ *        acquire / commit pair
+ *
+ * \remark Both threads yield when they cannot make progress, the other one
+ *         may share the same host CPU
+ */
+static void* Producer( void *context )
+{
+    Stress_t *stress = context;
+
+    for( uint32_t sequence = 0; sequence < stress->Items; )
+    {
+        if( ( sequence & 1 ) == 0 )
+        {
+            Item_t *slot = spsc_queue_write_acquire( &stress->Queue );
+
+            if( slot == NULL )
+            {
+                stress->FullRetries++;
+                sched_yield( );
+                continue;
+            }
+            ItemFill( slot, sequence );
+            spsc_queue_write_commit( &stress->Queue );
+        }
+        else
+        {
+            Item_t item;
+
+            ItemFill( &item, sequence );
+            if( spsc_queue_push( &stress->Queue, &item ) == false )
+            {
+                stress->FullRetries++;
+                sched_yield( );
+                continue;
+            }
+        }
+        sequence++;
+    }
+    return NULL;
+}
+
+/*!
+ * \brief Consumer thread, the mirror image of the producer
+ */
+static void* Consumer( void *context )
+{
+    Stress_t *stress = context;
+
+    while( stress->Received < stress->Items )
+    {
+        if( ( stress->Received & 1 ) == 0 )
+        {
+            Item_t *slot = spsc_queue_read_acquire( &stress->Queue );
+
+            if( slot == NULL )
+            {
+                stress->EmptyRetries++;
+                sched_yield( );
+                continue;
+            }
+            if( ItemIsValid( slot, stress->Received ) == false )
+            {
+                stress->Errors++;
+            }
+            spsc_queue_read_release( &stress->Queue );
+        }
+        else
+        {
+            Item_t item;
+
+            if( spsc_queue_pop( &stress->Queue, &item ) == false )
+            {
+                stress->EmptyRetries++;
+                sched_yield( );
+                continue;
+            }
+            if( ItemIsValid( &item, stress->Received ) == false )
+            {
+                stress->Errors++;
+            }
+        }
+        stress->Received++;
+    }
+    return NULL;
+}
+
+static void StressRun( uint32_t size )
+{
+    static Item_t buffer[256];
+    Stress_t stress = { .Items = SPSC_STRESS_ITEMS };
+    pthread_t producer;
+    pthread_t consumer;
+
+    spsc_queue_init( &stress.Queue, buffer, sizeof( Item_t ), size );
+
+    pthread_create( &consumer, NULL, Consumer, &stress );
+    pthread_create( &producer, NULL, Producer, &stress );
+    pthread_join( producer, NULL );
+    pthread_join( consumer, NULL );
+
+    printf( "size %3u: %u items %u errors, %u full and %u empty retries\n", size, stress.Received,
+            stress.Errors, stress.FullRetries, stress.EmptyRetries );
+    Check( stress.Received == stress.Items, "Items lost" );
+    Check( stress.Errors == 0, "Items reordered or torn" );
+    Check( spsc_queue_count( &stress.Queue ) == 0, "Queue not empty at the end" );
+}
+
+static void EdgesCheck( void )
+{
+    uint32_t buffer[4];
+    uint32_t item;
+    struct spsc_queue queue;
+
+    Check( spsc_queue_init( &queue, buffer, sizeof( uint32_t ), 3 ) == false, "Size not a power of 2 accepted" );
+    Check( spsc_queue_init( &queue, buffer, sizeof( uint32_t ), 0 ) == false, "Size 0 accepted" );
+    Check( spsc_queue_init( &queue, buffer, sizeof( uint32_t ), 4 ) == true, "Size 4 refused" );
+
+    // Empty queue
+    Check( spsc_queue_read_acquire( &queue ) == NULL, "Slot read from an empty queue" );
+    Check( spsc_queue_pop( &queue, &item ) == false, "Item popped from an empty queue" );
+    spsc_queue_read_release( &queue );
+    Check( spsc_queue_count( &queue ) == 0, "Release of an empty queue moved the tail" );
+
+    // The counters are free running, start just below their wrap
+    atomic_store( &queue.head, UINT32_MAX - 1 );
+    atomic_store( &queue.tail, UINT32_MAX - 1 );
+
+    // Full queue
+    for( item = 0; item < 4; item++ )
+    {
+        Check( spsc_queue_push( &queue, &item ) == true, "Item refused by a queue with free slots" );
+    }
+    Check( spsc_queue_count( &queue ) == 4, "Full queue count across the wrap" );
+    Check( spsc_queue_write_acquire( &queue ) == NULL, "Slot acquired in a full queue" );
+    Check( spsc_queue_push( &queue, &item ) == false, "Item pushed into a full queue" );
+
+    // One slot released makes room for one item
+    Check( ( spsc_queue_pop( &queue, &item ) == true ) && ( item == 0 ), "Oldest item not popped first" );
+    item = 4;
+    Check( spsc_queue_push( &queue, &item ) == true, "Released slot not reused" );
+    Check( spsc_queue_push( &queue, &item ) == false, "Item pushed into a full queue" );
+
+    for( uint32_t expected = 1; expected <= 4; expected++ )
+    {
+        Check( ( spsc_queue_pop( &queue, &item ) == true ) && ( item == expected ), "Items out of order across the wrap" );
+    }
+    Check( spsc_queue_pop( &queue, &item ) == false, "Item popped from a drained queue" );
+    Check( spsc_queue_count( &queue ) == 0, "Drained queue count" );
+}
+
+int main( void )
+{
+    EdgesCheck( );
+
+    // A single slot queue makes the threads hand over on every item
+    StressRun( 1 );
+    StressRun( 4 );
+    StressRun( 256 );
+
+    printf( "spsc: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
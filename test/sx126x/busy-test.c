@@ -0,0 +1,79 @@
+/*!
+ * \file      busy-test.c
+ *
+ * \brief     Checks that SX126xWaitOnBusy sleeps until the BUSY falling edge
+ *            and gives up on a stalled radio or DMA transfer at its deadline
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+
+#include "sx126x.h"
+#include "sx126x-board.h"
+#include "mock-pico.h"
+#include "mock-board.h"
+
+static int Failures;
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "  %s\n", message );
+        Failures++;
+    }
+}
+
+/*!
+ * \brief Waits on BUSY and reports the time spent and the events waited for
+ *
+ * \param [IN] name Case name
+ * \retval elapsed Time spent in SX126xWaitOnBusy [us]
+ */
+static uint64_t WaitOnBusy( const char *name )
+{
+    uint64_t start = MockPico.TimeUs;
+
+    MockPico.Wakeups = 0;
+    SX126xWaitOnBusy( );
+
+    printf( "%-16s %6llu us %3u wakeups %u timeouts\n", name,
+            ( unsigned long long )( MockPico.TimeUs - start ), MockPico.Wakeups,
+            SX126xGetBusyStats( )->Timeouts );
+    return MockPico.TimeUs - start;
+}
+
+int main( void )
+{
+    // Deadline of SX126xWaitOnBusy, see sx126x-board.c
+    uint64_t timeout = 20000 + ( SX126xGetBoardTcxoWakeupTime( ) * 1000 );
+
+    SX126xIoInit( );
+    SX126xSetOperatingMode( MODE_STDBY_RC );
+
+    // Released by the BUSY falling edge, without polling the deadline
+    MockBusySet( MockPico.TimeUs + 300 );
+    uint64_t elapsed = WaitOnBusy( "busy 300 us" );
+    Check( elapsed == 300, "Not woken up by the BUSY falling edge" );
+    Check( MockPico.Wakeups == 1, "Waited for more than the BUSY event" );
+    Check( SX126xGetBusyStats( )->Timeouts == 0, "Short BUSY period timed out" );
+
+    // Other interrupts wake the core up, the deadline is checked on each
+    MockBusySet( UINT64_MAX );
+    elapsed = WaitOnBusy( "stalled radio" );
+    Check( ( elapsed >= timeout ) && ( elapsed < ( timeout + 1000 ) ), "Stalled radio not given up at the deadline" );
+    Check( SX126xGetBusyStats( )->Timeouts == 1, "Stalled radio not counted" );
+    MockBusySet( 0 );
+
+    // A DMA transfer which never completes is bounded by the same deadline
+    MockRadio.Dma.Pending = true;
+    MockRadio.Dma.Callback = NULL;
+    MockRadio.Dma.Size = 0;
+    elapsed = WaitOnBusy( "stalled DMA" );
+    Check( elapsed >= timeout, "Returned with the DMA transfer running" );
+    Check( SX126xGetBusyStats( )->Timeouts == 2, "Stalled DMA not counted" );
+    MockRadio.Dma.Pending = false;
+
+    printf( "sx126x busy: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+/*!
+ * \file      dma-test.c
+ *
+ * \brief     Runs a reception through the background payload read, the fake
+ *            DMA engine of the mock board completes the transfer
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "radio.h"
+#include "sx126x.h"
+#include "sx126x-board.h"
+#include "mock-board.h"
+
+#define TEST_PAYLOAD_SIZE                           20
+#define TEST_PAYLOAD_OFFSET                         0x80
+
+static int Failures;
+
+static struct
+{
+    uint32_t Count;
+    bool InException;
+    uint16_t Size;
+    uint8_t Payload[255];
+}RxDoneCall;
+
+static void OnRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
+{
+    RxDoneCall.Count++;
+    RxDoneCall.InException = __get_current_exception( ) != 0;
+    RxDoneCall.Size = size;
+    memcpy( RxDoneCall.Payload, payload, size );
+}
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "%s\n", message );
+        Failures++;
+    }
+}
+
+static void OnTransferDone( void *context )
+{
+    *( bool* )context = true;
+}
+
+int main( void )
+{
+    static RadioEvents_t events = { .RxDone = OnRxDone };
+    uint8_t payload[TEST_PAYLOAD_SIZE];
+
+    for( uint8_t i = 0; i < TEST_PAYLOAD_SIZE; i++ )
+    {
+        payload[i] = 0xA0 + i;
+    }
+
+    SX126xIoInit( );
+    Radio.Init( &events );
+    Radio.SetChannel( 868100000 );
+    Radio.SetRxConfig( MODEM_LORA, 0, 7, 1, 0, 8, 5, false, 0, true, false, 0, false, false );
+    Radio.Rx( 0 );
+
+    memcpy( &MockRadio.Buffer[TEST_PAYLOAD_OFFSET], payload, TEST_PAYLOAD_SIZE );
+    MockRadio.RxPayloadSize = TEST_PAYLOAD_SIZE;
+    MockRadio.RxStartPointer = TEST_PAYLOAD_OFFSET;
+
+    MockRaiseIrq( IRQ_RX_DONE );
+    Check( Radio.IsIrqPending( ) == true, "DIO1 not reported as pending" );
+
+    Radio.IrqProcess( );
+    Check( MockRadio.Dma.Pending == true, "Payload not read in the background" );
+    Check( RxDoneCall.Count == 0, "RxDone raised before the payload was read" );
+    Check( Radio.IsIrqPending( ) == false, "Pending work reported while the transfer runs" );
+
+    // The board refuses a second transfer instead of waiting for the first one
+    bool secondDone = false;
+    Check( SpiTransferAsync( NULL, NULL, NULL, 1, OnTransferDone, &secondDone ) == false,
+           "Second background transfer accepted" );
+    Check( secondDone == false, "Refused transfer completed" );
+
+    uint32_t frames = MockRadio.Stats.Frames;
+    MockDmaComplete( );
+    Check( MockRadio.Stats.Frames == ( frames + 1 ), "NSS not released by the transfer completion" );
+    Check( RxDoneCall.Count == 0, "RxDone raised from the DMA interrupt" );
+    Check( Radio.IsIrqPending( ) == true, "Read payload not reported as pending" );
+
+    Radio.IrqProcess( );
+    Check( RxDoneCall.Count == 1, "RxDone not raised by Radio.IrqProcess" );
+    Check( RxDoneCall.InException == false, "RxDone raised in IRQ context" );
+    Check( ( RxDoneCall.Size == TEST_PAYLOAD_SIZE ) &&
+           ( memcmp( RxDoneCall.Payload, payload, TEST_PAYLOAD_SIZE ) == 0 ), "RxDone payload mismatch" );
+    Check( Radio.IsIrqPending( ) == false, "Pending work left after RxDone" );
+
+    Radio.IrqProcess( );
+    Check( RxDoneCall.Count == 1, "RxDone raised twice" );
+
+    printf( "SX126x DMA: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+/*!
+ * \file      entropy-test.c
+ *
+ * \brief     Checks the entropy credited by the radio refills and drawn by
+ *            rand1 against the mock radio
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+
+#include "utilities.h"
+#include "entropy.h"
+#include "radio.h"
+#include "sx126x.h"
+#include "sx126x-board.h"
+#include "mock-board.h"
+
+int32_t rand1( void );
+
+static int Failures;
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "%s (pool %u bits)\n", message, EntropyGetBits( ) );
+        Failures++;
+    }
+}
+
+/*!
+ * \brief Runs a reception window which ends with a timeout
+ *
+ * \param [IN] random Generator register value at the end of the window
+ */
+static void RxWindowTimeout( uint32_t random )
+{
+    Radio.Rx( 0 );
+    MockRadio.Random = random;
+    MockRaiseIrq( IRQ_RX_TX_TIMEOUT );
+    Radio.IrqProcess( );
+}
+
+int main( void )
+{
+    static RadioEvents_t events = { 0 };
+
+    SX126xIoInit( );
+    Radio.Init( &events );
+    Radio.SetChannel( 868100000 );
+    Radio.SetRxConfig( MODEM_LORA, 0, 7, 1, 0, 8, 5, false, 0, true, false, 0, false, false );
+
+    RxWindowTimeout( 0x12345678 );
+    Check( EntropyGetBits( ) == 4, "RX timeout refill not credited" );
+
+    // The register was not updated, nothing new was drawn
+    RxWindowTimeout( 0x12345678 );
+    Check( EntropyGetBits( ) == 4, "Stale generator register credited" );
+
+    RxWindowTimeout( 0x9ABCDEF0 );
+    Check( EntropyGetBits( ) == 8, "Fresh generator register not credited" );
+
+    for( uint32_t i = 0; EntropyGetBits( ) < ENTROPY_POOL_BITS; i++ )
+    {
+        EntropyAdd( ENTROPY_SOURCE_BOARD, 0x01000193 * ( i + 1 ), 32 );
+    }
+
+    // One reseed per RAND_RESEED_PERIOD calls once seeded
+    srand1( 1 );
+    for( uint8_t i = 0; i < 64; i++ )
+    {
+        rand1( );
+    }
+    Check( EntropyGetBits( ) == ( ENTROPY_POOL_BITS - 32 ), "rand1 drained the pool" );
+
+    printf( "Entropy: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
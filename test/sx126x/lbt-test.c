@@ -0,0 +1,136 @@
+/*!
+ * \file      lbt-test.c
+ *
+ * \brief     Runs carrier senses against the mock radio, a short burst must
+ *            be heard wherever it falls in the carrier sense time and,
+ *            unless built for back to back sampling, IrqProcess must hand
+ *            the main loop back every millisecond
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+
+#include "radio.h"
+#include "sx126x.h"
+#include "sx126x-board.h"
+#include "mock-pico.h"
+#include "mock-board.h"
+#include "mock-timer.h"
+
+#define TEST_RSSI_THRESH                            -80
+#define TEST_CARRIER_SENSE_TIME                     6
+
+#ifndef RADIO_CHANNEL_SENSE_BURST_TIME
+#define RADIO_CHANNEL_SENSE_BURST_TIME              1
+#endif
+
+/*!
+ * Longest IrqProcess call allowed, a burst plus the last RSSI sample
+ */
+#if( RADIO_CHANNEL_SENSE_BURST_TIME == 0 )
+#define TEST_IRQ_PROCESS_MAX_US                     ( ( TEST_CARRIER_SENSE_TIME + 1 ) * 1000 )
+#else
+#define TEST_IRQ_PROCESS_MAX_US                     ( ( RADIO_CHANNEL_SENSE_BURST_TIME * 1000 ) + 50 )
+#endif
+
+static int Failures;
+
+static uint32_t DoneCount;
+static bool DoneFree;
+
+/*!
+ * Longest IrqProcess call and number of calls of the last carrier sense
+ */
+static uint64_t IrqProcessMaxUs;
+static uint32_t IrqProcessCount;
+
+static void OnChannelSenseDone( bool channelFree )
+{
+    DoneCount++;
+    DoneFree = channelFree;
+}
+
+/*!
+ * \brief Runs a carrier sense to its end
+ *
+ * \param [IN] burstStart Start of a 200 us burst after the receiver settled [us]
+ * \retval free Carrier sense result
+ */
+static bool ChannelSense( uint32_t burstStart )
+{
+    DoneCount = 0;
+    IrqProcessMaxUs = 0;
+    IrqProcessCount = 0;
+    Radio.StartChannelSense( 923200000, 200000, TEST_RSSI_THRESH, TEST_CARRIER_SENSE_TIME );
+
+    // The receiver settles in the background
+    uint64_t start = MockPico.TimeUs;
+    while( ( DoneCount == 0 ) && ( MockTimerRun( ) == true ) )
+    {
+        if( MockRadio.BurstEndUs == 0 )
+        {
+            MockRadio.BurstStartUs = MockPico.TimeUs + burstStart;
+            MockRadio.BurstEndUs = MockRadio.BurstStartUs + 200;
+        }
+        while( Radio.IsIrqPending( ) == true )
+        {
+            uint64_t callStart = MockPico.TimeUs;
+
+            Radio.IrqProcess( );
+            IrqProcessCount++;
+            if( ( MockPico.TimeUs - callStart ) > IrqProcessMaxUs )
+            {
+                IrqProcessMaxUs = MockPico.TimeUs - callStart;
+            }
+        }
+    }
+    if( DoneCount != 1 )
+    {
+        printf( "ChannelSenseDone raised %u times\n", DoneCount );
+        Failures++;
+    }
+    if( ( DoneFree == true ) && ( ( MockPico.TimeUs - start ) < ( TEST_CARRIER_SENSE_TIME * 1000 ) ) )
+    {
+        printf( "Channel reported free after %u us\n", ( uint32_t )( MockPico.TimeUs - start ) );
+        Failures++;
+    }
+    if( IrqProcessMaxUs > TEST_IRQ_PROCESS_MAX_US )
+    {
+        printf( "IrqProcess blocked the main loop for %u us\n", ( uint32_t )IrqProcessMaxUs );
+        Failures++;
+    }
+    MockRadio.BurstEndUs = 0;
+    return DoneFree;
+}
+
+int main( void )
+{
+    static RadioEvents_t events = { .ChannelSenseDone = OnChannelSenseDone };
+
+    SX126xIoInit( );
+    Radio.Init( &events );
+
+    MockRadio.Rssi = -110;
+    MockRadio.BurstRssi = -60;
+
+    // The burst lies beyond the carrier sense time
+    if( ChannelSense( 2 * TEST_CARRIER_SENSE_TIME * 1000 ) == false )
+    {
+        printf( "Quiet channel reported busy\n" );
+        Failures++;
+    }
+    printf( "Quiet channel: %u IrqProcess calls, longest %u us\n", IrqProcessCount, ( uint32_t )IrqProcessMaxUs );
+
+    // Bursts shorter than a millisecond at any point of the carrier sense
+    for( uint32_t burstStart = 0; burstStart < ( ( TEST_CARRIER_SENSE_TIME - 1 ) * 1000 ); burstStart += 150 )
+    {
+        if( ChannelSense( burstStart ) == true )
+        {
+            printf( "Burst at %u us not heard\n", burstStart );
+            Failures++;
+        }
+    }
+
+    printf( "Carrier sense: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,505 @@
+/*!
+ * \file      mock-board.c
+ *
+ * \brief     Host stand-in for the board drivers used by the SX126x driver
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/board-config.h"
+#include "utilities.h"
+#include "gpio.h"
+#include "gpio-board.h"
+#include "spi.h"
+#include "sx126x.h"
+#include "mock-pico.h"
+#include "mock-board.h"
+
+MockRadio_t MockRadio;
+
+/*!
+ * Bytes of the SPI frame in progress
+ */
+static uint16_t FrameIndex;
+static uint8_t FrameHeader[10];
+
+static Gpio_t *Dio1;
+static Gpio_t *Busy;
+static TimerTick_t Dio1Timestamp;
+
+/*!
+ * LoRa modulation and packet parameters last set, used by the air simulation
+ */
+static struct
+{
+    uint8_t SpreadingFactor;
+    uint8_t Bandwidth;
+    uint8_t CodingRate;
+    uint8_t LowDatarateOptimize;
+    uint16_t PreambleLength;
+    uint8_t HeaderType;
+    uint8_t PayloadLength;
+    uint8_t CrcMode;
+    uint8_t SymbTimeout;
+}LoRa = { .SpreadingFactor = 7, .Bandwidth = LORA_BW_125, .CodingRate = LORA_CR_4_5, .PreambleLength = 8 };
+
+/*!
+ * Completion of the transmission or reception in progress
+ */
+static int32_t AirIrq;
+static MockIrqHandler_t *AirHandler;
+
+static uint64_t StateStartUs;
+
+void MockStatsReset( void )
+{
+    memset( &MockRadio.Stats, 0, sizeof( MockRadio.Stats ) );
+}
+
+/*!
+ * \brief BUSY falling edge
+ */
+static void MockBusyEnd( void *context )
+{
+    if( ( Busy != NULL ) && ( Busy->IrqHandler != NULL ) )
+    {
+        Busy->IrqHandler( Busy->Context );
+    }
+}
+
+void MockBusySet( uint64_t endUs )
+{
+    MockRadio.BusyEndUs = endUs;
+    if( ( endUs != UINT64_MAX ) && ( endUs > MockPico.TimeUs ) )
+    {
+        MockIrqSchedule( endUs, MockBusyEnd, NULL );
+    }
+}
+
+void MockRaiseIrq( uint16_t irq )
+{
+    MockRadio.IrqStatus |= irq;
+    Dio1Timestamp = ( TimerTick_t )MockPico.TimeUs;
+    if( ( Dio1 != NULL ) && ( Dio1->IrqHandler != NULL ) )
+    {
+        Dio1->IrqHandler( Dio1->Context );
+    }
+}
+
+void MockRadioStateUpdate( void )
+{
+    MockRadio.StateUs[MockRadio.State] += MockPico.TimeUs - StateStartUs;
+    StateStartUs = MockPico.TimeUs;
+}
+
+static void MockRadioSetState( MockRadioState_t state )
+{
+    MockRadioStateUpdate( );
+    MockRadio.State = state;
+}
+
+/*!
+ * \brief Duration of a LoRa symbol with the modulation parameters last set
+ *
+ * \retval symbolTime Symbol time [us]
+ */
+static double MockLoRaSymbolTime( void )
+{
+    uint32_t bandwidth;
+
+    switch( LoRa.Bandwidth )
+    {
+        case LORA_BW_250:
+            bandwidth = 250000;
+            break;
+        case LORA_BW_500:
+            bandwidth = 500000;
+            break;
+        case LORA_BW_062:
+            bandwidth = 62500;
+            break;
+        default:
+            bandwidth = 125000;
+            break;
+    }
+    return ( ( double )( 1 << LoRa.SpreadingFactor ) * 1e6 ) / bandwidth;
+}
+
+uint32_t MockLoRaTimeOnAir( uint8_t size )
+{
+    int32_t sf = LoRa.SpreadingFactor;
+    int32_t de = LoRa.LowDatarateOptimize;
+    int32_t ih = ( LoRa.HeaderType == LORA_PACKET_IMPLICIT ) ? 1 : 0;
+    int32_t crc = ( LoRa.CrcMode == LORA_CRC_ON ) ? 1 : 0;
+    int32_t numerator = ( 8 * size ) - ( 4 * sf ) + 28 + ( 16 * crc ) - ( 20 * ih );
+    int32_t denominator = 4 * ( sf - ( 2 * de ) );
+    int32_t payloadSymbols = 8;
+
+    if( numerator > 0 )
+    {
+        payloadSymbols += ( ( numerator + denominator - 1 ) / denominator ) * ( ( LoRa.CodingRate & 0x07 ) + 4 );
+    }
+    return ( uint32_t )( ( LoRa.PreambleLength + 4.25 + payloadSymbols ) * MockLoRaSymbolTime( ) );
+}
+
+static void MockAirStop( void )
+{
+    MockIrqCancel( AirIrq );
+    AirIrq = 0;
+}
+
+static void MockAirSchedule( uint64_t timeUs, MockIrqHandler_t *handler )
+{
+    AirHandler = handler;
+    AirIrq = MockIrqSchedule( timeUs, handler, NULL );
+}
+
+bool MockAirNow( void )
+{
+    if( AirIrq == 0 )
+    {
+        return false;
+    }
+    MockIrqCancel( AirIrq );
+    AirIrq = MockIrqSchedule( MockPico.TimeUs, AirHandler, NULL );
+    return true;
+}
+
+static void MockAirTxDone( void *context )
+{
+    AirIrq = 0;
+    MockRadioSetState( MOCK_RADIO_STANDBY );
+    MockRadio.TxCount++;
+    if( MockRadio.OnTx != NULL )
+    {
+        // The buffer base addresses are left at 0
+        MockRadio.OnTx( MockRadio.Buffer, LoRa.PayloadLength );
+    }
+    MockRaiseIrq( IRQ_TX_DONE );
+}
+
+static void MockAirRxDone( void *context )
+{
+    AirIrq = 0;
+    memcpy( MockRadio.Buffer, MockRadio.Downlink.Buffer, MockRadio.Downlink.Size );
+    MockRadio.RxPayloadSize = MockRadio.Downlink.Size;
+    MockRadio.RxStartPointer = 0;
+    // -60 dBm, 10 dB SNR
+    MockRadio.PacketStatus[0] = 120;
+    MockRadio.PacketStatus[1] = 40;
+    MockRadio.PacketStatus[2] = 120;
+    MockRadio.Downlink.Size = 0;
+    MockRadioSetState( MOCK_RADIO_STANDBY );
+    MockRaiseIrq( IRQ_RX_DONE );
+}
+
+static void MockAirRxTimeout( void *context )
+{
+    AirIrq = 0;
+    MockRadioSetState( MOCK_RADIO_STANDBY );
+    MockRaiseIrq( IRQ_RX_TX_TIMEOUT );
+}
+
+/*!
+ * \brief Starts a reception
+ *
+ * \param [IN] timeout SetRx timeout [15.625 us steps], 0xFFFFFF for a
+ *                     continuous reception
+ */
+static void MockAirRx( uint32_t timeout )
+{
+    MockAirStop( );
+    MockRadioSetState( MOCK_RADIO_RX );
+    MockRadio.RxCount++;
+
+    if( MockRadio.Downlink.Size > 0 )
+    {
+        MockAirSchedule( MockPico.TimeUs + MockLoRaTimeOnAir( MockRadio.Downlink.Size ), MockAirRxDone );
+    }
+    else if( timeout == 0xFFFFFF )
+    {
+        return;
+    }
+    else if( LoRa.SymbTimeout != 0 )
+    {
+        // No preamble detected
+        MockAirSchedule( MockPico.TimeUs + ( uint64_t )( LoRa.SymbTimeout * MockLoRaSymbolTime( ) ), MockAirRxTimeout );
+    }
+    else if( timeout != 0 )
+    {
+        MockAirSchedule( MockPico.TimeUs + ( ( uint64_t )timeout * 15625 / 1000 ), MockAirRxTimeout );
+    }
+}
+
+/*!
+ * \brief Applies the command of the SPI frame just ended to the air
+ *        simulation
+ */
+static void MockAirCommand( void )
+{
+    switch( FrameHeader[0] )
+    {
+        case RADIO_SET_MODULATIONPARAMS:
+            LoRa.SpreadingFactor = FrameHeader[1];
+            LoRa.Bandwidth = FrameHeader[2];
+            LoRa.CodingRate = FrameHeader[3];
+            LoRa.LowDatarateOptimize = FrameHeader[4];
+            break;
+        case RADIO_SET_PACKETPARAMS:
+            LoRa.PreambleLength = ( FrameHeader[1] << 8 ) | FrameHeader[2];
+            LoRa.HeaderType = FrameHeader[3];
+            LoRa.PayloadLength = FrameHeader[4];
+            LoRa.CrcMode = FrameHeader[5];
+            break;
+        case RADIO_SET_LORASYMBTIMEOUT:
+            LoRa.SymbTimeout = FrameHeader[1];
+            break;
+        case RADIO_SET_TX:
+            MockAirStop( );
+            MockRadioSetState( MOCK_RADIO_TX );
+            MockAirSchedule( MockPico.TimeUs + MockLoRaTimeOnAir( LoRa.PayloadLength ), MockAirTxDone );
+            break;
+        case RADIO_SET_RX:
+            MockAirRx( ( FrameHeader[1] << 16 ) | ( FrameHeader[2] << 8 ) | FrameHeader[3] );
+            break;
+        case RADIO_SET_RXDUTYCYCLE:
+        case RADIO_SET_CAD:
+            MockAirStop( );
+            MockRadioSetState( MOCK_RADIO_RX );
+            break;
+        case RADIO_SET_STANDBY:
+            MockAirStop( );
+            MockRadioSetState( MOCK_RADIO_STANDBY );
+            break;
+        case RADIO_SET_SLEEP:
+            MockAirStop( );
+            MockRadioSetState( MOCK_RADIO_SLEEP );
+            break;
+        default:
+            break;
+    }
+}
+
+/*!
+ * \brief Clocks one byte through the mock radio
+ *
+ * \param [IN] out Byte sent by the host
+ * \retval in Byte returned by the radio
+ */
+static uint8_t MockSpiByte( uint8_t out )
+{
+    uint16_t index = FrameIndex++;
+    uint8_t in = 0;
+
+    MockRadio.Stats.Bytes++;
+    MockPico.TimeUs++;
+    if( index < sizeof( FrameHeader ) )
+    {
+        FrameHeader[index] = out;
+    }
+    if( index < 2 )
+    {
+        return 0;
+    }
+
+    switch( FrameHeader[0] )
+    {
+        case RADIO_GET_IRQSTATUS:
+            in = ( index == 2 ) ? ( MockRadio.IrqStatus >> 8 ) : ( MockRadio.IrqStatus & 0xFF );
+            break;
+        case RADIO_GET_RXBUFFERSTATUS:
+            in = ( index == 2 ) ? MockRadio.RxPayloadSize : MockRadio.RxStartPointer;
+            break;
+        case RADIO_GET_PACKETSTATUS:
+            in = ( index < 5 ) ? MockRadio.PacketStatus[index - 2] : 0;
+            break;
+        case RADIO_GET_RSSIINST:
+            if( ( MockPico.TimeUs >= MockRadio.BurstStartUs ) && ( MockPico.TimeUs < MockRadio.BurstEndUs ) )
+            {
+                in = -2 * MockRadio.BurstRssi;
+            }
+            else
+            {
+                in = -2 * MockRadio.Rssi;
+            }
+            break;
+        case RADIO_READ_REGISTER:
+            if( index >= 4 )
+            {
+                uint16_t address = ( ( FrameHeader[1] << 8 ) | FrameHeader[2] ) + index - 4;
+
+                if( ( address >= RANDOM_NUMBER_GENERATORBASEADDR ) && ( address < ( RANDOM_NUMBER_GENERATORBASEADDR + 4 ) ) )
+                {
+                    in = MockRadio.Random >> ( 8 * ( address - RANDOM_NUMBER_GENERATORBASEADDR ) );
+                }
+            }
+            break;
+        case RADIO_READ_BUFFER:
+            in = ( index >= 3 ) ? MockRadio.Buffer[( uint8_t )( FrameHeader[1] + index - 3 )] : 0;
+            break;
+        case RADIO_WRITE_BUFFER:
+            MockRadio.Buffer[( uint8_t )( FrameHeader[1] + index - 2 )] = out;
+            break;
+        default:
+            break;
+    }
+    return in;
+}
+
+static void MockFrameEnd( void )
+{
+    if( FrameIndex == 0 )
+    {
+        return;
+    }
+    MockRadio.Stats.Frames++;
+    MockRadio.Stats.Opcodes[FrameHeader[0]]++;
+    if( ( FrameHeader[0] == RADIO_CLR_IRQSTATUS ) && ( FrameIndex >= 3 ) )
+    {
+        MockRadio.IrqStatus &= ~( ( FrameHeader[1] << 8 ) | FrameHeader[2] );
+    }
+    if( MockRadio.Air == true )
+    {
+        MockAirCommand( );
+    }
+    FrameIndex = 0;
+}
+
+void GpioInit( Gpio_t *obj, PinNames pin, PinModes mode, PinConfigs config, PinTypes type, uint32_t value )
+{
+    obj->pin = pin;
+    obj->Context = NULL;
+    obj->IrqHandler = NULL;
+}
+
+void GpioSetInterrupt( Gpio_t *obj, IrqModes irqMode, IrqPriorities irqPriority, GpioIrqHandler *irqHandler )
+{
+    obj->IrqHandler = irqHandler;
+    if( obj->pin == RADIO_DIO_1 )
+    {
+        Dio1 = obj;
+    }
+    else if( obj->pin == RADIO_BUSY )
+    {
+        Busy = obj;
+    }
+}
+
+void GpioWrite( Gpio_t *obj, uint32_t value )
+{
+    if( obj->pin != RADIO_NSS )
+    {
+        return;
+    }
+    if( value == 0 )
+    {
+        FrameIndex = 0;
+        if( MockRadio.State == MOCK_RADIO_SLEEP )
+        {
+            // The NSS falling edge wakes the radio up
+            MockRadioSetState( MOCK_RADIO_STANDBY );
+        }
+    }
+    else
+    {
+        MockFrameEnd( );
+    }
+}
+
+uint32_t GpioRead( Gpio_t *obj )
+{
+    if( obj->pin == RADIO_BUSY )
+    {
+        return ( MockPico.TimeUs < MockRadio.BusyEndUs ) ? 1 : 0;
+    }
+    return 0;
+}
+
+TimerTick_t GpioMcuGetIrqTimestamp( Gpio_t *obj )
+{
+    return Dio1Timestamp;
+}
+
+void SpiInit( Spi_t *obj, SpiId_t spiId, PinNames mosi, PinNames miso, PinNames sclk, PinNames nss )
+{
+    obj->SpiId = spiId;
+}
+
+uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
+{
+    MockRadio.Stats.Calls++;
+    return MockSpiByte( outData );
+}
+
+void SpiTransfer( Spi_t *obj, const uint8_t *txData, uint8_t *rxData, uint16_t size )
+{
+    MockRadio.Stats.Calls++;
+    for( uint16_t i = 0; i < size; i++ )
+    {
+        uint8_t in = MockSpiByte( ( txData != NULL ) ? txData[i] : 0 );
+
+        if( rxData != NULL )
+        {
+            rxData[i] = in;
+        }
+    }
+}
+
+static void MockDmaIrq( void *context )
+{
+    MockDmaComplete( );
+}
+
+bool SpiTransferAsync( Spi_t *obj, const uint8_t *txData, uint8_t *rxData, uint16_t size,
+                       SpiTransferCallback_t callback, void *context )
+{
+    MockRadio.Stats.Calls++;
+    if( MockRadio.Dma.Pending == true )
+    {
+        return false;
+    }
+    MockRadio.Dma.Pending = true;
+    MockRadio.Dma.RxData = rxData;
+    MockRadio.Dma.Size = size;
+    MockRadio.Dma.Callback = callback;
+    MockRadio.Dma.Context = context;
+    if( MockRadio.Air == true )
+    {
+        MockIrqSchedule( MockPico.TimeUs + size, MockDmaIrq, NULL );
+    }
+    return true;
+}
+
+bool SpiIsTransferPending( Spi_t *obj )
+{
+    if( MockRadio.Dma.Pending == true )
+    {
+        // Polled in a loop, lets the time run
+        MockPico.TimeUs++;
+    }
+    return MockRadio.Dma.Pending;
+}
+
+void MockDmaComplete( void )
+{
+    for( uint16_t i = 0; i < MockRadio.Dma.Size; i++ )
+    {
+        uint8_t in = MockSpiByte( 0 );
+
+        if( MockRadio.Dma.RxData != NULL )
+        {
+            MockRadio.Dma.RxData[i] = in;
+        }
+    }
+    MockRadio.Dma.Pending = false;
+
+    bool inException = MockPico.InException;
+
+    MockPico.InException = true;
+    if( MockRadio.Dma.Callback != NULL )
+    {
+        MockRadio.Dma.Callback( MockRadio.Dma.Context );
+    }
+    MockPico.InException = inException;
+}
@@ -0,0 +1,141 @@
+/*!
+ * \file      mock-board.h
+ *
+ * \brief     Host stand-in for the board drivers used by the SX126x driver,
+ *            models the SPI side of an SX1262 and counts the transactions.
+ *            The SPI bytes take 1 us each on the simulated clock.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#ifndef __MOCK_BOARD_H__
+#define __MOCK_BOARD_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "spi.h"
+
+/*!
+ * SPI traffic seen by the mock radio
+ */
+typedef struct MockSpiStats_s
+{
+    uint32_t Frames;        //!< NSS low to high periods
+    uint32_t Calls;         //!< SpiInOut, SpiTransfer and SpiTransferAsync calls
+    uint32_t Bytes;         //!< Bytes clocked on the bus
+    uint16_t Opcodes[256];  //!< Frames per opcode
+}MockSpiStats_t;
+
+/*!
+ * Radio states accounted by the air simulation
+ */
+typedef enum eMockRadioState
+{
+    MOCK_RADIO_SLEEP,
+    MOCK_RADIO_STANDBY,
+    MOCK_RADIO_TX,
+    MOCK_RADIO_RX,
+    MOCK_RADIO_STATES,
+}MockRadioState_t;
+
+/*!
+ * State of the mock radio and of the fake DMA engine
+ */
+typedef struct MockRadio_s
+{
+    MockSpiStats_t Stats;
+    uint16_t IrqStatus;
+    uint8_t RxPayloadSize;
+    uint8_t RxStartPointer;
+    uint8_t PacketStatus[3];
+    uint32_t Random;        //!< Random number generator register
+    int8_t Rssi;            //!< Instantaneous RSSI outside of the burst [dBm]
+    /*!
+     * Transmission heard from BurstStartUs until BurstEndUs
+     */
+    int8_t BurstRssi;
+    uint64_t BurstStartUs;
+    uint64_t BurstEndUs;
+    uint8_t Buffer[256];
+    uint64_t BusyEndUs;     //!< BUSY is high until then
+    /*!
+     * Simulates the air: a transmission ends after its time on air, a
+     * reception gets Downlink or times out after its symbol timeout, the
+     * DMA transfers complete after 1 us per byte
+     */
+    bool Air;
+    struct
+    {
+        uint8_t Buffer[255];
+        uint8_t Size;       //!< 0 when no downlink is waiting
+    }Downlink;
+    /*!
+     * Called by the air simulation once a frame has been sent
+     */
+    void ( *OnTx )( const uint8_t *buffer, uint8_t size );
+    MockRadioState_t State;
+    uint64_t StateUs[MOCK_RADIO_STATES];    //!< Time spent in each state
+    uint32_t TxCount;
+    uint32_t RxCount;
+    /*!
+     * Transfer left running by SpiTransferAsync until MockDmaComplete
+     */
+    struct
+    {
+        bool Pending;
+        uint8_t *RxData;
+        uint16_t Size;
+        SpiTransferCallback_t Callback;
+        void *Context;
+    }Dma;
+}MockRadio_t;
+
+extern MockRadio_t MockRadio;
+
+/*!
+ * \brief Clears the traffic counters
+ */
+void MockStatsReset( void );
+
+/*!
+ * \brief Raises the radio IRQs and calls the DIO1 interrupt handler
+ *
+ * \param [IN] irq IRQ flags to raise
+ */
+void MockRaiseIrq( uint16_t irq );
+
+/*!
+ * \brief Completes the transfer started by SpiTransferAsync, runs its
+ *        callback as the DMA interrupt would
+ */
+void MockDmaComplete( void );
+
+/*!
+ * \brief Accounts the time spent in the current radio state up to now
+ */
+void MockRadioStateUpdate( void );
+
+/*!
+ * \brief Computes the time on air of a LoRa frame with the modulation and
+ *        packet parameters last set
+ *
+ * \param [IN] size Payload size
+ * \retval timeOnAir Time on air [us]
+ */
+uint32_t MockLoRaTimeOnAir( uint8_t size );
+
+/*!
+ * \brief Ends the transmission or reception in progress now, its interrupt
+ *        is raised once the interrupts are enabled
+ *
+ * \retval ended False when the radio is not on air
+ */
+bool MockAirNow( void );
+
+/*!
+ * \brief Keeps BUSY high, its falling edge interrupt is raised at the end
+ *
+ * \param [IN] endUs End of the BUSY period, UINT64_MAX for a stalled radio
+ */
+void MockBusySet( uint64_t endUs );
+
+#endif // __MOCK_BOARD_H__
@@ -0,0 +1,123 @@
+/*!
+ * \file      mock-timer.c
+ *
+ * \brief     Host stand-in for the timer list used by the SX126x driver and
+ *            radio layer, the timers only expire through MockTimerRun
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include "utilities.h"
+#include "board.h"
+#include "delay.h"
+#include "rtc-board.h"
+#include "timer.h"
+#include "mock-pico.h"
+#include "mock-timer.h"
+
+#define MOCK_TIMERS_MAX                             16
+
+/*!
+ * Timers initialized by the code under test
+ */
+static TimerEvent_t *Timers[MOCK_TIMERS_MAX];
+static uint8_t TimersCount;
+
+void TimerInit( TimerEvent_t *obj, void ( *callback )( void *context ) )
+{
+    obj->IsStarted = false;
+    obj->Callback = callback;
+    obj->Context = NULL;
+
+    for( uint8_t i = 0; i < TimersCount; i++ )
+    {
+        if( Timers[i] == obj )
+        {
+            return;
+        }
+    }
+    if( TimersCount < MOCK_TIMERS_MAX )
+    {
+        Timers[TimersCount++] = obj;
+    }
+}
+
+void TimerStart( TimerEvent_t *obj )
+{
+    obj->Timestamp = MockPico.TimeUs + ( uint64_t )obj->ReloadValue * 1000;
+    obj->IsStarted = true;
+}
+
+bool MockTimerRun( void )
+{
+    TimerEvent_t *next = NULL;
+
+    for( uint8_t i = 0; i < TimersCount; i++ )
+    {
+        if( ( Timers[i]->IsStarted == true ) && ( ( next == NULL ) || ( Timers[i]->Timestamp < next->Timestamp ) ) )
+        {
+            next = Timers[i];
+        }
+    }
+    if( next == NULL )
+    {
+        return false;
+    }
+    if( next->Timestamp > MockPico.TimeUs )
+    {
+        MockPico.TimeUs = next->Timestamp;
+    }
+    next->IsStarted = false;
+    MockPico.InException = true;
+    next->Callback( next->Context );
+    MockPico.InException = false;
+    return true;
+}
+
+void TimerStop( TimerEvent_t *obj )
+{
+    obj->IsStarted = false;
+}
+
+void TimerSetValue( TimerEvent_t *obj, uint32_t value )
+{
+    obj->ReloadValue = value;
+}
+
+TimerTime_t TimerGetCurrentTime( void )
+{
+    return ( TimerTime_t )( MockPico.TimeUs / 1000 );
+}
+
+TimerTime_t TimerGetElapsedTime( TimerTime_t past )
+{
+    return TimerGetCurrentTime( ) - past;
+}
+
+TimerTick_t RtcGetTimerValue( void )
+{
+    return ( TimerTick_t )MockPico.TimeUs;
+}
+
+TimerTime_t RtcTick2Ms( TimerTick_t tick )
+{
+    return tick / 1000;
+}
+
+TimerTick_t RtcMs2Tick( TimerTime_t milliseconds )
+{
+    return ( TimerTick_t )milliseconds * 1000;
+}
+
+void DelayMs( uint32_t ms )
+{
+    MockPicoRun( ( uint64_t )ms * 1000 );
+}
+
+void BoardCriticalSectionBegin( uint32_t *mask )
+{
+    *mask = 0;
+}
+
+void BoardCriticalSectionEnd( uint32_t *mask )
+{
+}
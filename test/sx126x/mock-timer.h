@@ -0,0 +1,21 @@
+/*!
+ * \file      mock-timer.h
+ *
+ * \brief     Host stand-in for the timer list used by the SX126x driver and
+ *            radio layer
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#ifndef __MOCK_TIMER_H__
+#define __MOCK_TIMER_H__
+
+#include <stdbool.h>
+
+/*!
+ * \brief Advances the time to the first timer to expire and runs its callback
+ *
+ * \retval fired False when no timer is running
+ */
+bool MockTimerRun( void );
+
+#endif // __MOCK_TIMER_H__
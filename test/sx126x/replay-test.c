@@ -0,0 +1,119 @@
+/*!
+ * \file      replay-test.c
+ *
+ * \brief     Replays LoRaWAN Class A cycles, TX then RX1 and RX2, and counts
+ *            the SPI traffic of each cycle against the mock radio
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+
+#include "radio.h"
+#include "sx126x.h"
+#include "sx126x-board.h"
+#include "mock-board.h"
+
+#define TEST_CYCLES                                 6
+
+/*!
+ * SPI traffic of a steady state cycle, once the radio holds the RX1 and RX2
+ * configurations
+ */
+#define TEST_STEADY_FRAMES                          37
+#define TEST_STEADY_BYTES                           177
+
+static RadioEvents_t Events;
+
+/*!
+ * \brief Ends the current operation with the given IRQ and puts the radio in
+ *        warm sleep, as LoRaMac does after each window
+ */
+static void RadioEnd( uint16_t irq )
+{
+    MockRaiseIrq( irq );
+    Radio.IrqProcess( );
+    Radio.Sleep( );
+}
+
+/*!
+ * \brief Runs a TX, RX1 and RX2 cycle
+ *
+ * \param [IN] freq Uplink and RX1 channel
+ * \param [IN] full Forgets the configuration sent so far before each window,
+ *                  as if every command was sent again
+ */
+static void ClassACycle( uint32_t freq, bool full )
+{
+    uint8_t payload[20] = { 0 };
+
+    MockStatsReset( );
+
+    if( full == true )
+    {
+        SX126xShadowInvalidate( );
+    }
+    Radio.SetChannel( freq );
+    Radio.SetTxConfig( MODEM_LORA, 14, 0, 0, 7, 1, 8, false, true, 0, 0, false, 4000 );
+    Radio.Send( payload, sizeof( payload ) );
+    RadioEnd( IRQ_TX_DONE );
+
+    // RX1 on the uplink channel and datarate
+    if( full == true )
+    {
+        SX126xShadowInvalidate( );
+    }
+    Radio.SetChannel( freq );
+    Radio.SetRxConfig( MODEM_LORA, 0, 7, 1, 0, 8, 12, false, 0, false, 0, 0, true, false );
+    Radio.Rx( 3000 );
+    RadioEnd( IRQ_RX_TX_TIMEOUT );
+
+    // RX2 on the fixed channel at SF12
+    if( full == true )
+    {
+        SX126xShadowInvalidate( );
+    }
+    Radio.SetChannel( 869525000 );
+    Radio.SetRxConfig( MODEM_LORA, 0, 12, 1, 0, 8, 6, false, 0, false, 0, 0, true, false );
+    Radio.Rx( 3000 );
+    RadioEnd( IRQ_RX_TX_TIMEOUT );
+}
+
+int main( void )
+{
+    uint32_t frames[TEST_CYCLES];
+    uint32_t bytes[TEST_CYCLES];
+    int failures = 0;
+
+    SX126xIoInit( );
+    Radio.Init( &Events );
+    Radio.SetPublicNetwork( true );
+    Radio.Sleep( );
+
+    for( uint8_t c = 0; c < TEST_CYCLES; c++ )
+    {
+        ClassACycle( 868100000 + 200000 * ( c % 3 ), false );
+        frames[c] = MockRadio.Stats.Frames;
+        bytes[c] = MockRadio.Stats.Bytes;
+        printf( "cycle %u: %u transactions %u bytes\n", c, frames[c], bytes[c] );
+    }
+
+    ClassACycle( 868100000, true );
+    printf( "full configuration: %u transactions %u bytes\n", MockRadio.Stats.Frames, MockRadio.Stats.Bytes );
+
+    for( uint8_t c = 2; c < TEST_CYCLES; c++ )
+    {
+        if( ( frames[c] != TEST_STEADY_FRAMES ) || ( bytes[c] != TEST_STEADY_BYTES ) )
+        {
+            printf( "cycle %u: expected %u transactions %u bytes\n", c, TEST_STEADY_FRAMES, TEST_STEADY_BYTES );
+            failures++;
+        }
+    }
+    if( ( MockRadio.Stats.Frames <= TEST_STEADY_FRAMES ) || ( MockRadio.Stats.Bytes <= TEST_STEADY_BYTES ) )
+    {
+        printf( "Steady state cycles are not cheaper than a full configuration\n" );
+        failures++;
+    }
+
+    printf( "Class A replay: %d failures\n", failures );
+    return ( failures == 0 ) ? 0 : 1;
+}
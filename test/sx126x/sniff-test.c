@@ -0,0 +1,88 @@
+/*!
+ * \file      sniff-test.c
+ *
+ * \brief     Runs receptions in the reception duty cycle against the mock
+ *            radio, the IRQ handling must see the duty cycle running
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+
+#include "radio.h"
+#include "sx126x.h"
+#include "sx126x-board.h"
+#include "mock-board.h"
+
+static int Failures;
+
+static uint32_t RxDoneCount;
+static uint32_t RxTimeoutCount;
+
+static void OnRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
+{
+    RxDoneCount++;
+}
+
+static void OnRxTimeout( void )
+{
+    RxTimeoutCount++;
+}
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "%s\n", message );
+        Failures++;
+    }
+}
+
+/*!
+ * \brief Starts the duty cycle and raises a preamble detection
+ */
+static void SniffPreamble( void )
+{
+    Radio.RxSniff( );
+    Check( SX126xGetOperatingMode( ) == MODE_RX_DC, "Duty cycle not started" );
+
+    MockRaiseIrq( IRQ_PREAMBLE_DETECTED );
+    Radio.IrqProcess( );
+    Check( SX126xGetOperatingMode( ) == MODE_RX_DC, "Duty cycle mode lost by the IRQ status read" );
+}
+
+int main( void )
+{
+    static RadioEvents_t events = { .RxDone = OnRxDone, .RxTimeout = OnRxTimeout };
+
+    SX126xIoInit( );
+    Radio.Init( &events );
+    Radio.SetChannel( 869525000 );
+    Radio.SetRxConfig( MODEM_LORA, 0, 7, 1, 0, 8, 0, false, 0, true, false, 0, false, true );
+
+    // The reception ends the duty cycle with an explicit standby
+    SniffPreamble( );
+    MockStatsReset( );
+    MockRadio.RxPayloadSize = 12;
+    MockRaiseIrq( IRQ_RX_DONE );
+    Radio.IrqProcess( );
+    MockDmaComplete( );
+    Radio.IrqProcess( );
+    Check( MockRadio.Stats.Opcodes[RADIO_SET_STANDBY] == 1, "Duty cycle not stopped after RxDone" );
+    Check( RxDoneCount == 1, "RxDone not raised" );
+
+    // A timeout after a preamble is reported
+    SniffPreamble( );
+    MockRaiseIrq( IRQ_RX_TX_TIMEOUT );
+    Radio.IrqProcess( );
+    Check( RxTimeoutCount == 1, "RxTimeout not raised" );
+    Check( SX126xGetOperatingMode( ) == MODE_STDBY_RC, "Radio not in standby after RxTimeout" );
+
+    // The configuration is only sent once the duty cycle is left
+    SniffPreamble( );
+    MockStatsReset( );
+    Radio.SetRxConfig( MODEM_LORA, 0, 8, 1, 0, 8, 0, false, 0, true, false, 0, false, true );
+    Check( MockRadio.Stats.Opcodes[RADIO_SET_STANDBY] == 1, "Configuration sent in the duty cycle" );
+
+    printf( "SX126x sniff: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+/*!
+ * \file      spi-test.c
+ *
+ * \brief     Counts the SPI transactions and bytes of the SX126x accessors
+ *            against the mock radio
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "sx126x.h"
+#include "sx126x-board.h"
+#include "mock-board.h"
+
+static int Failures;
+
+/*!
+ * \brief Checks the traffic of the last access and clears the counters
+ *
+ * \param [IN] name   Accessor name
+ * \param [IN] frames Expected NSS frames
+ * \param [IN] calls  Expected SPI driver calls
+ * \param [IN] bytes  Expected bytes on the bus
+ */
+static void CheckStats( const char *name, uint32_t frames, uint32_t calls, uint32_t bytes )
+{
+    MockSpiStats_t *stats = &MockRadio.Stats;
+
+    printf( "%-24s frames %2u calls %2u bytes %3u\n", name, stats->Frames, stats->Calls, stats->Bytes );
+    if( ( stats->Frames != frames ) || ( stats->Calls != calls ) || ( stats->Bytes != bytes ) )
+    {
+        printf( "  expected frames %2u calls %2u bytes %3u\n", frames, calls, bytes );
+        Failures++;
+    }
+    MockStatsReset( );
+}
+
+int main( void )
+{
+    uint8_t payload[255];
+    uint8_t readback[255];
+    uint8_t params[8] = { 0 };
+
+    for( uint16_t i = 0; i < sizeof( payload ); i++ )
+    {
+        payload[i] = i ^ 0x5A;
+    }
+
+    SX126xIoInit( );
+    SX126xSetOperatingMode( MODE_STDBY_RC );
+    MockStatsReset( );
+
+    SX126xWriteCommand( RADIO_SET_MODULATIONPARAMS, params, 8 );
+    CheckStats( "WriteCommand(8)", 1, 2, 9 );
+
+    MockRadio.IrqStatus = IRQ_RX_DONE | IRQ_HEADER_VALID;
+    uint16_t irq = SX126xGetIrqStatus( );
+    CheckStats( "GetIrqStatus", 1, 2, 4 );
+    if( irq != ( IRQ_RX_DONE | IRQ_HEADER_VALID ) )
+    {
+        printf( "GetIrqStatus returned 0x%04X\n", irq );
+        Failures++;
+    }
+
+    SX126xClearIrqStatus( IRQ_RADIO_ALL );
+    CheckStats( "ClearIrqStatus", 1, 2, 3 );
+    if( MockRadio.IrqStatus != 0 )
+    {
+        printf( "ClearIrqStatus left 0x%04X\n", MockRadio.IrqStatus );
+        Failures++;
+    }
+
+    SX126xWriteRegisters( 0x0740, params, 2 );
+    CheckStats( "WriteRegisters(2)", 1, 2, 5 );
+
+    SX126xReadRegisters( 0x0819, readback, 4 );
+    CheckStats( "ReadRegisters(4)", 1, 2, 8 );
+
+    SX126xWriteBuffer( 0x00, payload, 255 );
+    CheckStats( "WriteBuffer(255)", 1, 2, 257 );
+
+    memset( readback, 0, sizeof( readback ) );
+    SX126xReadBuffer( 0x00, readback, 255 );
+    CheckStats( "ReadBuffer(255)", 1, 2, 258 );
+    if( memcmp( readback, payload, sizeof( payload ) ) != 0 )
+    {
+        printf( "ReadBuffer data mismatch\n" );
+        Failures++;
+    }
+
+    // Waking the radio up costs one extra frame
+    SX126xSetOperatingMode( MODE_SLEEP );
+    SX126xWriteCommand( RADIO_SET_STANDBY, params, 1 );
+    CheckStats( "WriteCommand(1) asleep", 2, 3, 4 );
+    if( SX126xGetOperatingMode( ) != MODE_STDBY_RC )
+    {
+        printf( "Wakeup did not update the operating mode\n" );
+        Failures++;
+    }
+
+    printf( "SX126x SPI: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+/*!
+ * \file      toa-test.c
+ *
+ * \brief     Compares Radio.TimeOnAirCached with Radio.TimeOnAir over the
+ *            LoRa and FSK configurations and times both
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "radio.h"
+
+#define TEST_BENCHMARK_CALLS                        2000000
+
+static uint32_t Compared;
+static uint32_t Mismatches;
+
+static void Compare( RadioModems_t modem, uint32_t bandwidth, uint32_t datarate, uint8_t coderate,
+                     uint16_t preambleLen, bool fixLen, uint8_t payloadLen, bool crcOn )
+{
+    uint32_t expected = Radio.TimeOnAir( modem, bandwidth, datarate, coderate, preambleLen, fixLen, payloadLen, crcOn );
+    uint32_t cached = Radio.TimeOnAirCached( modem, bandwidth, datarate, coderate, preambleLen, fixLen, payloadLen, crcOn );
+
+    Compared++;
+    if( cached != expected )
+    {
+        if( Mismatches++ < 10 )
+        {
+            printf( "modem %u bw %u dr %u cr %u preamble %u fixLen %u payload %u crc %u: %u instead of %u\n",
+                    modem, bandwidth, datarate, coderate, preambleLen, fixLen, payloadLen, crcOn, cached, expected );
+        }
+    }
+}
+
+int main( void )
+{
+    // The second pass is served by the cache entries left by the first one
+    for( uint8_t pass = 0; pass < 2; pass++ )
+    {
+        for( uint8_t bw = 0; bw < 3; bw++ )
+        for( uint8_t sf = 5; sf <= 12; sf++ )
+        for( uint8_t cr = 1; cr <= 4; cr++ )
+        for( uint16_t preamble = 6; preamble <= 16; preamble += 2 )
+        for( uint8_t fixLen = 0; fixLen < 2; fixLen++ )
+        for( uint8_t crc = 0; crc < 2; crc++ )
+        for( uint16_t payload = 0; payload < 256; payload++ )
+        {
+            Compare( MODEM_LORA, bw, sf, cr, preamble, fixLen, payload, crc );
+        }
+
+        for( uint32_t dr = 600; dr <= 300000; dr += 4900 )
+        for( uint16_t preamble = 3; preamble <= 8; preamble++ )
+        for( uint8_t fixLen = 0; fixLen < 2; fixLen++ )
+        for( uint8_t crc = 0; crc < 2; crc++ )
+        for( uint16_t payload = 0; payload < 256; payload++ )
+        {
+            Compare( MODEM_FSK, 0, dr, 0, preamble, fixLen, payload, crc );
+        }
+    }
+    printf( "Time on air: %u compared, %u mismatches\n", Compared, Mismatches );
+
+    // The way a region computes the time on air of its uplinks
+    volatile uint32_t sum = 0;
+    clock_t start = clock( );
+
+    for( uint32_t i = 0; i < TEST_BENCHMARK_CALLS; i++ )
+    {
+        sum += Radio.TimeOnAir( MODEM_LORA, 0, 7 + ( i & 3 ), 1, 8, false, ( i * 7 ) & 0xFF, true );
+    }
+    clock_t formula = clock( ) - start;
+
+    start = clock( );
+    for( uint32_t i = 0; i < TEST_BENCHMARK_CALLS; i++ )
+    {
+        sum += Radio.TimeOnAirCached( MODEM_LORA, 0, 7 + ( i & 3 ), 1, 8, false, ( i * 7 ) & 0xFF, true );
+    }
+    clock_t cached = clock( ) - start;
+
+    printf( "formula %.1f ns/call, cached %.1f ns/call\n",
+            formula * 1e9 / CLOCKS_PER_SEC / TEST_BENCHMARK_CALLS, cached * 1e9 / CLOCKS_PER_SEC / TEST_BENCHMARK_CALLS );
+
+    return ( Mismatches == 0 ) ? 0 : 1;
+}
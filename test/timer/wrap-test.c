@@ -0,0 +1,257 @@
+/*!
+ * \file      wrap-test.c
+ *
+ * \brief     Runs the timer list and the RP2040 RTC driver on a simulated
+ *            clock started just below the wrap of the 32 bit microsecond
+ *            counter, then just below the wrap of the 32 bit millisecond
+ *            TimerTime_t, and checks the expiry times and order, the next
+ *            expiry and the elapsed times across the boundary
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ */
+#include <stdio.h>
+
+#include "hardware/sync.h"
+#include "board.h"
+#include "rtc-board.h"
+#include "timer.h"
+#include "mock-pico.h"
+
+/*!
+ * Timers armed across the boundary
+ */
+#define TEST_TIMERS                                 8
+
+/*!
+ * Time left before the boundary when the test starts [ms]
+ */
+#define TEST_LEAD_MS                                50
+
+static int Failures;
+
+typedef struct TestTimer_s
+{
+    TimerEvent_t Timer;
+    uint32_t DurationMs;
+    uint64_t ExpectedUs;
+    uint64_t FiredUs;
+    bool Running;
+    uint8_t Rank;           //!< Expiry rank, 0 for the first to expire
+}TestTimer_t;
+
+static TestTimer_t Timers[TEST_TIMERS];
+
+/*!
+ * Timers in the order they expired
+ */
+static TestTimer_t *Fired[TEST_TIMERS];
+static uint8_t FiredCount;
+
+/*!
+ * Durations, given in the order the timers are started [ms]
+ */
+static const uint32_t Durations[TEST_TIMERS] = { 100, 10, 1000, 51, 49, 50, 70, 30 };
+
+static void Check( bool condition, const char *message )
+{
+    if( condition == false )
+    {
+        printf( "  %s\n", message );
+        Failures++;
+    }
+}
+
+void BoardCriticalSectionBegin( uint32_t *mask )
+{
+    *mask = save_and_disable_interrupts( );
+}
+
+void BoardCriticalSectionEnd( uint32_t *mask )
+{
+    restore_interrupts( *mask );
+}
+
+static void OnTimer( void *context )
+{
+    TestTimer_t *timer = context;
+
+    timer->FiredUs = MockPico.TimeUs;
+    timer->Running = false;
+    if( FiredCount < TEST_TIMERS )
+    {
+        Fired[FiredCount++] = timer;
+    }
+}
+
+/*!
+ * \brief Checks the next expiry reported by the timer list
+ *
+ * \param [IN] expectedUs Time the next timer expires at, 0 when none runs
+ * \retval valid False when the timer list disagrees
+ */
+static bool NextExpiryIsValid( uint64_t expectedUs )
+{
+    TimerTick_t ticks;
+
+    if( TimerGetNextExpiry( &ticks ) == false )
+    {
+        return expectedUs == 0;
+    }
+    // RTC ticks are microseconds on this platform
+    return ( MockPico.TimeUs + ticks ) == expectedUs;
+}
+
+/*!
+ * \brief Earliest expiry of the timers still running
+ */
+static uint64_t NextExpected( void )
+{
+    uint64_t next = 0;
+
+    for( uint8_t i = 0; i < TEST_TIMERS; i++ )
+    {
+        if( ( Timers[i].Running == true ) && ( ( next == 0 ) || ( Timers[i].ExpectedUs < next ) ) )
+        {
+            next = Timers[i].ExpectedUs;
+        }
+    }
+    return next;
+}
+
+/*!
+ * \brief Arms timers across the boundary and sleeps until they all expired
+ *
+ * \param [IN] name       Case name
+ * \param [IN] boundaryUs Time of the boundary since boot [us]
+ */
+static void WrapCheck( const char *name, uint64_t boundaryUs )
+{
+    uint32_t errors = 0;
+    uint32_t expiryErrors = 0;
+
+    MockPicoReset( boundaryUs - ( TEST_LEAD_MS * 1000 ) );
+    RtcInit( );
+    FiredCount = 0;
+
+    // The timers are started 1 ms apart, the later ones as the list runs
+    for( uint8_t i = 0; i < TEST_TIMERS; i++ )
+    {
+        TestTimer_t *timer = &Timers[i];
+
+        timer->DurationMs = Durations[i];
+        timer->ExpectedUs = MockPico.TimeUs + ( ( uint64_t )timer->DurationMs * 1000 );
+        timer->FiredUs = 0;
+        timer->Running = true;
+        TimerInit( &timer->Timer, OnTimer );
+        TimerSetContext( &timer->Timer, timer );
+        TimerSetValue( &timer->Timer, timer->DurationMs );
+        TimerStart( &timer->Timer );
+
+        if( NextExpiryIsValid( NextExpected( ) ) == false )
+        {
+            expiryErrors++;
+        }
+        MockPicoRun( 1000 );
+    }
+
+    for( uint8_t i = 0; i < TEST_TIMERS; i++ )
+    {
+        Timers[i].Rank = 0;
+        for( uint8_t j = 0; j < TEST_TIMERS; j++ )
+        {
+            if( ( Timers[j].ExpectedUs < Timers[i].ExpectedUs ) ||
+                ( ( Timers[j].ExpectedUs == Timers[i].ExpectedUs ) && ( j < i ) ) )
+            {
+                Timers[i].Rank++;
+            }
+        }
+    }
+
+    // The time in ms across the boundary
+    TimerTime_t past = TimerGetCurrentTime( );
+    uint64_t pastUs = MockPico.TimeUs;
+
+    // Sleeps as the application does, woken up by the RTC alarm
+    while( ( FiredCount < TEST_TIMERS ) && ( MockPico.Stalls == 0 ) )
+    {
+        uint32_t ints = save_and_disable_interrupts( );
+
+        __wfi( );
+        restore_interrupts( ints );
+
+        if( NextExpiryIsValid( NextExpected( ) ) == false )
+        {
+            expiryErrors++;
+        }
+    }
+
+    for( uint8_t n = 0; n < FiredCount; n++ )
+    {
+        TestTimer_t *timer = Fired[n];
+
+        if( ( timer->Rank != n ) || ( timer->FiredUs != timer->ExpectedUs ) )
+        {
+            printf( "  %4u ms timer expired #%u at %+lld us\n", timer->DurationMs, n,
+                    ( long long )( timer->FiredUs - timer->ExpectedUs ) );
+            errors++;
+        }
+    }
+
+    TimerTime_t elapsed = TimerGetElapsedTime( past );
+    uint64_t elapsedUs = MockPico.TimeUs - pastUs;
+
+    printf( "%-12s boundary at %llu us: %u timers expired, %u out of place, elapsed %u ms over %llu us\n", name,
+            ( unsigned long long )boundaryUs, FiredCount, errors, elapsed, ( unsigned long long )elapsedUs );
+    Check( FiredCount == TEST_TIMERS, "Timers lost across the boundary" );
+    Check( MockPico.Stalls == 0, "Slept without an alarm armed" );
+    Check( errors == 0, "Timers expired out of order or late" );
+    Check( expiryErrors == 0, "Next expiry wrong across the boundary" );
+    Check( elapsed == ( ( ( pastUs % 1000 ) + elapsedUs ) / 1000 ), "Elapsed time wrong across the boundary" );
+    Check( TimerGetNextExpiry( &( TimerTick_t ){ 0 } ) == false, "Timer list not empty" );
+}
+
+/*!
+ * \brief Stops a timer across the boundary while it is the next to expire
+ *
+ * \param [IN] boundaryUs Time of the boundary since boot [us]
+ */
+static void StopCheck( uint64_t boundaryUs )
+{
+    MockPicoReset( boundaryUs - 2000 );
+    RtcInit( );
+    FiredCount = 0;
+
+    for( uint8_t i = 0; i < 2; i++ )
+    {
+        Timers[i].FiredUs = 0;
+        Timers[i].Running = true;
+        Timers[i].DurationMs = 5 * ( i + 1 );
+        Timers[i].ExpectedUs = MockPico.TimeUs + ( ( uint64_t )Timers[i].DurationMs * 1000 );
+        TimerInit( &Timers[i].Timer, OnTimer );
+        TimerSetContext( &Timers[i].Timer, &Timers[i] );
+        TimerSetValue( &Timers[i].Timer, Timers[i].DurationMs );
+        TimerStart( &Timers[i].Timer );
+    }
+
+    MockPicoRun( 3000 );
+    TimerStop( &Timers[0].Timer );
+    Check( NextExpiryIsValid( Timers[1].ExpectedUs ) == true, "Next expiry wrong after a stop" );
+
+    MockPicoRun( 10000 );
+    Check( ( FiredCount == 1 ) && ( Fired[0] == &Timers[1] ), "Stopped timer expired" );
+    Check( Timers[1].FiredUs == Timers[1].ExpectedUs, "Timer late after a stop across the boundary" );
+}
+
+int main( void )
+{
+    uint64_t usWrap = 1ULL << 32;
+    uint64_t msWrap = ( 1ULL << 32 ) * 1000;
+
+    WrapCheck( "us counter", usWrap );
+    StopCheck( usWrap );
+    WrapCheck( "ms time", msWrap );
+    StopCheck( msWrap );
+
+    printf( "timer wrap: %d failures\n", Failures );
+    return ( Failures == 0 ) ? 0 : 1;
+}